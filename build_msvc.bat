@@ -49,8 +49,8 @@ if exist "%VCVARS%" (
 
 cl /nologo /utf-8 /TC /W4 /WX- /permissive- /Zc:wchar_t /EHsc- ^
    /DUNICODE /D_UNICODE ^
-   src\main.c src\sim.c src\ui.c src\input.c ^
-   /link user32.lib gdi32.lib
+   src\main.c src\sim.c src\sim_command.c src\sim_loop.c src\sim_playback.c src\sim_replay.c src\sim_runner.c src\sim_snapshot.c src\sim_telemetry.c src\sim_triple.c src\sys_file.c src\sys_thread.c src\sys_trace.c src\ui.c src\ui_draw.c src\ui_frame_stats.c src\ui_pace.c src\ui_text.c src\input.c ^
+   /link user32.lib gdi32.lib msimg32.lib
 
 if errorlevel 1 (
     exit /b %errorlevel%
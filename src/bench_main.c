@@ -0,0 +1,491 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "sim_fleet.h"
+#include "sim_hvac_simd.h"
+#include "sim_stages.h"
+#include "sys_thread.h"
+#include "sys_trace.h"
+#include "ui_draw.h"
+#include "ui_frame_stats.h"
+#include "ui_raster.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BENCH_HAVE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#else
+#define BENCH_HAVE_TSC 0
+#endif
+
+#define BENCH_MAX_RESULTS 256U
+#define BENCH_SCHEMA_VERSION 1
+
+typedef struct
+{
+    const char *name;
+    double dt;
+    size_t vehicles;
+    double ns_per_step;
+    double cycles_per_step;
+    double steps_per_s;
+    double bytes_per_s;
+} BenchResult;
+
+typedef struct
+{
+    double min_time_s;
+    size_t max_vehicles;
+    const char *json_path;
+    FILE *log;
+    BenchResult results[BENCH_MAX_RESULTS];
+    size_t result_count;
+} BenchContext;
+
+/* run(ctx, calls) advances its vehicles calls times; one call is vehicles steps. */
+typedef void (*BenchRunFn)(void *ctx, uint64_t calls);
+
+typedef struct
+{
+    SimState state;
+    double dt;
+} BenchStageCtx;
+
+typedef struct
+{
+    SimState *states;
+    SimFleet fleet;
+    size_t vehicles;
+    double dt;
+} BenchFleetCtx;
+
+static uint64_t bench_tsc(void)
+{
+#if BENCH_HAVE_TSC
+    return (uint64_t)__rdtsc();
+#else
+    return 0U;
+#endif
+}
+
+/* Doubles the call count until one timed batch lasts at least min_time_s. */
+static void bench_measure(BenchContext *bench, const char *name, double dt, size_t vehicles,
+    double bytes_per_step, BenchRunFn run, void *ctx)
+{
+    uint64_t calls = 1U;
+    double elapsed = 0.0;
+    uint64_t ticks = 0U;
+
+    run(ctx, 1U);
+    for (;;)
+    {
+        const double start = sys_time_seconds();
+        const uint64_t tsc_start = bench_tsc();
+        run(ctx, calls);
+        ticks = bench_tsc() - tsc_start;
+        elapsed = sys_time_seconds() - start;
+        if ((elapsed >= bench->min_time_s) || (calls >= ((uint64_t)1 << 40)))
+        {
+            break;
+        }
+        calls *= 2U;
+    }
+
+    if (bench->result_count >= BENCH_MAX_RESULTS)
+    {
+        return;
+    }
+
+    const double steps = (double)calls * (double)vehicles;
+    BenchResult *result = &bench->results[bench->result_count++];
+    result->name = name;
+    result->dt = dt;
+    result->vehicles = vehicles;
+    result->ns_per_step = (elapsed * 1e9) / steps;
+    result->cycles_per_step = BENCH_HAVE_TSC ? ((double)ticks / steps) : -1.0;
+    result->steps_per_s = (elapsed > 0.0) ? (steps / elapsed) : 0.0;
+    result->bytes_per_s = (elapsed > 0.0) ? ((bytes_per_step * steps) / elapsed) : 0.0;
+
+    fprintf(bench->log,
+        "%-22s dt=%-9.4g vehicles=%-8zu %10.2f ns/step %10.1f cyc/step %14.0f steps/s %9.2f GB/s\n",
+        name, dt, vehicles, result->ns_per_step, result->cycles_per_step,
+        result->steps_per_s, result->bytes_per_s / 1e9);
+}
+
+static void bench_stage_reset(BenchStageCtx *ctx, double dt)
+{
+    sim_init(&ctx->state);
+    ctx->state.throttle_pct = 40.0;
+    ctx->state.hvac.auto_mode = true;
+    ctx->state.hvac.cabin_temp_c = 31.0;
+    ctx->state.indicators.hazard_enabled = true;
+    ctx->dt = dt;
+}
+
+static void bench_run_sim_step(void *ctx, uint64_t calls)
+{
+    BenchStageCtx *stage = (BenchStageCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        sim_step(&stage->state, stage->dt);
+    }
+}
+
+static void bench_run_indicators(void *ctx, uint64_t calls)
+{
+    BenchStageCtx *stage = (BenchStageCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        sim_stage_update_indicators(&stage->state.indicators, stage->dt);
+    }
+}
+
+static void bench_run_engine(void *ctx, uint64_t calls)
+{
+    BenchStageCtx *stage = (BenchStageCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        sim_stage_update_engine_state(&stage->state, stage->dt);
+    }
+}
+
+static void bench_run_hvac(void *ctx, uint64_t calls)
+{
+    BenchStageCtx *stage = (BenchStageCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        sim_stage_update_hvac(&stage->state, stage->dt);
+    }
+}
+
+static void bench_run_auto(void *ctx, uint64_t calls)
+{
+    BenchStageCtx *stage = (BenchStageCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        /* Alternate the delta sign so every AUTO branch is exercised. */
+        stage->state.hvac.cabin_temp_c = ((i & 1U) != 0U) ? 18.0 : 27.0;
+        sim_stage_apply_auto_logic(&stage->state.hvac);
+    }
+}
+
+static void bench_run_aos(void *ctx, uint64_t calls)
+{
+    BenchFleetCtx *fleet = (BenchFleetCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        for (size_t v = 0U; v < fleet->vehicles; ++v)
+        {
+            sim_step(&fleet->states[v], fleet->dt);
+        }
+    }
+}
+
+static void bench_run_batch(void *ctx, uint64_t calls)
+{
+    BenchFleetCtx *fleet = (BenchFleetCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        sim_step_batch(&fleet->fleet, fleet->dt);
+    }
+}
+
+#if SYS_TRACE
+/* One empty scope: the cost every trace marker adds to the code around it. */
+static void bench_run_trace(void *ctx, uint64_t calls)
+{
+    (void)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        SYS_TRACE_BEGIN(bench_trace);
+        SYS_TRACE_END(bench_trace);
+    }
+}
+#endif
+
+static void bench_stages(BenchContext *bench)
+{
+    /* 1/3 s is the blink interval; the large values make update_indicators loop. */
+    static const double dts[] = {0.001, 1.0 / 240.0, 1.0 / 60.0, 0.05, 1.0, 10.0, 60.0};
+    BenchStageCtx ctx;
+
+    for (size_t i = 0U; i < (sizeof(dts) / sizeof(dts[0])); ++i)
+    {
+        bench_stage_reset(&ctx, dts[i]);
+        bench_measure(bench, "sim_step", dts[i], 1U, (double)sizeof(SimState), bench_run_sim_step, &ctx);
+        bench_stage_reset(&ctx, dts[i]);
+        bench_measure(bench, "update_indicators", dts[i], 1U, (double)sizeof(IndicatorState),
+            bench_run_indicators, &ctx);
+        bench_stage_reset(&ctx, dts[i]);
+        bench_measure(bench, "update_engine_state", dts[i], 1U, (double)sizeof(SimState),
+            bench_run_engine, &ctx);
+        bench_stage_reset(&ctx, dts[i]);
+        bench_measure(bench, "update_hvac", dts[i], 1U, (double)sizeof(HvacState), bench_run_hvac, &ctx);
+    }
+
+    bench_stage_reset(&ctx, 0.0);
+    bench_measure(bench, "apply_auto_logic", 0.0, 1U, (double)sizeof(HvacState), bench_run_auto, &ctx);
+#if SYS_TRACE
+    bench_measure(bench, "sys_trace_event", 0.0, 1U, 0.0, bench_run_trace, NULL);
+#endif
+}
+
+static void bench_fleets(BenchContext *bench)
+{
+    const double dt = 1.0 / 60.0;
+    /* Every step reads and writes each column once. */
+    const double batch_bytes = 2.0 * (double)sim_fleet_bytes_per_vehicle();
+    const double aos_bytes = 2.0 * (double)sizeof(SimState);
+
+    for (size_t vehicles = 1U; vehicles <= bench->max_vehicles; vehicles *= 10U)
+    {
+        BenchFleetCtx ctx;
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.vehicles = vehicles;
+        ctx.dt = dt;
+        ctx.states = (SimState *)malloc(vehicles * sizeof(SimState));
+        if ((ctx.states == NULL) || !sim_fleet_create(&ctx.fleet, vehicles))
+        {
+            fprintf(stderr, "skipping %zu vehicles: out of memory\n", vehicles);
+            free(ctx.states);
+            break;
+        }
+
+        for (size_t v = 0U; v < vehicles; ++v)
+        {
+            sim_init(&ctx.states[v]);
+            ctx.states[v].throttle_pct = (double)(v % 101U);
+            ctx.states[v].hvac.auto_mode = ((v & 1U) != 0U);
+            sim_fleet_scatter(&ctx.fleet, v, &ctx.states[v]);
+        }
+
+        bench_measure(bench, "fleet_sim_step", dt, vehicles, aos_bytes, bench_run_aos, &ctx);
+        bench_measure(bench, "fleet_sim_step_batch", dt, vehicles, batch_bytes, bench_run_batch, &ctx);
+
+        sim_fleet_destroy(&ctx.fleet);
+        free(ctx.states);
+    }
+}
+
+typedef struct
+{
+    UiDrawList list;
+    UiLayout layout;
+    SimState state;
+    UiFramebuffer fb;
+    UiFramebuffer static_layer;
+    UiFrameStats stats;
+} BenchUiCtx;
+
+static void bench_run_ui_build(void *ctx, uint64_t calls)
+{
+    BenchUiCtx *ui = (BenchUiCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        ui->state.velocity_kmh = (double)(i % 200U);
+        ui_build_frame(&ui->list, &ui->layout, &ui->state);
+    }
+}
+
+/* Resize-time cost: every rect, tick, label and band end point plus the needle table. */
+static void bench_run_ui_layout(void *ctx, uint64_t calls)
+{
+    BenchUiCtx *ui = (BenchUiCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        ui_layout_compute(&ui->layout, 1280 - (int)(i & 1U), 720);
+    }
+    ui_layout_compute(&ui->layout, 1280, 720);
+}
+
+static void bench_run_ui_dynamic(void *ctx, uint64_t calls)
+{
+    BenchUiCtx *ui = (BenchUiCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        ui->state.velocity_kmh = (double)(i % 200U);
+        ui_build_dynamic_layer(&ui->list, &ui->layout, &ui->state);
+    }
+}
+
+/* One instrumented phase around no work: the per-phase cost of the window's timing hooks. */
+static void bench_run_ui_phase(void *ctx, uint64_t calls)
+{
+    BenchUiCtx *ui = (BenchUiCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        const double start = ui_phase_begin(&ui->stats);
+        ui_phase_end(&ui->stats, UI_PHASE_DRAW, start);
+    }
+}
+
+static void bench_run_ui_raster(void *ctx, uint64_t calls)
+{
+    BenchUiCtx *ui = (BenchUiCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        ui_raster_execute(&ui->fb, &ui->list);
+    }
+}
+
+/* Per-frame work when the static layer is cached: copy it, then draw the dynamic layer. */
+static void bench_run_ui_layered(void *ctx, uint64_t calls)
+{
+    BenchUiCtx *ui = (BenchUiCtx *)ctx;
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        ui->state.velocity_kmh = (double)(i % 200U);
+        (void)ui_framebuffer_copy(&ui->fb, &ui->static_layer);
+        ui_build_dynamic_layer(&ui->list, &ui->layout, &ui->state);
+        ui_raster_execute(&ui->fb, &ui->list);
+    }
+}
+
+/* Cockpit layout / display-list generation and software rasterization of a 1280x720 frame. */
+static void bench_ui(BenchContext *bench)
+{
+    static BenchUiCtx ctx;
+    sim_init(&ctx.state);
+    ctx.state.hvac.auto_mode = true;
+    ctx.state.indicators.hazard_enabled = true;
+    bench_measure(bench, "ui_layout", 0.0, 1U, (double)sizeof(UiLayout), bench_run_ui_layout, &ctx);
+    ui_build_frame(&ctx.list, &ctx.layout, &ctx.state);
+    const double bytes = (double)(ctx.list.count * sizeof(UiDrawCommand) + ctx.list.text_used);
+    bench_measure(bench, "ui_build_frame", 0.0, 1U, bytes, bench_run_ui_build, &ctx);
+    bench_measure(bench, "ui_build_dynamic", 0.0, 1U, bytes, bench_run_ui_dynamic, &ctx);
+    ui_frame_stats_reset(&ctx.stats, true);
+    bench_measure(bench, "ui_phase_timed", 0.0, 1U, 0.0, bench_run_ui_phase, &ctx);
+
+    if (!ui_framebuffer_create(&ctx.fb, 1280, 720))
+    {
+        fprintf(stderr, "skipping ui_raster_frame: out of memory\n");
+        return;
+    }
+    ui_build_frame(&ctx.list, &ctx.layout, &ctx.state);
+    bench_measure(bench, "ui_raster_frame", 0.0, 1U, 1280.0 * 720.0 * 4.0, bench_run_ui_raster, &ctx);
+
+    if (ui_framebuffer_create(&ctx.static_layer, 1280, 720))
+    {
+        ui_build_static_layer(&ctx.list, &ctx.layout);
+        ui_raster_execute(&ctx.static_layer, &ctx.list);
+        bench_measure(bench, "ui_raster_layered", 0.0, 1U, 2.0 * 1280.0 * 720.0 * 4.0, bench_run_ui_layered, &ctx);
+        ui_framebuffer_destroy(&ctx.static_layer);
+    }
+    ui_framebuffer_destroy(&ctx.fb);
+}
+
+static bool bench_write_json(const BenchContext *bench)
+{
+    FILE *out = stdout;
+    if (strcmp(bench->json_path, "-") != 0)
+    {
+        out = fopen(bench->json_path, "w");
+        if (out == NULL)
+        {
+            fprintf(stderr, "cannot open %s\n", bench->json_path);
+            return false;
+        }
+    }
+
+    fprintf(out, "{\n  \"schema\": %d,\n  \"hvac_kernel\": \"%s\",\n  \"tsc\": %s,\n  \"results\": [\n",
+        BENCH_SCHEMA_VERSION, sim_hvac_kernel_name(sim_hvac_kernel_active()),
+        BENCH_HAVE_TSC ? "true" : "false");
+    for (size_t i = 0U; i < bench->result_count; ++i)
+    {
+        const BenchResult *r = &bench->results[i];
+        fprintf(out,
+            "    {\"name\": \"%s\", \"dt\": %.9g, \"vehicles\": %zu, \"ns_per_step\": %.4f, "
+            "\"cycles_per_step\": %.4f, \"steps_per_sec\": %.1f, \"bytes_per_sec\": %.1f}%s\n",
+            r->name, r->dt, r->vehicles, r->ns_per_step, r->cycles_per_step,
+            r->steps_per_s, r->bytes_per_s, ((i + 1U) < bench->result_count) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return true;
+}
+
+static bool bench_parse(int argc, char **argv, BenchContext *bench)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (value == NULL)
+        {
+            return false;
+        }
+
+        if (strcmp(argv[i], "--json") == 0)
+        {
+            bench->json_path = value;
+        }
+        else if (strcmp(argv[i], "--min-time") == 0)
+        {
+            bench->min_time_s = strtod(value, NULL);
+        }
+        else if (strcmp(argv[i], "--max-vehicles") == 0)
+        {
+            bench->max_vehicles = (size_t)strtoull(value, NULL, 10);
+        }
+        else if (strcmp(argv[i], "--kernel") == 0)
+        {
+            SimHvacKernel kernel = SIM_HVAC_KERNEL_SCALAR;
+            if (strcmp(value, "sse2") == 0)
+            {
+                kernel = SIM_HVAC_KERNEL_SSE2;
+            }
+            else if (strcmp(value, "avx2") == 0)
+            {
+                kernel = SIM_HVAC_KERNEL_AVX2;
+            }
+            if (!sim_hvac_kernel_select(kernel))
+            {
+                fprintf(stderr, "kernel %s not supported on this CPU\n", value);
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    static BenchContext bench;
+    bench.min_time_s = 0.1;
+    bench.max_vehicles = 1000000U;
+    bench.json_path = NULL;
+
+    if (!bench_parse(argc, argv, &bench))
+    {
+        fprintf(stderr,
+            "usage: %s [--json PATH|-] [--min-time S] [--max-vehicles N] [--kernel scalar|sse2|avx2]\n",
+            argv[0]);
+        return 2;
+    }
+
+    /* Keep stdout clean for the JSON document when it is written there. */
+    bench.log = ((bench.json_path != NULL) && (strcmp(bench.json_path, "-") == 0)) ? stderr : stdout;
+
+    bench_stages(&bench);
+    bench_fleets(&bench);
+    bench_ui(&bench);
+
+    if ((bench.json_path != NULL) && !bench_write_json(&bench))
+    {
+        return 1;
+    }
+    return 0;
+}
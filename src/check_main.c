@@ -0,0 +1,679 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+#include "sim_command.h"
+#include "sim_fleet.h"
+#include "sim_hvac_simd.h"
+#include "sim_snapshot.h"
+#include "sim_stages.h"
+#include "sim_triple.h"
+#include "sys_thread.h"
+#include "ui_draw.h"
+#include "ui_raster.h"
+
+/*
+ * Equivalence checks for the guarantees the fast paths make, run by ctest.
+ * Each check prints what diverged first and returns false; `sim_check NAME`
+ * runs one of them, no argument runs all.
+ */
+typedef bool (*CheckFn)(void);
+
+typedef struct
+{
+    const char *name;
+    CheckFn run;
+} CheckEntry;
+
+/* Small deterministic generator so every run checks the same cases. */
+static uint64_t check_random(uint64_t *seed)
+{
+    *seed = (*seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+    return *seed >> 33;
+}
+
+static double check_uniform(uint64_t *seed, double min_value, double max_value)
+{
+    return min_value + ((max_value - min_value) * ((double)check_random(seed) / 2147483648.0));
+}
+
+/* AUTO thresholds as cabin - setpoint: AC hysteresis, airflow, defrost and fan rounding edges. */
+static const double k_check_edges_c[] = {0.5, -1.0, -0.5, -2.0, 0.0, 1.0 / 6.0, -1.0 / 6.0, 1.5, -1.5};
+
+static void check_seed_hvac(SimState *state, size_t index, uint64_t *seed)
+{
+    sim_init(state);
+    HvacState *hvac = &state->hvac;
+    hvac->setpoint_c = 16.0 + (0.5 * (double)(check_random(seed) % 29U));
+    hvac->outside_temp_c = check_uniform(seed, -20.0, 40.0);
+    /* Every fourth vehicle starts exactly on a threshold. */
+    const size_t edge_count = sizeof(k_check_edges_c) / sizeof(k_check_edges_c[0]);
+    hvac->cabin_temp_c = ((index % 4U) == 0U) ? (hvac->setpoint_c + k_check_edges_c[(index / 4U) % edge_count])
+        : check_uniform(seed, -20.0, 60.0);
+    hvac->auto_mode = ((check_random(seed) % 3U) != 0U);
+    hvac->ac_on = ((check_random(seed) % 2U) != 0U);
+    hvac->recirculation_on = ((check_random(seed) % 2U) != 0U);
+    hvac->engine_warm = ((check_random(seed) % 2U) != 0U);
+    /* Out-of-range fan levels exercise the clamp. */
+    hvac->fan_level = (int)(check_random(seed) % 10U) - 1;
+    hvac->airflow_mode = (HvacAirflowMode)(check_random(seed) % 3U);
+}
+
+static bool check_fleet_hvac_equal(const SimFleet *a, const SimFleet *b, const char *what, int step)
+{
+    for (size_t i = 0U; i < a->count; ++i)
+    {
+        if ((memcmp(&a->cabin_temp_c[i], &b->cabin_temp_c[i], sizeof(double)) != 0)
+            || (a->ac_on[i] != b->ac_on[i]) || (a->fan_level[i] != b->fan_level[i])
+            || (a->airflow_mode[i] != b->airflow_mode[i]) || (a->defrost_on[i] != b->defrost_on[i]))
+        {
+            fprintf(stderr, "  %s: vehicle %zu differs at step %d (cabin %.17g vs %.17g, fan %d vs %d)\n", what, i,
+                step, a->cabin_temp_c[i], b->cabin_temp_c[i], a->fan_level[i], b->fan_level[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* The vector kernels step a fleet bit-identically to the scalar kernel, which matches update_hvac(). */
+static bool check_hvac_simd(void)
+{
+    /* Not a multiple of 4 or 8, so the kernels' tails run too. */
+    const size_t count = 1027U;
+    const int steps = 600;
+    const double dt = 1.0 / 60.0;
+    const SimHvacKernel active = sim_hvac_kernel_active();
+
+    SimFleet reference;
+    SimFleet vector;
+    const bool created = sim_fleet_create(&reference, count);
+    if (!sim_fleet_create(&vector, count) || !created)
+    {
+        fprintf(stderr, "  out of memory\n");
+        sim_fleet_destroy(&reference);
+        sim_fleet_destroy(&vector);
+        return false;
+    }
+
+    bool ok = true;
+    static const SimHvacKernel kernels[2] = {SIM_HVAC_KERNEL_SSE2, SIM_HVAC_KERNEL_AVX2};
+    for (size_t k = 0U; (k < 2U) && ok; ++k)
+    {
+        if (!sim_hvac_kernel_select(kernels[k]))
+        {
+            fprintf(stderr, "  %s not supported here, skipped\n", sim_hvac_kernel_name(kernels[k]));
+            continue;
+        }
+
+        uint64_t seed = 2U;
+        for (size_t i = 0U; i < count; ++i)
+        {
+            SimState state;
+            check_seed_hvac(&state, i, &seed);
+            sim_fleet_scatter(&reference, i, &state);
+            sim_fleet_scatter(&vector, i, &state);
+        }
+        for (int step = 0; (step < steps) && ok; ++step)
+        {
+            (void)sim_hvac_kernel_select(SIM_HVAC_KERNEL_SCALAR);
+            sim_hvac_batch(&reference, 0U, count, dt);
+            (void)sim_hvac_kernel_select(kernels[k]);
+            sim_hvac_batch(&vector, 0U, count, dt);
+            ok = check_fleet_hvac_equal(&reference, &vector, sim_hvac_kernel_name(kernels[k]), step);
+        }
+    }
+
+    /* The scalar kernel against sim.c's own update_hvac(), one state at a time. */
+    uint64_t seed = 3U;
+    for (size_t i = 0U; (i < count) && ok; ++i)
+    {
+        SimState state;
+        check_seed_hvac(&state, i, &seed);
+        sim_fleet_scatter(&reference, i, &state);
+    }
+    (void)sim_hvac_kernel_select(SIM_HVAC_KERNEL_SCALAR);
+    seed = 3U;
+    for (size_t i = 0U; (i < count) && ok; ++i)
+    {
+        SimState state;
+        check_seed_hvac(&state, i, &seed);
+        for (int step = 0; step < 60; ++step)
+        {
+            sim_stage_update_hvac(&state, dt);
+        }
+        sim_fleet_scatter(&vector, i, &state);
+    }
+    for (int step = 0; (step < 60) && ok; ++step)
+    {
+        sim_hvac_batch(&reference, 0U, count, dt);
+    }
+    if (ok)
+    {
+        ok = check_fleet_hvac_equal(&vector, &reference, "update_hvac vs scalar kernel", 60);
+    }
+
+    (void)sim_hvac_kernel_select(active);
+    sim_fleet_destroy(&reference);
+    sim_fleet_destroy(&vector);
+    return ok;
+}
+
+/* The vehicles sim_headless runs, so a failure here names one that can be replayed there. */
+static void check_seed_headless(SimState *state, size_t index)
+{
+    sim_init(state);
+    state->throttle_pct = (double)(index % 101U);
+    state->hvac.outside_temp_c = -10.0 + (double)(index % 45U);
+    state->hvac.cabin_temp_c = state->hvac.outside_temp_c;
+    state->hvac.auto_mode = ((index % 3U) != 0U);
+    state->hvac.recirculation_on = ((index % 4U) == 0U);
+    state->indicators.hazard_enabled = ((index % 7U) == 0U);
+}
+
+/*
+ * sim_step_exact() with 5 s steps and sim_advance_to() every 5 s track sim_step()
+ * at a 0.1 ms step on AUTO vehicles, including ones that settle on an AUTO edge
+ * and ones whose engine passes 1500 rpm or warms up mid-step.
+ */
+static bool check_exact_auto(void)
+{
+    const double coarse_dt = 5.0;
+    const int coarse_steps = 18;
+    const int fine_per_coarse = 50000;
+    const double fine_dt = coarse_dt / (double)fine_per_coarse;
+    const double tolerance_c = 1e-3;
+    double worst = 0.0;
+    bool ok = true;
+    for (size_t i = 0U; (i < 90U) && ok; ++i)
+    {
+        SimState fine;
+        check_seed_headless(&fine, i);
+        if (!fine.hvac.auto_mode)
+        {
+            continue;
+        }
+
+        SimState exact = fine;
+        SimState advanced = fine;
+        for (int k = 1; (k <= coarse_steps) && ok; ++k)
+        {
+            for (int n = 0; n < fine_per_coarse; ++n)
+            {
+                sim_step(&fine, fine_dt);
+            }
+            sim_step_exact(&exact, coarse_dt);
+            sim_advance_to(&advanced, coarse_dt * (double)k);
+
+            const double exact_error = fabs(exact.hvac.cabin_temp_c - fine.hvac.cabin_temp_c);
+            const double advance_error = fabs(advanced.hvac.cabin_temp_c - fine.hvac.cabin_temp_c);
+            worst = (exact_error > worst) ? exact_error : worst;
+            worst = (advance_error > worst) ? advance_error : worst;
+            const double hot_error = fabs(exact.hvac.rpm_hot_s - fine.hvac.rpm_hot_s)
+                + fabs(advanced.hvac.rpm_hot_s - fine.hvac.rpm_hot_s);
+            if ((exact_error > tolerance_c) || (advance_error > tolerance_c) || (hot_error > 1e-3))
+            {
+                fprintf(stderr, "  vehicle %zu at %.0f s: cabin %.6f exact, %.6f advanced, %.6f at dt=%g;"
+                    " rpm hot %.4f, %.4f, %.4f s\n", i, coarse_dt * (double)k, exact.hvac.cabin_temp_c,
+                    advanced.hvac.cabin_temp_c, fine.hvac.cabin_temp_c, fine_dt, exact.hvac.rpm_hot_s,
+                    advanced.hvac.rpm_hot_s, fine.hvac.rpm_hot_s);
+                ok = false;
+            }
+        }
+    }
+    printf("  worst cabin error %.2e C\n", worst);
+    return ok;
+}
+
+#define CHECK_TRIPLE_FRAMES 200000U
+
+/* Every field of frame n carries n, so a frame mixing two publishes shows up as a mismatch. */
+static void check_triple_fill(SimFrame *frame, uint64_t n)
+{
+    const double value = (double)n;
+    frame->previous.runtime_s = value - 1.0;
+    frame->current.runtime_s = value;
+    frame->current.velocity_kmh = value;
+    frame->current.hvac.cabin_temp_c = value;
+    frame->step_s = value;
+    frame->current_time_s = value;
+    frame->input_time_s = value;
+    frame->sequence = n;
+}
+
+static bool check_triple_consistent(const SimFrame *frame)
+{
+    const double value = (double)frame->sequence;
+    return (frame->previous.runtime_s == (value - 1.0)) && (frame->current.runtime_s == value)
+        && (frame->current.velocity_kmh == value) && (frame->current.hvac.cabin_temp_c == value)
+        && (frame->step_s == value) && (frame->current_time_s == value) && (frame->input_time_s == value);
+}
+
+static void check_triple_writer(void *arg)
+{
+    SimTripleBuffer *buffer = (SimTripleBuffer *)arg;
+    for (uint64_t n = 1U; n <= CHECK_TRIPLE_FRAMES; ++n)
+    {
+        check_triple_fill(sim_triple_write_slot(buffer), n);
+        sim_triple_publish(buffer);
+        if ((n % 64U) == 0U)
+        {
+            sys_thread_yield();
+        }
+    }
+}
+
+/* With a writer thread publishing, the reader never sees a torn, overwritten or older frame, nor misses the last one. */
+static bool check_sim_triple(void)
+{
+    static SimTripleBuffer buffer;
+    SimFrame initial;
+    memset(&initial, 0, sizeof(initial));
+    check_triple_fill(&initial, 0U);
+    sim_triple_init(&buffer, &initial);
+
+    SysThread writer;
+    if (!sys_thread_start(&writer, check_triple_writer, &buffer))
+    {
+        fprintf(stderr, "  cannot start the writer thread\n");
+        return false;
+    }
+
+    bool ok = true;
+    uint64_t last = 0U;
+    uint64_t fresh_frames = 0U;
+    while (ok && (last < CHECK_TRIPLE_FRAMES))
+    {
+        bool fresh = false;
+        const SimFrame *frame = sim_triple_acquire(&buffer, &fresh);
+        if (!check_triple_consistent(frame))
+        {
+            fprintf(stderr, "  torn frame: sequence %llu with runtime %.17g\n", (unsigned long long)frame->sequence,
+                frame->current.runtime_s);
+            ok = false;
+        }
+        else if (fresh ? (frame->sequence <= last) : (frame->sequence != last))
+        {
+            fprintf(stderr, "  sequence %llu after %llu (fresh=%d)\n", (unsigned long long)frame->sequence,
+                (unsigned long long)last, fresh ? 1 : 0);
+            ok = false;
+        }
+        else
+        {
+            fresh_frames += fresh ? 1U : 0U;
+            last = frame->sequence;
+        }
+
+        /* The reader owns its slot until the next acquire: let the writer run, then the frame must be untouched. */
+        sys_thread_yield();
+        if (ok && ((frame->sequence != last) || !check_triple_consistent(frame)))
+        {
+            fprintf(stderr, "  frame %llu changed to %llu while the reader held it\n", (unsigned long long)last,
+                (unsigned long long)frame->sequence);
+            ok = false;
+        }
+    }
+    sys_thread_join(&writer);
+
+    /* Once the writer is done, the newest publish must be what the reader holds. */
+    bool fresh = false;
+    const SimFrame *frame = sim_triple_acquire(&buffer, &fresh);
+    if (ok && ((frame->sequence != CHECK_TRIPLE_FRAMES) || fresh))
+    {
+        fprintf(stderr, "  final frame %llu (fresh=%d)\n", (unsigned long long)frame->sequence, fresh ? 1 : 0);
+        ok = false;
+    }
+    printf("  %llu of %u frames seen by the reader\n", (unsigned long long)fresh_frames, CHECK_TRIPLE_FRAMES);
+    return ok;
+}
+
+/* Any cockpit the sim can show, plus readings a little past the gauge ends. */
+static void check_seed_cockpit(SimState *state, uint64_t *seed)
+{
+    check_seed_hvac(state, (size_t)check_random(seed), seed);
+    state->velocity_kmh = check_uniform(seed, -5.0, 260.0);
+    state->throttle_pct = check_uniform(seed, 0.0, 100.0);
+    state->rpm = check_uniform(seed, 0.0, 9000.0);
+    state->fuel_pct = check_uniform(seed, -5.0, 105.0);
+    state->runtime_s = check_uniform(seed, 0.0, 3600.0);
+    IndicatorState *indicators = &state->indicators;
+    indicators->left_enabled = ((check_random(seed) % 3U) == 0U);
+    indicators->right_enabled = !indicators->left_enabled && ((check_random(seed) % 3U) == 0U);
+    indicators->hazard_enabled = ((check_random(seed) % 4U) == 0U);
+    indicators->headlight_on = ((check_random(seed) % 2U) != 0U);
+    indicators->blink_on = ((check_random(seed) % 2U) != 0U);
+    state->hvac.defrost_on = ((check_random(seed) % 4U) == 0U);
+}
+
+static bool check_command_equal(const UiDrawList *a, const UiDrawCommand *x, const UiDrawList *b,
+    const UiDrawCommand *y)
+{
+    return (x->kind == y->kind) && (x->font == y->font) && (x->flags == y->flags) && (x->pen_width == y->pen_width)
+        && (x->rect.left == y->rect.left) && (x->rect.top == y->rect.top) && (x->rect.right == y->rect.right)
+        && (x->rect.bottom == y->rect.bottom) && (x->x2 == y->x2) && (x->y2 == y->y2) && (x->x3 == y->x3)
+        && (x->y3 == y->y3) && (x->pen == y->pen) && (x->fill == y->fill) && (x->text_length == y->text_length)
+        && (memcmp(ui_draw_command_text(a, x), ui_draw_command_text(b, y), x->text_length) == 0);
+}
+
+/* Commands first..first+count of list equal all of part; what names the comparison. */
+static bool check_list_slice_equal(const UiDrawList *list, size_t first, const UiDrawList *part, const char *what)
+{
+    for (size_t i = 0U; i < part->count; ++i)
+    {
+        if (!check_command_equal(list, &list->commands[first + i], part, &part->commands[i]))
+        {
+            fprintf(stderr, "  %s: command %zu (kind %u) differs\n", what, first + i,
+                (unsigned)list->commands[first + i].kind);
+            return false;
+        }
+    }
+    return true;
+}
+
+#define CHECK_COALESCE_CASES 200000
+#define CHECK_COALESCE_BATCH 16U
+
+/* A key press as sim_runner sees it: mostly throttle and signal repeats, with every other kind mixed in. */
+static SimCommand check_random_command(uint64_t *seed)
+{
+    static const double throttle_deltas[] = {5.0, -5.0, 25.0, -25.0, 0.75};
+    static const double setpoint_deltas[] = {0.5, -0.5, 1.5, -1.0, 0.3};
+    SimCommand command;
+    const uint64_t pick = check_random(seed) % 20U;
+    if (pick < 5U)
+    {
+        command.kind = SIM_COMMAND_THROTTLE_DELTA;
+    }
+    else if (pick < 8U)
+    {
+        command.kind = SIM_COMMAND_TOGGLE_LEFT;
+    }
+    else
+    {
+        command.kind = (SimCommandKind)(check_random(seed) % ((uint64_t)SIM_COMMAND_SETPOINT_DELTA + 1U));
+    }
+
+    command.value = 1.0;
+    if (command.kind == SIM_COMMAND_THROTTLE_DELTA)
+    {
+        command.value = throttle_deltas[check_random(seed) % 5U];
+    }
+    else if (command.kind == SIM_COMMAND_SETPOINT_DELTA)
+    {
+        command.value = setpoint_deltas[check_random(seed) % 5U];
+    }
+    else if (command.kind == SIM_COMMAND_BRAKE)
+    {
+        command.value = (double)(check_random(seed) % 2U);
+    }
+    else
+    {
+        /* no action */
+    }
+    command.time_s = 0.0;
+    return command;
+}
+
+/* Applying a coalesced batch leaves the same state, snapshot for snapshot, as applying it one command at a time. */
+static bool check_command_coalesce(void)
+{
+    uint64_t seed = 10U;
+    size_t commands_in = 0U;
+    size_t commands_out = 0U;
+    for (int n = 0; n < CHECK_COALESCE_CASES; ++n)
+    {
+        SimState in_order;
+        check_seed_cockpit(&in_order, &seed);
+        /* Throttle near the clamps and fan 0 are where merges used to go wrong. */
+        in_order.throttle_pct = (double)(check_random(&seed) % 21U) * 5.0;
+        in_order.hvac.fan_level = (int)(check_random(&seed) % 8U);
+        SimState coalesced = in_order;
+
+        SimCommand batch[CHECK_COALESCE_BATCH];
+        const size_t count = 1U + (size_t)(check_random(&seed) % CHECK_COALESCE_BATCH);
+        for (size_t i = 0U; i < count; ++i)
+        {
+            batch[i] = check_random_command(&seed);
+            sim_command_apply(&in_order, &batch[i]);
+        }
+        const size_t merged = sim_command_coalesce(batch, count);
+        for (size_t i = 0U; i < merged; ++i)
+        {
+            sim_command_apply(&coalesced, &batch[i]);
+        }
+        commands_in += count;
+        commands_out += merged;
+
+        if (sim_snapshot_hash(&in_order, 0U) != sim_snapshot_hash(&coalesced, 0U))
+        {
+            fprintf(stderr, "  case %d: %zu commands coalesced to %zu end in a different state"
+                " (throttle %.2f vs %.2f, setpoint %.2f vs %.2f, fan %d vs %d)\n", n, count, merged,
+                in_order.throttle_pct, coalesced.throttle_pct, in_order.hvac.setpoint_c, coalesced.hvac.setpoint_c,
+                in_order.hvac.fan_level, coalesced.hvac.fan_level);
+            return false;
+        }
+    }
+    printf("  %zu commands coalesced to %zu\n", commands_in, commands_out);
+    return true;
+}
+
+/*
+ * Command generation is deterministic, fits the fixed list at every size, and a
+ * full frame is exactly the static layer followed by the dynamic layer, so a
+ * backend caching the static layer draws the same frame.
+ */
+static bool check_display_list(void)
+{
+    static const int sizes[][2] = {{1280, 720}, {800, 600}, {1920, 1080}, {640, 360}, {320, 240}};
+    static UiLayout layout;
+    static UiDrawList frame;
+    static UiDrawList again;
+    static UiDrawList static_layer;
+    static UiDrawList dynamic_layer;
+    uint64_t seed = 14U;
+    size_t most_commands = 0U;
+    size_t most_text = 0U;
+    bool ok = true;
+    for (size_t s = 0U; (s < (sizeof(sizes) / sizeof(sizes[0]))) && ok; ++s)
+    {
+        ui_layout_compute(&layout, sizes[s][0], sizes[s][1]);
+        ui_build_static_layer(&static_layer, &layout);
+        for (int n = 0; (n < 500) && ok; ++n)
+        {
+            SimState state;
+            check_seed_cockpit(&state, &seed);
+            ui_build_frame(&frame, &layout, &state);
+            ui_build_frame(&again, &layout, &state);
+            ui_build_dynamic_layer(&dynamic_layer, &layout, &state);
+            if (frame.overflowed || static_layer.overflowed || dynamic_layer.overflowed)
+            {
+                fprintf(stderr, "  %dx%d state %d: list overflowed (%zu commands, %zu text bytes)\n", sizes[s][0],
+                    sizes[s][1], n, frame.count, frame.text_used);
+                ok = false;
+            }
+            else if ((again.count != frame.count) || (frame.count != (static_layer.count + dynamic_layer.count)))
+            {
+                fprintf(stderr, "  %dx%d state %d: %zu commands, rebuilt %zu, layers %zu + %zu\n", sizes[s][0],
+                    sizes[s][1], n, frame.count, again.count, static_layer.count, dynamic_layer.count);
+                ok = false;
+            }
+            else
+            {
+                ok = check_list_slice_equal(&frame, 0U, &again, "rebuilt frame")
+                    && check_list_slice_equal(&frame, 0U, &static_layer, "static layer")
+                    && check_list_slice_equal(&frame, static_layer.count, &dynamic_layer, "dynamic layer");
+            }
+            most_commands = (frame.count > most_commands) ? frame.count : most_commands;
+            most_text = (frame.text_used > most_text) ? frame.text_used : most_text;
+        }
+    }
+    printf("  up to %zu of %u commands, %zu of %u text bytes\n", most_commands, UI_DRAW_MAX_COMMANDS, most_text,
+        UI_DRAW_TEXT_BYTES);
+    return ok;
+}
+
+/* Every input the cockpit shows, one per half second of the drive. */
+static const SimCommand k_check_drive[] = {
+    {SIM_COMMAND_THROTTLE_DELTA, 60.0, 0.0}, {SIM_COMMAND_TOGGLE_LEFT, 1.0, 0.0},
+    {SIM_COMMAND_TOGGLE_HEADLIGHT, 1.0, 0.0}, {SIM_COMMAND_CYCLE_FAN, 1.0, 0.0},
+    {SIM_COMMAND_SETPOINT_DELTA, 1.5, 0.0}, {SIM_COMMAND_TOGGLE_LEFT, 1.0, 0.0},
+    {SIM_COMMAND_TOGGLE_HAZARD, 1.0, 0.0}, {SIM_COMMAND_TOGGLE_AC, 1.0, 0.0},
+    {SIM_COMMAND_CYCLE_AIRFLOW, 1.0, 0.0}, {SIM_COMMAND_TOGGLE_RECIRC, 1.0, 0.0},
+    {SIM_COMMAND_THROTTLE_DELTA, 40.0, 0.0}, {SIM_COMMAND_TOGGLE_HAZARD, 1.0, 0.0},
+    {SIM_COMMAND_TOGGLE_RIGHT, 1.0, 0.0}, {SIM_COMMAND_TOGGLE_DEFROST, 1.0, 0.0},
+    {SIM_COMMAND_TOGGLE_AUTO, 1.0, 0.0}, {SIM_COMMAND_THROTTLE_DELTA, -100.0, 0.0},
+    {SIM_COMMAND_BRAKE, 1.0, 0.0}, {SIM_COMMAND_SETPOINT_DELTA, -3.0, 0.0},
+    {SIM_COMMAND_BRAKE, 0.0, 0.0}, {SIM_COMMAND_TOGGLE_RIGHT, 1.0, 0.0},
+    {SIM_COMMAND_TOGGLE_DEFROST, 1.0, 0.0}, {SIM_COMMAND_TOGGLE_AUTO, 1.0, 0.0},
+};
+
+/* Same pixels; otherwise reports the first difference and the dirty regions covering it. */
+static bool check_framebuffer_equal(const UiFramebuffer *incremental, const UiFramebuffer *full,
+    const UiLayout *layout, int frame)
+{
+    const size_t pixel_count = (size_t)full->width * (size_t)full->height;
+    for (size_t i = 0U; i < pixel_count; ++i)
+    {
+        if (incremental->pixels[i] != full->pixels[i])
+        {
+            const int x = (int)(i % (size_t)full->width);
+            const int y = (int)(i / (size_t)full->width);
+            uint32_t covering = 0U;
+            for (int region = 0; region < (int)UI_REGION_COUNT; ++region)
+            {
+                const UiRect bounds = ui_region_bounds((UiRegion)region, layout);
+                if ((x >= bounds.left) && (x < bounds.right) && (y >= bounds.top) && (y < bounds.bottom))
+                {
+                    covering |= UI_REGION_BIT(region);
+                }
+            }
+            fprintf(stderr, "  %dx%d frame %d: pixel (%d, %d) is %08x, full raster %08x (regions 0x%x)\n",
+                full->width, full->height, frame, x, y, (unsigned)incremental->pixels[i], (unsigned)full->pixels[i],
+                (unsigned)covering);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Over a scripted drive, repainting only the dirty regions over the cached static
+ * layer gives the same pixels as rastering the whole frame, and a state diffed
+ * against itself needs no repaint.
+ */
+static bool check_dirty_repaint(void)
+{
+    static const int sizes[][2] = {{1280, 720}, {640, 360}};
+    static UiLayout layout;
+    static UiDrawList list;
+    const double dt = 1.0 / 60.0;
+    const int ticks = 60 * 30;
+    const size_t drive_count = sizeof(k_check_drive) / sizeof(k_check_drive[0]);
+    bool ok = true;
+    for (size_t s = 0U; (s < (sizeof(sizes) / sizeof(sizes[0]))) && ok; ++s)
+    {
+        UiFramebuffer static_layer;
+        UiFramebuffer incremental;
+        UiFramebuffer full;
+        const bool static_created = ui_framebuffer_create(&static_layer, sizes[s][0], sizes[s][1]);
+        const bool incremental_created = ui_framebuffer_create(&incremental, sizes[s][0], sizes[s][1]);
+        if (!ui_framebuffer_create(&full, sizes[s][0], sizes[s][1]) || !static_created || !incremental_created)
+        {
+            fprintf(stderr, "  out of memory\n");
+            ok = false;
+        }
+        else
+        {
+            ui_layout_compute(&layout, sizes[s][0], sizes[s][1]);
+            ui_build_static_layer(&list, &layout);
+            ui_raster_execute(&static_layer, &list);
+            (void)ui_framebuffer_copy(&incremental, &static_layer);
+
+            SimState state;
+            sim_init(&state);
+            state.hvac.outside_temp_c = 31.0;
+            state.hvac.cabin_temp_c = 38.0;
+            SimState shown;
+            size_t repaints = 0U;
+            for (int t = 0; (t < ticks) && ok; ++t)
+            {
+                if ((t % 30) == 15)
+                {
+                    SimCommand command = k_check_drive[((size_t)t / 30U) % drive_count];
+                    command.time_s = state.runtime_s;
+                    sim_command_apply(&state, &command);
+                }
+                sim_step(&state, dt);
+                if ((t % 2) != 0)
+                {
+                    continue;
+                }
+
+                if (ui_dirty_regions(&state, &state, &layout) != 0U)
+                {
+                    fprintf(stderr, "  %dx%d tick %d: a state differs from itself\n", sizes[s][0], sizes[s][1], t);
+                    ok = false;
+                    break;
+                }
+                UiRect rects[UI_REGION_COUNT];
+                const size_t count = ui_dirty_rects((t == 0) ? NULL : &shown, &state, &layout, rects,
+                    UI_REGION_COUNT);
+                ui_build_dynamic_layer(&list, &layout, &state);
+                for (size_t i = 0U; i < count; ++i)
+                {
+                    (void)ui_framebuffer_copy_rect(&incremental, &static_layer, &rects[i]);
+                    ui_raster_execute_area(&incremental, &list, &rects[i]);
+                }
+                repaints += (count > 0U) ? 1U : 0U;
+                shown = state;
+
+                ui_build_frame(&list, &layout, &state);
+                ui_raster_execute(&full, &list);
+                ok = check_framebuffer_equal(&incremental, &full, &layout, t / 2);
+            }
+            printf("  %dx%d: %zu of %d frames repainted\n", sizes[s][0], sizes[s][1], repaints, ticks / 2);
+        }
+        ui_framebuffer_destroy(&static_layer);
+        ui_framebuffer_destroy(&incremental);
+        ui_framebuffer_destroy(&full);
+    }
+    return ok;
+}
+
+static const CheckEntry k_checks[] = {
+    {"hvac_simd", check_hvac_simd},
+    {"exact_auto", check_exact_auto},
+    {"sim_triple", check_sim_triple},
+    {"command_coalesce", check_command_coalesce},
+    {"display_list", check_display_list},
+    {"dirty_repaint", check_dirty_repaint},
+};
+
+int main(int argc, char **argv)
+{
+    const size_t check_count = sizeof(k_checks) / sizeof(k_checks[0]);
+    const char *only = (argc > 1) ? argv[1] : NULL;
+    size_t run = 0U;
+    size_t failed = 0U;
+    for (size_t i = 0U; i < check_count; ++i)
+    {
+        if ((only != NULL) && (strcmp(only, k_checks[i].name) != 0))
+        {
+            continue;
+        }
+
+        const bool ok = k_checks[i].run();
+        printf("check=%s %s\n", k_checks[i].name, ok ? "ok" : "FAILED");
+        ++run;
+        failed += ok ? 0U : 1U;
+    }
+
+    if (run == 0U)
+    {
+        fprintf(stderr, "usage: %s [CHECK]; no check named %s\n", argv[0], (only != NULL) ? only : "");
+        return 2;
+    }
+    return (failed == 0U) ? 0 : 1;
+}
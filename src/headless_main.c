@@ -0,0 +1,727 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "sim_fleet.h"
+#include "sim_hvac_simd.h"
+#include "sim_replay.h"
+#include "sim_sched.h"
+#include "sim_sweep.h"
+#include "sim_telemetry.h"
+#include "sys_thread.h"
+#include "sys_trace.h"
+#include "ui_draw.h"
+#include "ui_pace.h"
+#include "ui_raster.h"
+
+typedef struct
+{
+    size_t vehicles;
+    double sim_seconds;
+    double dt;
+    unsigned threads;
+    unsigned ticks_per_epoch;
+    bool single;
+    bool exact;
+    bool advance;
+    const char *record_path;
+    const char *replay_path;
+    const char *telemetry_path;
+    const char *render_path;
+    double render_fps;
+    bool paced;
+    const char *trace_path;
+    const char *sweep_path;
+    const char *sweep_points_path;
+    SimSweepConfig sweep;
+} HeadlessOptions;
+
+static void headless_usage(const char *argv0)
+{
+    fprintf(stderr,
+        "usage: %s [--vehicles N] [--seconds T] [--dt S] [--threads K] [--epoch TICKS] [--single] [--exact] [--advance]\n"
+        "       [--telemetry PATH] [--trace PATH]\n"
+        "       %s --record PATH [--seconds T] [--dt S] | --replay PATH\n"
+        "       %s --render PATH [--fps F] [--paced] [--seconds T] [--dt S]\n"
+        "       %s --sweep PATH [--setpoint A:B:N] [--outside A:B:N] [--cabin A:B:N] [--comfort E]\n"
+        "          [--sweep-step S] [--sweep-max T] [--sweep-points PATH] [--threads K]\n"
+        "  --vehicles N   number of simulated vehicles (default 1000)\n"
+        "  --seconds T    simulated seconds per vehicle (default 600)\n"
+        "  --dt S         fixed step in seconds (default 1/60)\n"
+        "  --threads K    worker threads, 0 = all CPUs (default 1)\n"
+        "  --epoch TICKS  ticks between scheduler barriers (default 60)\n"
+        "  --single       step SimState one vehicle at a time with sim_step()\n"
+        "  --exact        like --single but with sim_step_exact(); allows very large --dt\n"
+        "  --advance      jump each vehicle to T with sim_advance_to() (event driven)\n"
+        "  --telemetry PATH  record every tick of every vehicle as columnar telemetry\n"
+        "  --record PATH  drive one vehicle with scripted input and write a session log\n"
+        "  --replay PATH  re-execute a session log at full speed and verify its state hashes\n"
+        "  --render PATH  drive one vehicle with scripted input and write cockpit frames as a PPM stream\n"
+        "                 (- for stdout, e.g. piped into ffmpeg -f image2pipe)\n"
+        "  --fps F        frames per simulated second for --render (default 30)\n"
+        "  --paced        update the picture only on the ticks the GUI frame pacer would take\n"
+        "  --trace PATH   write a Chrome trace of the run (builds with -DHVAC_TRACE=ON; any mode)\n"
+        "  --sweep PATH   run every AUTO-mode start condition of the grid to comfort and write the\n"
+        "                 time-to-comfort, overshoot, AC duty and fan level histograms (- for stdout);\n"
+        "                 uses all CPUs unless --threads is given\n"
+        "  --setpoint A:B:N, --outside A:B:N, --cabin A:B:N\n"
+        "                 N values from A to B C (defaults 16:30:29, -20:40:61, -10:50:61); each\n"
+        "                 point also runs with recirculation off/on and the engine cold/warm\n"
+        "  --comfort E    comfortable within E C of the setpoint (default 0.5)\n"
+        "  --sweep-step S sampling step in seconds (default 0.1; the cabin model is exact)\n"
+        "  --sweep-max T  give up on a point after T simulated seconds (default 3600)\n"
+        "  --sweep-points PATH  also write one CSV row per grid point\n",
+        argv0, argv0, argv0, argv0);
+}
+
+static bool headless_parse(int argc, char **argv, HeadlessOptions *options)
+{
+    options->vehicles = 1000U;
+    options->sim_seconds = 600.0;
+    options->dt = 1.0 / 60.0;
+    options->threads = 1U;
+    options->ticks_per_epoch = 60U;
+    options->single = false;
+    options->exact = false;
+    options->advance = false;
+    options->record_path = NULL;
+    options->replay_path = NULL;
+    options->telemetry_path = NULL;
+    options->render_path = NULL;
+    options->render_fps = 30.0;
+    options->paced = false;
+    options->trace_path = NULL;
+    options->sweep_path = NULL;
+    options->sweep_points_path = NULL;
+    sim_sweep_config_default(&options->sweep);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--single") == 0)
+        {
+            options->single = true;
+            continue;
+        }
+        if (strcmp(arg, "--exact") == 0)
+        {
+            options->single = true;
+            options->exact = true;
+            continue;
+        }
+        if (strcmp(arg, "--advance") == 0)
+        {
+            options->single = true;
+            options->advance = true;
+            continue;
+        }
+        if (strcmp(arg, "--paced") == 0)
+        {
+            options->paced = true;
+            continue;
+        }
+        if (value == NULL)
+        {
+            return false;
+        }
+
+        if (strcmp(arg, "--vehicles") == 0)
+        {
+            options->vehicles = (size_t)strtoull(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--seconds") == 0)
+        {
+            options->sim_seconds = strtod(value, NULL);
+        }
+        else if (strcmp(arg, "--dt") == 0)
+        {
+            options->dt = strtod(value, NULL);
+        }
+        else if (strcmp(arg, "--threads") == 0)
+        {
+            options->threads = (unsigned)strtoul(value, NULL, 10);
+            options->sweep.threads = options->threads;
+        }
+        else if (strcmp(arg, "--epoch") == 0)
+        {
+            options->ticks_per_epoch = (unsigned)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--record") == 0)
+        {
+            options->record_path = value;
+        }
+        else if (strcmp(arg, "--replay") == 0)
+        {
+            options->replay_path = value;
+        }
+        else if (strcmp(arg, "--telemetry") == 0)
+        {
+            options->telemetry_path = value;
+        }
+        else if (strcmp(arg, "--render") == 0)
+        {
+            options->render_path = value;
+        }
+        else if (strcmp(arg, "--fps") == 0)
+        {
+            options->render_fps = strtod(value, NULL);
+        }
+        else if (strcmp(arg, "--trace") == 0)
+        {
+            options->trace_path = value;
+        }
+        else if (strcmp(arg, "--sweep") == 0)
+        {
+            options->sweep_path = value;
+        }
+        else if (strcmp(arg, "--sweep-points") == 0)
+        {
+            options->sweep_points_path = value;
+        }
+        else if (strcmp(arg, "--setpoint") == 0)
+        {
+            if (!sim_sweep_parse_axis(value, &options->sweep.setpoint_c))
+            {
+                return false;
+            }
+        }
+        else if (strcmp(arg, "--outside") == 0)
+        {
+            if (!sim_sweep_parse_axis(value, &options->sweep.outside_c))
+            {
+                return false;
+            }
+        }
+        else if (strcmp(arg, "--cabin") == 0)
+        {
+            if (!sim_sweep_parse_axis(value, &options->sweep.cabin_c))
+            {
+                return false;
+            }
+        }
+        else if (strcmp(arg, "--comfort") == 0)
+        {
+            options->sweep.comfort_c = strtod(value, NULL);
+        }
+        else if (strcmp(arg, "--sweep-step") == 0)
+        {
+            options->sweep.step_s = strtod(value, NULL);
+        }
+        else if (strcmp(arg, "--sweep-max") == 0)
+        {
+            options->sweep.max_s = strtod(value, NULL);
+        }
+        else
+        {
+            return false;
+        }
+        ++i;
+    }
+
+    return (options->vehicles > 0U) && (options->sim_seconds > 0.0) && (options->dt > 0.0)
+        && (options->render_fps > 0.0) && (sim_sweep_point_count(&options->sweep) > 0U);
+}
+
+/* Deterministic spread of driving and HVAC conditions so vehicles diverge. */
+static void headless_seed_vehicle(SimState *state, size_t index)
+{
+    sim_init(state);
+    state->throttle_pct = (double)(index % 101U);
+    state->hvac.outside_temp_c = -10.0 + (double)(index % 45U);
+    state->hvac.cabin_temp_c = state->hvac.outside_temp_c;
+    state->hvac.auto_mode = ((index % 3U) != 0U);
+    state->hvac.recirculation_on = ((index % 4U) == 0U);
+    state->indicators.hazard_enabled = ((index % 7U) == 0U);
+}
+
+static double headless_checksum_state(const SimState *state)
+{
+    return state->velocity_kmh + state->fuel_pct + state->hvac.cabin_temp_c
+        + (double)state->hvac.fan_level + (state->indicators.blink_on ? 1.0 : 0.0);
+}
+
+static void headless_record_epoch(void *user, const SimFleet *fleet, uint64_t ticks_done)
+{
+    (void)ticks_done;
+    sim_telemetry_append_fleet((SimTelemetryWriter *)user, fleet, 0U, fleet->count);
+}
+
+static bool headless_run_single(const HeadlessOptions *options, uint64_t ticks, double *checksum,
+    SimTelemetryWriter *telemetry)
+{
+    SimState *states = (SimState *)malloc(options->vehicles * sizeof(SimState));
+    if (states == NULL)
+    {
+        return false;
+    }
+
+    for (size_t v = 0U; v < options->vehicles; ++v)
+    {
+        headless_seed_vehicle(&states[v], v);
+    }
+    for (uint64_t t = 0U; (t < ticks) && !options->advance; ++t)
+    {
+        for (size_t v = 0U; v < options->vehicles; ++v)
+        {
+            if (options->exact)
+            {
+                sim_step_exact(&states[v], options->dt);
+            }
+            else
+            {
+                sim_step(&states[v], options->dt);
+            }
+            sim_telemetry_append(telemetry, &states[v]);
+        }
+    }
+
+    for (size_t v = 0U; (v < options->vehicles) && options->advance; ++v)
+    {
+        sim_advance_to(&states[v], options->sim_seconds);
+    }
+
+    *checksum = 0.0;
+    for (size_t v = 0U; v < options->vehicles; ++v)
+    {
+        *checksum += headless_checksum_state(&states[v]);
+    }
+    free(states);
+    return true;
+}
+
+static bool headless_run_fleet(const HeadlessOptions *options, uint64_t ticks, double *checksum,
+    unsigned *threads_used, SimTelemetryWriter *telemetry)
+{
+    SimFleet fleet;
+    if (!sim_fleet_create(&fleet, options->vehicles))
+    {
+        return false;
+    }
+
+    SimState seed;
+    for (size_t v = 0U; v < options->vehicles; ++v)
+    {
+        headless_seed_vehicle(&seed, v);
+        sim_fleet_scatter(&fleet, v, &seed);
+    }
+
+    SimSchedConfig config;
+    memset(&config, 0, sizeof(config));
+    config.thread_count = options->threads;
+    config.ticks_per_epoch = options->ticks_per_epoch;
+    if (telemetry != NULL)
+    {
+        /* Telemetry wants every tick, so synchronise after each one. */
+        config.ticks_per_epoch = 1U;
+        config.on_epoch = headless_record_epoch;
+        config.user = telemetry;
+    }
+
+    SimScheduler sched;
+    if (!sim_sched_create(&sched, &config))
+    {
+        sim_fleet_destroy(&fleet);
+        return false;
+    }
+    *threads_used = sched.thread_count;
+
+    const bool ok = sim_sched_run(&sched, &fleet, options->dt, ticks);
+
+    for (unsigned i = 0U; i < sched.thread_count; ++i)
+    {
+        SimSchedThreadStats stats;
+        sim_sched_get_stats(&sched, i, &stats);
+        printf("thread %u: utilization=%.1f%% chunks=%llu steals=%llu failed_steals=%llu\n",
+            i, stats.utilization * 100.0, (unsigned long long)stats.chunks_run,
+            (unsigned long long)stats.steals, (unsigned long long)stats.failed_steals);
+    }
+    sim_sched_destroy(&sched);
+
+    *checksum = 0.0;
+    for (size_t v = 0U; v < options->vehicles; ++v)
+    {
+        sim_fleet_gather(&fleet, v, &seed);
+        *checksum += headless_checksum_state(&seed);
+    }
+    sim_fleet_destroy(&fleet);
+    return ok;
+}
+
+/* Stand-in for an input injector: a fixed command script cycled every half second. */
+static bool headless_scripted_command(uint64_t tick, double dt, SimCommand *command)
+{
+    static const SimCommand script[] = {
+        { SIM_COMMAND_THROTTLE_DELTA, 25.0, 0.0 },
+        { SIM_COMMAND_TOGGLE_AC, 1.0, 0.0 },
+        { SIM_COMMAND_CYCLE_FAN, 1.0, 0.0 },
+        { SIM_COMMAND_TOGGLE_LEFT, 1.0, 0.0 },
+        { SIM_COMMAND_SETPOINT_DELTA, -0.5, 0.0 },
+        { SIM_COMMAND_BRAKE, 1.0, 0.0 },
+        { SIM_COMMAND_BRAKE, 0.0, 0.0 },
+        { SIM_COMMAND_TOGGLE_AUTO, 1.0, 0.0 },
+        { SIM_COMMAND_THROTTLE_DELTA, -15.0, 0.0 },
+        { SIM_COMMAND_CYCLE_AIRFLOW, 1.0, 0.0 }
+    };
+    const uint64_t period = (uint64_t)((0.5 / dt) + 0.5);
+    if ((period == 0U) || ((tick % period) != 0U))
+    {
+        return false;
+    }
+
+    *command = script[(tick / period) % (sizeof(script) / sizeof(script[0]))];
+    command->time_s = (double)tick * dt;
+    return true;
+}
+
+static int headless_record(const HeadlessOptions *options, uint64_t ticks)
+{
+    SimState state;
+    headless_seed_vehicle(&state, 1U);
+
+    SimRecorder recorder;
+    if (!sim_recorder_open(&recorder, options->record_path, &state))
+    {
+        fprintf(stderr, "cannot create %s\n", options->record_path);
+        return 1;
+    }
+
+    for (uint64_t t = 0U; t < ticks; ++t)
+    {
+        SimCommand command;
+        if (headless_scripted_command(t, options->dt, &command))
+        {
+            sim_command_apply(&state, &command);
+            sim_recorder_command(&recorder, &command);
+        }
+        sim_step(&state, options->dt);
+        sim_recorder_step(&recorder, options->dt, &state);
+    }
+
+    const uint64_t records = recorder.records;
+    const uint64_t hash = recorder.hash;
+    if (!sim_recorder_close(&recorder))
+    {
+        fprintf(stderr, "write to %s failed\n", options->record_path);
+        return 1;
+    }
+    printf("recorded=%s records=%llu hash=%016llx\n", options->record_path,
+        (unsigned long long)records, (unsigned long long)hash);
+    return 0;
+}
+
+/*
+ * Scripted drive rendered with the software rasterizer, one frame per 1/fps simulated seconds.
+ * With --paced the picture is only updated on the ticks UiPacer asks for (on the sim clock,
+ * scripted input waking it like key presses), so frames show what the paced GUI would.
+ */
+static int headless_render(const HeadlessOptions *options, uint64_t ticks)
+{
+    const bool to_stdout = (strcmp(options->render_path, "-") == 0);
+    FILE *out = to_stdout ? stdout : fopen(options->render_path, "wb");
+    if (out == NULL)
+    {
+        fprintf(stderr, "cannot create %s\n", options->render_path);
+        return 1;
+    }
+
+    static UiDrawList list;
+    static UiLayout layout;
+    UiFramebuffer fb;
+    UiFramebuffer static_layer;
+    const bool created = ui_framebuffer_create(&fb, 1280, 720);
+    if (!ui_framebuffer_create(&static_layer, 1280, 720) || !created)
+    {
+        fprintf(stderr, "out of memory\n");
+        ui_framebuffer_destroy(&fb);
+        ui_framebuffer_destroy(&static_layer);
+        if (!to_stdout)
+        {
+            fclose(out);
+        }
+        return 1;
+    }
+    ui_layout_compute(&layout, static_layer.width, static_layer.height);
+    ui_build_static_layer(&list, &layout);
+    ui_raster_execute(&static_layer, &list);
+    (void)ui_framebuffer_copy(&fb, &static_layer);
+
+    SimState state;
+    headless_seed_vehicle(&state, 1U);
+    const double frame_s = 1.0 / options->render_fps;
+    double next_frame_s = 0.0;
+    uint64_t frames = 0U;
+    uint64_t repainted_px = 0U;
+    const double frame_px = (double)fb.width * (double)fb.height;
+    double render_s = 0.0;
+    bool ok = true;
+    SimState shown;
+    bool has_shown = false;
+    UiPacer pacer;
+    ui_pacer_init(&pacer, 0.0);
+    double next_tick_s = 0.0;
+    for (uint64_t t = 0U; (t <= ticks) && ok; ++t)
+    {
+        const bool frame_due = (state.runtime_s >= next_frame_s);
+        /* runtime_s accumulates dt; the tolerance keeps a tick predicted for exactly this step from slipping one. */
+        if (options->paced ? ((state.runtime_s + 1e-9) >= next_tick_s) : frame_due)
+        {
+            /* Like the GUI: repaint only regions whose drawn content changed since the last frame. */
+            const double start = sys_time_seconds();
+            UiRect rects[UI_REGION_COUNT];
+            const size_t count = ui_dirty_rects(has_shown ? &shown : NULL, &state, &layout, rects,
+                UI_REGION_COUNT);
+            if (count > 0U)
+            {
+                ui_build_dynamic_layer(&list, &layout, &state);
+            }
+            for (size_t i = 0U; i < count; ++i)
+            {
+                (void)ui_framebuffer_copy_rect(&fb, &static_layer, &rects[i]);
+                ui_raster_execute_area(&fb, &list, &rects[i]);
+                repainted_px += (uint64_t)(rects[i].right - rects[i].left) * (uint64_t)(rects[i].bottom - rects[i].top);
+            }
+            shown = state;
+            has_shown = true;
+            render_s += sys_time_seconds() - start;
+            next_tick_s = state.runtime_s + ui_pacer_tick(&pacer, state.runtime_s, &state, count > 0U, &layout);
+        }
+        if (frame_due)
+        {
+            ok = ui_framebuffer_write_ppm(&fb, out);
+            ++frames;
+            next_frame_s += frame_s;
+        }
+
+        SimCommand command;
+        if (headless_scripted_command(t, options->dt, &command))
+        {
+            sim_command_apply(&state, &command);
+            const double wake_s = state.runtime_s + ui_pacer_wake(&pacer);
+            next_tick_s = (wake_s < next_tick_s) ? wake_s : next_tick_s;
+        }
+        sim_step(&state, options->dt);
+    }
+
+    UiPacerStats pace;
+    ui_pacer_stats(&pacer, state.runtime_s, &pace);
+
+    ui_framebuffer_destroy(&fb);
+    ui_framebuffer_destroy(&static_layer);
+    if (!to_stdout)
+    {
+        ok = (fclose(out) == 0) && ok;
+    }
+    /* Keep stdout clean for the frame stream when it is written there. */
+    fprintf(to_stdout ? stderr : stdout,
+        "rendered=%s frames=%llu raster=%s repainted=%.1f%% ms_per_frame=%.3f fps=%.0f%s\n",
+        options->render_path, (unsigned long long)frames, ui_raster_kernel_name(),
+        (frames > 0U) ? ((100.0 * (double)repainted_px) / ((double)frames * frame_px)) : 0.0,
+        (frames > 0U) ? ((render_s * 1e3) / (double)frames) : 0.0,
+        (render_s > 0.0) ? ((double)frames / render_s) : 0.0, ok ? "" : " WRITE FAILED");
+    if (options->paced)
+    {
+        fprintf(to_stdout ? stderr : stdout, "paced ticks/s=%.1f fps=%.1f idle=%.1f%% input_wakes=%llu\n",
+            pace.tick_hz, pace.fps, 100.0 * pace.idle_ratio, (unsigned long long)pace.wakes);
+    }
+    return ok ? 0 : 1;
+}
+
+static int headless_replay(const HeadlessOptions *options)
+{
+    SimReplay replay;
+    if (!sim_replay_open(&replay, options->replay_path))
+    {
+        fprintf(stderr, "%s is not a readable session log\n", options->replay_path);
+        return 1;
+    }
+
+    SimState state;
+    SimReplayResult result;
+    const double start = sys_time_seconds();
+    const bool ok = sim_replay_run(&replay, &state, &result);
+    const double wall_s = sys_time_seconds() - start;
+    const bool complete = ok && (replay.recorded_hash != 0U);
+    const bool final_matches = (result.final_hash == replay.recorded_hash);
+    sim_replay_close(&replay);
+
+    printf("replayed=%s steps=%llu commands=%llu sim_s=%.3f wall_s=%.3f realtime_factor=%.0f\n",
+        options->replay_path, (unsigned long long)result.steps, (unsigned long long)result.commands,
+        result.sim_seconds, wall_s, (wall_s > 0.0) ? (result.sim_seconds / wall_s) : 0.0);
+    if (!ok)
+    {
+        printf("MISMATCH at record %llu\n", (unsigned long long)result.first_mismatch);
+        return 1;
+    }
+    if (complete && !final_matches)
+    {
+        printf("MISMATCH final hash %016llx\n", (unsigned long long)result.final_hash);
+        return 1;
+    }
+    printf("hash=%016llx %s\n", (unsigned long long)result.final_hash,
+        complete ? "verified" : "verified (log not closed)");
+    return 0;
+}
+
+/* AUTO comfort sweep over the configured grid; the summary line goes to stderr when the report is on stdout. */
+static int headless_sweep(const HeadlessOptions *options)
+{
+    const uint64_t count = sim_sweep_point_count(&options->sweep);
+    SimSweepPoint *points = NULL;
+    if (options->sweep_points_path != NULL)
+    {
+        points = (SimSweepPoint *)malloc((size_t)count * sizeof(SimSweepPoint));
+        if (points == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+
+    SimSweepSummary summary;
+    const double start = sys_time_seconds();
+    const bool ran = sim_sweep_run(&options->sweep, &summary, points);
+    const double wall_s = sys_time_seconds() - start;
+    if (!ran)
+    {
+        fprintf(stderr, "sweep failed (out of memory?)\n");
+        free(points);
+        return 1;
+    }
+
+    const bool to_stdout = (strcmp(options->sweep_path, "-") == 0);
+    FILE *out = to_stdout ? stdout : fopen(options->sweep_path, "w");
+    bool ok = (out != NULL) && sim_sweep_write_report(&options->sweep, &summary, out);
+    if ((out != NULL) && !to_stdout)
+    {
+        ok = (fclose(out) == 0) && ok;
+    }
+    if (points != NULL)
+    {
+        FILE *csv = fopen(options->sweep_points_path, "w");
+        ok = (csv != NULL) && sim_sweep_write_points(&options->sweep, points, csv) && ok;
+        if (csv != NULL)
+        {
+            ok = (fclose(csv) == 0) && ok;
+        }
+        free(points);
+    }
+
+    fprintf(to_stdout ? stderr : stdout,
+        "swept=%s points=%llu reached=%llu threads=%u wall_s=%.3f points_per_s=%.0f realtime_factor=%.0f%s\n",
+        options->sweep_path, (unsigned long long)summary.points, (unsigned long long)summary.reached,
+        summary.threads_used, wall_s, (wall_s > 0.0) ? ((double)summary.points / wall_s) : 0.0,
+        (wall_s > 0.0) ? (summary.simulated_s / wall_s) : 0.0, ok ? "" : " WRITE FAILED");
+    return ok ? 0 : 1;
+}
+
+/* Writes the trace once the run is over, frees the rings and passes its exit status through. */
+static int headless_trace(const HeadlessOptions *options, int status)
+{
+    if (options->trace_path == NULL)
+    {
+        /* no action */
+    }
+    else if (sys_trace_write(options->trace_path))
+    {
+        fprintf(stderr, "trace=%s\n", options->trace_path);
+    }
+    else
+    {
+        fprintf(stderr, "%s %s\n", SYS_TRACE ? "cannot write trace" : "tracing not compiled in, no trace for",
+            options->trace_path);
+    }
+    sys_trace_shutdown();
+    return status;
+}
+
+int main(int argc, char **argv)
+{
+    HeadlessOptions options;
+    if (!headless_parse(argc, argv, &options))
+    {
+        headless_usage(argv[0]);
+        return 2;
+    }
+    SYS_TRACE_THREAD("main");
+    if (options.replay_path != NULL)
+    {
+        return headless_trace(&options, headless_replay(&options));
+    }
+
+    const uint64_t ticks = (uint64_t)((options.sim_seconds / options.dt) + 0.5);
+    if (options.record_path != NULL)
+    {
+        return headless_trace(&options, headless_record(&options, ticks));
+    }
+    if (options.render_path != NULL)
+    {
+        return headless_trace(&options, headless_render(&options, ticks));
+    }
+    if (options.sweep_path != NULL)
+    {
+        return headless_trace(&options, headless_sweep(&options));
+    }
+    unsigned threads_used = 1U;
+    double checksum = 0.0;
+
+    static SimTelemetryWriter telemetry_writer;
+    SimTelemetryWriter *telemetry = NULL;
+    if (options.telemetry_path != NULL)
+    {
+        if (!sim_telemetry_open(&telemetry_writer, options.telemetry_path, (uint32_t)options.vehicles))
+        {
+            fprintf(stderr, "cannot create %s\n", options.telemetry_path);
+            return headless_trace(&options, 1);
+        }
+        telemetry = &telemetry_writer;
+    }
+
+    const double start = sys_time_seconds();
+    const bool ok = options.single
+        ? headless_run_single(&options, ticks, &checksum, telemetry)
+        : headless_run_fleet(&options, ticks, &checksum, &threads_used, telemetry);
+    const double wall_s = sys_time_seconds() - start;
+
+    if (telemetry != NULL)
+    {
+        const uint64_t rows = telemetry->rows_flushed + telemetry->staged;
+        const bool written = sim_telemetry_close(telemetry);
+        const uint64_t bytes = telemetry->bytes_written;
+        const double raw = (double)rows * (double)sizeof(SimState);
+        printf("telemetry=%s rows=%llu blocks=%llu bytes=%llu raw_bytes=%.0f ratio=%.1fx stall_s=%.3f%s\n",
+            options.telemetry_path, (unsigned long long)rows, (unsigned long long)telemetry->blocks,
+            (unsigned long long)bytes, raw, (bytes > 0U) ? (raw / (double)bytes) : 0.0, telemetry->stall_s,
+            written ? "" : " WRITE FAILED");
+    }
+
+    if (!ok)
+    {
+        fprintf(stderr, "simulation failed (out of memory?)\n");
+        return headless_trace(&options, 1);
+    }
+
+    if (options.advance)
+    {
+        /* No ticks run here: each vehicle jumps event to event, so only simulated time per wall second compares. */
+        const double simulated_s = options.sim_seconds * (double)options.vehicles;
+        printf("mode=advance kernel=%s vehicles=%zu seconds=%.3f threads=%u\n",
+            sim_hvac_kernel_name(sim_hvac_kernel_active()), options.vehicles, options.sim_seconds, threads_used);
+        printf("wall_s=%.3f realtime_factor=%.0f checksum=%.6f\n",
+            wall_s, (wall_s > 0.0) ? (simulated_s / wall_s) : 0.0, checksum);
+        return headless_trace(&options, 0);
+    }
+
+    const double vehicle_steps = (double)ticks * (double)options.vehicles;
+    const double simulated_s = (double)ticks * options.dt * (double)options.vehicles;
+    printf("mode=%s kernel=%s vehicles=%zu ticks=%llu dt=%.6f threads=%u\n",
+        options.exact ? "exact" : (options.single ? "single" : "fleet"),
+        sim_hvac_kernel_name(sim_hvac_kernel_active()),
+        options.vehicles, (unsigned long long)ticks, options.dt, threads_used);
+    printf("wall_s=%.3f steps_per_s=%.0f realtime_factor=%.0f checksum=%.6f\n",
+        wall_s, (wall_s > 0.0) ? (vehicle_steps / wall_s) : 0.0,
+        (wall_s > 0.0) ? (simulated_s / wall_s) : 0.0, checksum);
+    return headless_trace(&options, 0);
+}
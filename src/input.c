@@ -1,113 +1,84 @@
 #include "input.h"
 
-#include <windows.h>
+#include <stddef.h>
+
+#include "sys_trace.h"
 
 static bool is_toggle_press(bool is_down, bool is_repeat)
 {
     return (is_down && !is_repeat);
 }
 
-void input_handle_key(SimState *sim, unsigned int virtual_key, InputEventType type, bool is_repeat)
+static bool input_emit(SimCommand *command, SimCommandKind kind, double value, double time_s)
 {
-    if (sim == NULL)
+    command->kind = kind;
+    command->value = value;
+    command->time_s = time_s;
+    return true;
+}
+
+bool input_translate_key(unsigned int virtual_key, InputEventType type, bool is_repeat, double time_s,
+    SimCommand *command)
+{
+    if (command == NULL)
     {
-        return;
+        return false;
     }
 
     const bool is_down = (type == INPUT_EVENT_KEY_DOWN);
+    const bool is_press = is_toggle_press(is_down, is_repeat);
 
     switch (virtual_key)
     {
-        case VK_LEFT:
-            if (is_toggle_press(is_down, is_repeat))
-            {
-                sim_toggle_left_signal(sim);
-            }
-            break;
-        case VK_RIGHT:
-            if (is_toggle_press(is_down, is_repeat))
-            {
-                sim_toggle_right_signal(sim);
-            }
-            break;
+        case INPUT_KEY_LEFT:
+            return is_press && input_emit(command, SIM_COMMAND_TOGGLE_LEFT, 1.0, time_s);
+        case INPUT_KEY_RIGHT:
+            return is_press && input_emit(command, SIM_COMMAND_TOGGLE_RIGHT, 1.0, time_s);
         case 'H':
-            if (is_toggle_press(is_down, is_repeat))
-            {
-                sim_toggle_hazard(sim);
-            }
-            break;
+            return is_press && input_emit(command, SIM_COMMAND_TOGGLE_HAZARD, 1.0, time_s);
         case 'L':
-            if (is_toggle_press(is_down, is_repeat))
-            {
-                sim_toggle_headlight(sim);
-            }
-            break;
-        case VK_UP:
-            if (is_down)
-            {
-                sim_adjust_throttle(sim, 5.0);
-            }
-            break;
-        case VK_DOWN:
-            if (is_down)
-            {
-                sim_adjust_throttle(sim, -5.0);
-            }
-            break;
-        case VK_SPACE:
-            sim_apply_brake(sim, is_down);
-            break;
+            return is_press && input_emit(command, SIM_COMMAND_TOGGLE_HEADLIGHT, 1.0, time_s);
+        case INPUT_KEY_UP:
+            return is_down && input_emit(command, SIM_COMMAND_THROTTLE_DELTA, 5.0, time_s);
+        case INPUT_KEY_DOWN:
+            return is_down && input_emit(command, SIM_COMMAND_THROTTLE_DELTA, -5.0, time_s);
+        case INPUT_KEY_SPACE:
+            return input_emit(command, SIM_COMMAND_BRAKE, is_down ? 1.0 : 0.0, time_s);
         case 'A':
-            if (is_toggle_press(is_down, is_repeat))
-            {
-                sim_toggle_ac(sim);
-            }
-            break;
+            return is_press && input_emit(command, SIM_COMMAND_TOGGLE_AC, 1.0, time_s);
         case 'F':
-            if (is_toggle_press(is_down, is_repeat))
-            {
-                sim_cycle_fan(sim);
-            }
-            break;
+            return is_press && input_emit(command, SIM_COMMAND_CYCLE_FAN, 1.0, time_s);
         case 'R':
-            if (is_toggle_press(is_down, is_repeat))
-            {
-                sim_toggle_recirc(sim);
-            }
-            break;
+            return is_press && input_emit(command, SIM_COMMAND_TOGGLE_RECIRC, 1.0, time_s);
         case 'D':
-            if (is_toggle_press(is_down, is_repeat))
-            {
-                sim_toggle_defrost(sim);
-            }
-            break;
+            return is_press && input_emit(command, SIM_COMMAND_TOGGLE_DEFROST, 1.0, time_s);
         case 'O':
-            if (is_toggle_press(is_down, is_repeat))
-            {
-                sim_toggle_auto(sim);
-            }
-            break;
+            return is_press && input_emit(command, SIM_COMMAND_TOGGLE_AUTO, 1.0, time_s);
         case 'M':
-            if (is_toggle_press(is_down, is_repeat))
-            {
-                sim_cycle_airflow(sim);
-            }
-            break;
-        case VK_ADD:
-        case VK_OEM_PLUS:
-            if (is_toggle_press(is_down, is_repeat))
-            {
-                sim_adjust_setpoint(sim, 0.5);
-            }
-            break;
-        case VK_SUBTRACT:
-        case VK_OEM_MINUS:
-            if (is_toggle_press(is_down, is_repeat))
-            {
-                sim_adjust_setpoint(sim, -0.5);
-            }
-            break;
+            return is_press && input_emit(command, SIM_COMMAND_CYCLE_AIRFLOW, 1.0, time_s);
+        case INPUT_KEY_ADD:
+        case INPUT_KEY_OEM_PLUS:
+            return is_press && input_emit(command, SIM_COMMAND_SETPOINT_DELTA, 0.5, time_s);
+        case INPUT_KEY_SUBTRACT:
+        case INPUT_KEY_OEM_MINUS:
+            return is_press && input_emit(command, SIM_COMMAND_SETPOINT_DELTA, -0.5, time_s);
         default:
-            break;
+            return false;
+    }
+}
+
+void input_handle_key(SimState *sim, unsigned int virtual_key, InputEventType type, bool is_repeat)
+{
+    if (sim == NULL)
+    {
+        return;
+    }
+
+    SYS_TRACE_BEGIN(input_handle_key);
+    SimCommand command;
+    if (input_translate_key(virtual_key, type, is_repeat, sim->runtime_s, &command))
+    {
+        sim_command_apply(sim, &command);
     }
+    SYS_TRACE_END(input_handle_key);
 }
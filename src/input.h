@@ -8,6 +8,7 @@ extern "C" {
 #include <stdbool.h>
 
 #include "sim.h"
+#include "sim_command.h"
 
 typedef enum
 {
@@ -15,6 +16,24 @@ typedef enum
     INPUT_EVENT_KEY_UP = 1
 } InputEventType;
 
+/* Win32 virtual-key codes used by the cockpit, so input.c needs no windows.h. */
+enum
+{
+    INPUT_KEY_SPACE = 0x20,
+    INPUT_KEY_LEFT = 0x25,
+    INPUT_KEY_UP = 0x26,
+    INPUT_KEY_RIGHT = 0x27,
+    INPUT_KEY_DOWN = 0x28,
+    INPUT_KEY_ADD = 0x6B,
+    INPUT_KEY_SUBTRACT = 0x6D,
+    INPUT_KEY_OEM_PLUS = 0xBB,
+    INPUT_KEY_OEM_MINUS = 0xBD
+};
+
+/* Maps a key event to a command; false when the key (or repeat) does nothing. */
+bool input_translate_key(unsigned int virtual_key, InputEventType type, bool is_repeat, double time_s,
+    SimCommand *command);
+/* Translates and applies immediately on the calling thread. */
 void input_handle_key(SimState *sim, unsigned int virtual_key, InputEventType type, bool is_repeat);
 
 #ifdef __cplusplus
@@ -2,34 +2,293 @@
 #include <windows.h>
 
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
 
 #include "input.h"
 #include "sim.h"
+#include "sim_playback.h"
+#include "sim_replay.h"
+#include "sim_runner.h"
+#include "sys_thread.h"
+#include "sys_trace.h"
 #include "ui.h"
+#include "ui_pace.h"
+
+/* Posted by the sim thread in --low-latency mode once a frame carrying new input is published. */
+#define APP_WM_INPUT_APPLIED (WM_APP + 1)
 
 typedef struct
 {
-    SimState sim;
+    SimRunner runner;
+    SimState render_state;
+    double sim_hz;
+    char record_path[260];
+    SimRecorder recorder;
+    bool recording;
+    char play_path[260];
+    uint32_t play_vehicle;
+    SimPlayback playback;
+    bool playing;
+    double last_frame_s;
+    double title_refresh_s;
     UiState ui;
-    LARGE_INTEGER perf_freq;
-    double last_tick_s;
+    UiPacer pacer;
+    UINT timer_ms;  /* period of timer 1; 0 while minimized */
+    char stats_path[260];
+    bool stats_on_exit; /* --stats-file given: dump the phase histograms on exit too */
+    char trace_path[260]; /* --trace: Chrome trace written on exit (SYS_TRACE builds only) */
+    bool low_latency;   /* --low-latency: input wakes the sim thread and repaints without the timer */
 } AppState;
 
-static double app_query_time(const AppState *app)
+static void app_post_key(AppState *app, WPARAM key, InputEventType type, bool is_repeat)
+{
+    SYS_TRACE_BEGIN(app_post_key);
+    SimCommand command;
+    if (input_translate_key((unsigned int)key, type, is_repeat, sys_time_seconds(), &command)
+        && sim_runner_post_command(&app->runner, &command))
+    {
+        ui_latency_posted(&app->ui.frame_stats, command.time_s);
+    }
+    SYS_TRACE_END(app_post_key);
+}
+
+/* Sim thread, low-latency mode: hand the new frame to the UI thread. */
+static void app_input_applied(void *context)
+{
+    (void)PostMessageW((HWND)context, APP_WM_INPUT_APPLIED, 0, 0);
+}
+
+/* Positive number after name on the command line (e.g. "--sim-hz 1000"); 0 when absent. */
+static double app_parse_number(const wchar_t *cmd, const wchar_t *name)
+{
+    if (cmd == NULL)
+    {
+        return 0.0;
+    }
+
+    const wchar_t *option = wcsstr(cmd, name);
+    if (option == NULL)
+    {
+        return 0.0;
+    }
+
+    const double value = wcstod(option + wcslen(name), NULL);
+    return (value > 0.0) ? value : 0.0;
+}
+
+/* Path after name (e.g. "--record PATH", no spaces); empty when absent. */
+static void app_parse_path(const wchar_t *cmd, const wchar_t *name, char *path, size_t capacity)
+{
+    path[0] = '\0';
+    const wchar_t *option = (cmd != NULL) ? wcsstr(cmd, name) : NULL;
+    if (option == NULL)
+    {
+        return;
+    }
+
+    const wchar_t *begin = option + wcslen(name);
+    while (*begin == L' ')
+    {
+        ++begin;
+    }
+
+    wchar_t wide[260];
+    size_t length = 0U;
+    while ((begin[length] != L'\0') && (begin[length] != L' ') && (length + 1U < 260U))
+    {
+        wide[length] = begin[length];
+        ++length;
+    }
+    wide[length] = L'\0';
+
+    const size_t converted = wcstombs(path, wide, capacity - 1U);
+    path[(converted == (size_t)-1) ? 0U : converted] = '\0';
+}
+
+static void app_playback_title(AppState *app, HWND hwnd)
+{
+    wchar_t title[128];
+    (void)_snwprintf_s(title, sizeof(title) / sizeof(title[0]), _TRUNCATE,
+        L"HVAC Cockpit Simulator - playback %.1f / %.1f s  %gx%ls", app->playback.position_s,
+        app->playback.end_s, app->playback.speed, app->playback.paused ? L"  (paused)" : L"");
+    (void)SetWindowTextW(hwnd, title);
+}
+
+/* Space pause, arrows seek 10 s / change speed, PgUp/PgDn seek 5 min, Home/End jump. */
+static void app_playback_key(AppState *app, WPARAM key)
 {
-    LARGE_INTEGER counter;
-    if ((app != NULL) && (app->perf_freq.QuadPart != 0) && QueryPerformanceCounter(&counter))
+    SimPlayback *playback = &app->playback;
+    switch (key)
     {
-        return (double)counter.QuadPart / (double)app->perf_freq.QuadPart;
+        case VK_SPACE:
+            if (playback->paused && (playback->position_s >= playback->end_s))
+            {
+                sim_playback_seek(playback, playback->start_s);
+            }
+            playback->paused = !playback->paused;
+            break;
+        case VK_LEFT:
+            sim_playback_seek(playback, playback->position_s - 10.0);
+            break;
+        case VK_RIGHT:
+            sim_playback_seek(playback, playback->position_s + 10.0);
+            break;
+        case VK_PRIOR:
+            sim_playback_seek(playback, playback->position_s - 300.0);
+            break;
+        case VK_NEXT:
+            sim_playback_seek(playback, playback->position_s + 300.0);
+            break;
+        case VK_HOME:
+            sim_playback_seek(playback, playback->start_s);
+            break;
+        case VK_END:
+            sim_playback_seek(playback, playback->end_s);
+            break;
+        case VK_UP:
+            sim_playback_set_speed(playback, playback->speed * 2.0);
+            break;
+        case VK_DOWN:
+            sim_playback_set_speed(playback, playback->speed * 0.5);
+            break;
+        default:
+            break;
     }
+}
 
-    return (double)GetTickCount64() / 1000.0;
+/* GDI cache counters for DebugView; created should stay at the warm-up count however long the session. */
+static void app_gdi_report(const UiGdiCache *cache)
+{
+    wchar_t line[160];
+    (void)_snwprintf_s(line, sizeof(line) / sizeof(line[0]), _TRUNCATE,
+        L"cockpit: gdi objects created=%llu cached=%llu hits=%llu uncached=%llu\n",
+        (unsigned long long)cache->created, (unsigned long long)cache->count,
+        (unsigned long long)cache->hits, (unsigned long long)cache->uncached);
+    OutputDebugStringW(line);
 }
 
-static void app_update(AppState *app, double dt)
+/* Pacing counters for DebugView: fps actually painted and the share of 60 Hz slots left idle. */
+static void app_pace_report(const UiPacer *pacer)
 {
-    const double clamped_dt = (dt > 0.05) ? 0.05 : (dt > 0.0 ? dt : (1.0 / 60.0));
-    sim_step(&app->sim, clamped_dt);
+    UiPacerStats stats;
+    ui_pacer_stats(pacer, sys_time_seconds(), &stats);
+    wchar_t line[200];
+    (void)_snwprintf_s(line, sizeof(line) / sizeof(line[0]), _TRUNCATE,
+        L"cockpit: %.0f s fps=%.1f wakes/s=%.1f idle=%.1f%% minimized=%.0f s input wakes=%llu\n",
+        stats.elapsed_s, stats.fps, stats.tick_hz, 100.0 * stats.idle_ratio, stats.paused_s,
+        (unsigned long long)stats.wakes);
+    OutputDebugStringW(line);
+}
+
+/* F4 (and exit with --stats-file): phase histograms as text, for collecting spikes from kiosks. */
+static void app_dump_stats(const AppState *app)
+{
+    FILE *out = fopen(app->stats_path, "w");
+    const bool ok = (out != NULL) && ui_frame_stats_write(&app->ui.frame_stats, out);
+    if (out != NULL)
+    {
+        (void)fclose(out);
+    }
+
+    wchar_t line[320];
+    (void)_snwprintf_s(line, sizeof(line) / sizeof(line[0]), _TRUNCATE, L"cockpit: frame stats %hs %hs\n",
+        ok ? "written to" : "could not be written to", app->stats_path);
+    OutputDebugStringW(line);
+}
+
+/* Runs after the sim thread has stopped, so every ring is quiet. */
+static void app_write_trace(const AppState *app)
+{
+    const bool ok = sys_trace_write(app->trace_path);
+    wchar_t line[320];
+    (void)_snwprintf_s(line, sizeof(line) / sizeof(line[0]), _TRUNCATE, L"cockpit: trace %hs %hs\n",
+        ok ? "written to" : (SYS_TRACE ? "could not be written to" : "not compiled in, nothing written to"),
+        app->trace_path);
+    OutputDebugStringW(line);
+}
+
+static void app_invalidate_stats(AppState *app, HWND hwnd)
+{
+    const UiRect *panel = &app->ui.layout.text_panel;
+    const RECT rect = {panel->left, panel->top, panel->right, panel->bottom};
+    InvalidateRect(hwnd, &rect, FALSE);
+}
+
+/* F3 overlay and F4 dump; true when the key was one of them. */
+static bool app_stats_key(AppState *app, HWND hwnd, WPARAM key)
+{
+    if (key == VK_F3)
+    {
+        app->ui.stats_overlay = !app->ui.stats_overlay;
+        app_invalidate_stats(app, hwnd);
+        return true;
+    }
+    if (key == VK_F4)
+    {
+        app_dump_stats(app);
+        return true;
+    }
+    return false;
+}
+
+/* (Re)arms timer 1 when the period changes; SetTimer on a live id just replaces it. */
+static void app_schedule(AppState *app, HWND hwnd, double interval_s)
+{
+    const UINT ms = (UINT)((interval_s * 1000.0) + 0.5);
+    if (ms != app->timer_ms)
+    {
+        SetTimer(hwnd, 1U, ms, NULL);
+        app->timer_ms = ms;
+    }
+}
+
+/*
+ * Invalidates only the regions whose pixels differ from what was last shown, then paces the next tick.
+ * input_time_s is the newest input next includes (0 when it carries none). While minimized it does
+ * nothing, so timer 1 stays killed until WM_SIZE unpauses the pacer.
+ */
+static void app_show_state(AppState *app, HWND hwnd, const SimState *next, double input_time_s)
+{
+    if (app->pacer.paused)
+    {
+        return;
+    }
+
+    SYS_TRACE_BEGIN(app_show_state);
+    UiRect rects[UI_REGION_COUNT];
+    const size_t count = ui_dirty_rects(&app->render_state, next, &app->ui.layout, rects, UI_REGION_COUNT);
+    app->render_state = *next;
+    ui_latency_applied(&app->ui.frame_stats, input_time_s, count > 0U);
+    for (size_t i = 0U; i < count; ++i)
+    {
+        const RECT rect = {rects[i].left, rects[i].top, rects[i].right, rects[i].bottom};
+        InvalidateRect(hwnd, &rect, FALSE);
+    }
+    if (app->ui.stats_overlay)
+    {
+        app_invalidate_stats(app, hwnd);
+    }
+    app_schedule(app, hwnd, ui_pacer_tick(&app->pacer, sys_time_seconds(), next, count > 0U, &app->ui.layout));
+    SYS_TRACE_END(app_show_state);
+}
+
+static void app_show_runner_state(AppState *app, HWND hwnd)
+{
+    SimState next;
+    double input_time_s = 0.0;
+    sim_runner_render_state(&app->runner, sys_time_seconds(), &next, &input_time_s);
+    app_show_state(app, hwnd, &next, input_time_s);
+}
+
+/* Input goes back to full rate at once, whatever the pacer was waiting for. */
+static void app_wake(AppState *app, HWND hwnd)
+{
+    if (!app->pacer.paused)
+    {
+        app_schedule(app, hwnd, ui_pacer_wake(&app->pacer));
+    }
 }
 
 static LRESULT CALLBACK MainWndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
@@ -48,36 +307,99 @@ static LRESULT CALLBACK MainWndProc(HWND hwnd, UINT message, WPARAM wParam, LPAR
             }
 
             SetWindowLongPtr(hwnd, GWLP_USERDATA, (LONG_PTR)app);
-            sim_init(&app->sim);
-            if (!QueryPerformanceFrequency(&app->perf_freq))
+            app->playing = (app->play_path[0] != '\0')
+                && sim_playback_open(&app->playback, app->play_path, app->play_vehicle);
+            if (app->playing)
+            {
+                app->last_frame_s = sys_time_seconds();
+                (void)sim_playback_state(&app->playback, &app->render_state);
+                ui_init(&app->ui, hwnd);
+                ui_pacer_init(&app->pacer, app->last_frame_s);
+                app_schedule(app, hwnd, UI_PACE_FRAME_S);
+                return 0;
+            }
+
+            SimState initial;
+            sim_init(&initial);
+            app->recording = (app->record_path[0] != '\0')
+                && sim_recorder_open(&app->recorder, app->record_path, &initial);
+            if (app->low_latency)
+            {
+                sim_runner_set_low_latency(&app->runner, app_input_applied, hwnd);
+            }
+            if (!sim_runner_start(&app->runner, app->sim_hz, &initial, app->recording ? &app->recorder : NULL))
             {
-                app->perf_freq.QuadPart = 0;
+                return -1;
             }
-            app->last_tick_s = app_query_time(app);
+            app->render_state = app->runner.loop.current;
             ui_init(&app->ui, hwnd);
-            SetTimer(hwnd, 1U, 16U, NULL);
+            ui_pacer_init(&app->pacer, sys_time_seconds());
+            app_schedule(app, hwnd, UI_PACE_FRAME_S);
             return 0;
         }
         case WM_SIZE:
-            if (app != NULL)
+            if ((app != NULL) && (wParam == SIZE_MINIMIZED))
+            {
+                /* Nothing is visible: stop ticking, and keep the back buffers at their real size. */
+                KillTimer(hwnd, 1U);
+                app->timer_ms = 0U;
+                ui_pacer_set_paused(&app->pacer, sys_time_seconds(), true);
+            }
+            else if (app != NULL)
             {
                 const int width = (int)LOWORD(lParam);
                 const int height = (int)HIWORD(lParam);
                 ui_resize(&app->ui, hwnd, width, height);
+                if (app->pacer.paused)
+                {
+                    ui_pacer_set_paused(&app->pacer, sys_time_seconds(), false);
+                    app_schedule(app, hwnd, UI_PACE_FRAME_S);
+                }
+            }
+            else
+            {
+                /* no action */
             }
             return 0;
         case WM_TIMER:
-            if ((app != NULL) && (wParam == 1U))
+        {
+            const double update_start = (app != NULL) ? ui_phase_begin(&app->ui.frame_stats) : 0.0;
+            if ((app != NULL) && (wParam == 1U) && app->playing)
             {
-                const double now = app_query_time(app);
-                double dt = now - app->last_tick_s;
-                if (dt < 0.0)
+                const double now = sys_time_seconds();
+                sim_playback_advance(&app->playback, now - app->last_frame_s);
+                app->last_frame_s = now;
+                SimState next = app->render_state;
+                (void)sim_playback_state(&app->playback, &next);
+                app_show_state(app, hwnd, &next, 0.0);
+                if (now >= app->title_refresh_s)
                 {
-                    dt = 0.0;
+                    app_playback_title(app, hwnd);
+                    app->title_refresh_s = now + 0.25;
                 }
-                app->last_tick_s = now;
-                app_update(app, dt);
-                InvalidateRect(hwnd, NULL, FALSE);
+            }
+            else if ((app != NULL) && (wParam == 1U))
+            {
+                app_show_runner_state(app, hwnd);
+            }
+            else
+            {
+                /* no action */
+            }
+            if ((app != NULL) && (wParam == 1U))
+            {
+                ui_phase_end(&app->ui.frame_stats, UI_PHASE_UPDATE, update_start);
+            }
+            return 0;
+        }
+        case APP_WM_INPUT_APPLIED:
+            if ((app != NULL) && !app->playing && !app->pacer.paused)
+            {
+                /* Repaint just the changed regions now instead of at the next timer tick; nothing while minimized. */
+                const double update_start = ui_phase_begin(&app->ui.frame_stats);
+                app_show_runner_state(app, hwnd);
+                ui_phase_end(&app->ui.frame_stats, UI_PHASE_UPDATE, update_start);
+                UpdateWindow(hwnd);
             }
             return 0;
         case WM_ERASEBKGND:
@@ -86,15 +408,33 @@ static LRESULT CALLBACK MainWndProc(HWND hwnd, UINT message, WPARAM wParam, LPAR
         case WM_SYSKEYDOWN:
             if (app != NULL)
             {
+                const double input_start = ui_phase_begin(&app->ui.frame_stats);
                 const bool is_repeat = ((lParam & (1L << 30)) != 0);
-                input_handle_key(&app->sim, (unsigned int)wParam, INPUT_EVENT_KEY_DOWN, is_repeat);
+                /* Alt+F4 arrives as WM_SYSKEYDOWN and is not a dump request. */
+                if (is_repeat || (message != WM_KEYDOWN) || !app_stats_key(app, hwnd, wParam))
+                {
+                    if (app->playing)
+                    {
+                        app_playback_key(app, wParam);
+                        app->title_refresh_s = 0.0;
+                    }
+                    else
+                    {
+                        app_post_key(app, wParam, INPUT_EVENT_KEY_DOWN, is_repeat);
+                    }
+                    app_wake(app, hwnd);
+                }
+                ui_phase_end(&app->ui.frame_stats, UI_PHASE_INPUT, input_start);
             }
             return 0;
         case WM_KEYUP:
         case WM_SYSKEYUP:
-            if (app != NULL)
+            if ((app != NULL) && !app->playing)
             {
-                input_handle_key(&app->sim, (unsigned int)wParam, INPUT_EVENT_KEY_UP, false);
+                const double input_start = ui_phase_begin(&app->ui.frame_stats);
+                app_post_key(app, wParam, INPUT_EVENT_KEY_UP, false);
+                app_wake(app, hwnd);
+                ui_phase_end(&app->ui.frame_stats, UI_PHASE_INPUT, input_start);
             }
             return 0;
         case WM_PAINT:
@@ -102,7 +442,8 @@ static LRESULT CALLBACK MainWndProc(HWND hwnd, UINT message, WPARAM wParam, LPAR
             {
                 PAINTSTRUCT ps;
                 HDC dc = BeginPaint(hwnd, &ps);
-                ui_render(&app->ui, dc, &app->sim);
+                ui_render(&app->ui, dc, &app->render_state, &ps.rcPaint);
+                ui_latency_presented(&app->ui.frame_stats, sys_time_seconds());
                 EndPaint(hwnd, &ps);
                 return 0;
             }
@@ -111,6 +452,28 @@ static LRESULT CALLBACK MainWndProc(HWND hwnd, UINT message, WPARAM wParam, LPAR
             if (app != NULL)
             {
                 KillTimer(hwnd, 1U);
+                sim_runner_stop(&app->runner);
+                if (app->recording)
+                {
+                    (void)sim_recorder_close(&app->recorder);
+                    app->recording = false;
+                }
+                if (app->playing)
+                {
+                    sim_playback_close(&app->playback);
+                    app->playing = false;
+                }
+                app_gdi_report(&app->ui.gdi_cache);
+                app_pace_report(&app->pacer);
+                if (app->stats_on_exit)
+                {
+                    app_dump_stats(app);
+                }
+                if (app->trace_path[0] != '\0')
+                {
+                    app_write_trace(app);
+                }
+                sys_trace_shutdown();
                 ui_destroy(&app->ui);
             }
             PostQuitMessage(0);
@@ -125,7 +488,6 @@ static LRESULT CALLBACK MainWndProc(HWND hwnd, UINT message, WPARAM wParam, LPAR
 int APIENTRY wWinMain(HINSTANCE instance, HINSTANCE prev, LPWSTR cmd, int show)
 {
     (void)prev;
-    (void)cmd;
 
     WNDCLASSEXW wc;
     ZeroMemory(&wc, sizeof(wc));
@@ -144,6 +506,19 @@ int APIENTRY wWinMain(HINSTANCE instance, HINSTANCE prev, LPWSTR cmd, int show)
 
     AppState app_state;
     ZeroMemory(&app_state, sizeof(app_state));
+    app_state.sim_hz = app_parse_number(cmd, L"--sim-hz");
+    app_parse_path(cmd, L"--record", app_state.record_path, sizeof(app_state.record_path));
+    app_parse_path(cmd, L"--play", app_state.play_path, sizeof(app_state.play_path));
+    app_state.play_vehicle = (uint32_t)app_parse_number(cmd, L"--vehicle");
+    app_parse_path(cmd, L"--stats-file", app_state.stats_path, sizeof(app_state.stats_path));
+    app_state.stats_on_exit = (app_state.stats_path[0] != '\0');
+    if (!app_state.stats_on_exit)
+    {
+        (void)snprintf(app_state.stats_path, sizeof(app_state.stats_path), "frame_stats.txt");
+    }
+    app_parse_path(cmd, L"--trace", app_state.trace_path, sizeof(app_state.trace_path));
+    app_state.low_latency = (cmd != NULL) && (wcsstr(cmd, L"--low-latency") != NULL);
+    SYS_TRACE_THREAD("ui");
 
     HWND hwnd = CreateWindowExW(0, wc.lpszClassName, L"HVAC Cockpit Simulator",
         WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT, 1280, 720,
@@ -153,6 +528,8 @@ int APIENTRY wWinMain(HINSTANCE instance, HINSTANCE prev, LPWSTR cmd, int show)
     {
         return 0;
     }
+    /* Phase timing is on unless asked otherwise; the overlay and F4 dump then show empty histograms. */
+    app_state.ui.frame_stats.enabled = (cmd == NULL) || (wcsstr(cmd, L"--no-frame-stats") == NULL);
 
     ShowWindow(hwnd, show);
     UpdateWindow(hwnd);
@@ -1,51 +1,18 @@
 #include "sim.h"
+#include "sim_clamp.h"
+#include "sim_stages.h"
+#include "sys_trace.h"
 
 #include <math.h>
 #include <stddef.h>
 
 #define QAC_TRAINING 0
 
-static double clamp_range(double value, double min_value, double max_value)
-{
-    double result = value;
-    if (result < min_value)
-    {
-        result = min_value;
-    }
-    else if (result > max_value)
-    {
-        result = max_value;
-    }
-    else
-    {
-        /* no action */
-    }
-    return result;
-}
-
-static int clamp_int(int value, int min_value, int max_value)
-{
-    int result = value;
-    if (result < min_value)
-    {
-        result = min_value;
-    }
-    else if (result > max_value)
-    {
-        result = max_value;
-    }
-    else
-    {
-        /* no action */
-    }
-    return result;
-}
-
 static void normalize_setpoint(HvacState *hvac)
 {
     double snapped = hvac->setpoint_c * 2.0;
     snapped = floor(snapped + 0.5);
-    hvac->setpoint_c = clamp_range(snapped / 2.0, 16.0, 30.0);
+    hvac->setpoint_c = sim_clamp_range(snapped / 2.0, 16.0, 30.0);
 }
 
 void sim_init(SimState *state)
@@ -146,7 +113,7 @@ static void apply_auto_logic(HvacState *hvac)
     {
         const double fan_raw = 2.0 + (3.0 * fabs(delta));
         int fan_target = (int)floor(fan_raw + 0.5);
-        fan_target = clamp_int(fan_target, 1, 7);
+        fan_target = sim_clamp_int(fan_target, 1, 7);
         hvac->fan_level = fan_target;
     }
 
@@ -169,7 +136,7 @@ static void apply_auto_logic(HvacState *hvac)
 static void update_hvac(SimState *state, double dt)
 {
     HvacState *hvac = &state->hvac;
-    hvac->fan_level = clamp_int(hvac->fan_level, 0, 7);
+    hvac->fan_level = sim_clamp_int(hvac->fan_level, 0, 7);
     apply_auto_logic(hvac);
 
     const double fan_ratio = (hvac->fan_level <= 0) ? 0.0 : ((double)hvac->fan_level / 7.0);
@@ -193,7 +160,178 @@ static void update_hvac(SimState *state, double dt)
     const double q_leak = 0.15 * (hvac->outside_temp_c - hvac->cabin_temp_c) * leak_factor;
 
     hvac->cabin_temp_c += dt * ((-q_cool) + q_heat + q_leak);
-    hvac->cabin_temp_c = clamp_range(hvac->cabin_temp_c, -20.0, 60.0);
+    hvac->cabin_temp_c = sim_clamp_range(hvac->cabin_temp_c, -20.0, 60.0);
+}
+
+static void update_drivetrain(SimState *state, double dt)
+{
+    state->throttle_pct = sim_clamp_range(state->throttle_pct, 0.0, 100.0);
+    state->brake_pct = sim_clamp_range(state->brake_pct, 0.0, 100.0);
+
+    const double accel_term = (0.05 * state->throttle_pct - 0.04 - 0.15 * state->brake_pct) * dt * 100.0;
+    state->velocity_kmh = sim_clamp_range(state->velocity_kmh + accel_term, 0.0, 200.0);
+
+    const double rpm_value = 800.0 + (state->velocity_kmh * 60.0);
+    state->rpm = sim_clamp_range(rpm_value, 800.0, 7000.0);
+
+    const double fuel_delta = 0.002 * state->throttle_pct * dt;
+    state->fuel_pct = sim_clamp_range(state->fuel_pct - fuel_delta, 0.0, 100.0);
+}
+
+/*
+ * Exact integration of the cabin model. For fixed AC/fan/heater settings and a
+ * fixed sign of delta = cabin - setpoint, update_hvac() is the linear ODE
+ *     dT/dt = -lambda * (T - T_eq)
+ * with lambda = c_cool + c_heat + c_leak (c_leak > 0 always), which has the closed
+ * form T(t) = T_eq + (T0 - T_eq) * exp(-lambda * t). The step is split wherever T
+ * crosses a value that changes those coefficients: the setpoint itself, the AUTO
+ * AC hysteresis edges (+0.5 / -1.0), the AUTO fan rounding edges and the clamp
+ * limits. AUTO decisions are re-evaluated just past each crossing.
+ */
+#define EXACT_MAX_SEGMENTS 64
+#define EXACT_PROBE_C 1e-9
+
+static const double k_auto_edges_c[] = {
+    0.0, 0.5, -1.0,
+    1.0 / 6.0, -1.0 / 6.0, 0.5, -0.5, 5.0 / 6.0, -5.0 / 6.0,
+    7.0 / 6.0, -7.0 / 6.0, 1.5, -1.5,
+};
+
+static double exact_next_edge(const HvacState *hvac, double cabin, double target, double dir)
+{
+    double best = target;
+    const size_t edge_count = hvac->auto_mode ? (sizeof(k_auto_edges_c) / sizeof(k_auto_edges_c[0])) : 1U;
+    for (size_t i = 0U; i < edge_count; ++i)
+    {
+        const double edge = hvac->setpoint_c + k_auto_edges_c[i];
+        if ((((edge - cabin) * dir) > 0.0) && (((best - edge) * dir) > 0.0))
+        {
+            best = edge;
+        }
+    }
+
+    const double limit = (dir > 0.0) ? 60.0 : -20.0;
+    if ((((limit - cabin) * dir) > 0.0) && (((best - limit) * dir) > 0.0))
+    {
+        best = limit;
+    }
+    return best;
+}
+
+typedef struct
+{
+    double lambda;
+    double t_eq;
+    double dir;
+    double edge;
+} ExactRegime;
+
+/* Applies the AUTO decisions for the side of cabin selected by bias and describes
+ * the linear regime that holds from cabin until edge. */
+static void exact_regime(HvacState *hvac, double cabin, double bias, ExactRegime *regime)
+{
+    /* Decide the regime from a point just on the side we are moving into. */
+    double probe = cabin + bias;
+    if (probe == hvac->setpoint_c)
+    {
+        probe += (hvac->outside_temp_c >= hvac->setpoint_c) ? EXACT_PROBE_C : -EXACT_PROBE_C;
+    }
+    hvac->cabin_temp_c = probe;
+    apply_auto_logic(hvac);
+    hvac->cabin_temp_c = cabin;
+
+    const double region_delta = probe - hvac->setpoint_c;
+    const double fan_ratio = (hvac->fan_level <= 0) ? 0.0 : ((double)hvac->fan_level / 7.0);
+    const double recirc_gain = hvac->recirculation_on ? 1.2 : 1.0;
+    const double leak_factor = hvac->recirculation_on ? 0.5 : 1.0;
+    const double heater_gain = hvac->engine_warm ? 3.0 : 0.6;
+    const double c_cool = (hvac->ac_on && (region_delta > 0.0)) ? (2.5 * fan_ratio * recirc_gain) : 0.0;
+    const double c_heat = (region_delta < 0.0) ? (heater_gain * fan_ratio) : 0.0;
+    const double c_leak = 0.15 * leak_factor;
+
+    regime->lambda = c_cool + c_heat + c_leak;
+    regime->t_eq = (((c_cool + c_heat) * hvac->setpoint_c) + (c_leak * hvac->outside_temp_c)) / regime->lambda;
+    regime->dir = (regime->t_eq > cabin) ? 1.0 : ((regime->t_eq < cabin) ? -1.0 : 0.0);
+    regime->edge = (regime->dir == 0.0) ? cabin : exact_next_edge(hvac, cabin, regime->t_eq, regime->dir);
+}
+
+/* Time for the regime to carry cabin to its edge; HUGE_VAL if it never gets there. */
+static double exact_time_to_edge(const ExactRegime *regime, double cabin)
+{
+    if ((regime->dir == 0.0) || (regime->edge == regime->t_eq))
+    {
+        return HUGE_VAL;
+    }
+    return log((cabin - regime->t_eq) / (regime->edge - regime->t_eq)) / regime->lambda;
+}
+
+/*
+ * A step may start where the last one held cabin on an edge. The regime at the
+ * edge itself (what a short sim_step() would use) picks the side to move into,
+ * and the caller then applies the same hold rule as after a mid-step crossing.
+ * Returns that side as a probe bias, or 0 when cabin is not on an edge.
+ */
+static double exact_entry_bias(HvacState *hvac, double cabin)
+{
+    bool on_edge = false;
+    const size_t edge_count = hvac->auto_mode ? (sizeof(k_auto_edges_c) / sizeof(k_auto_edges_c[0])) : 1U;
+    for (size_t i = 0U; i < edge_count; ++i)
+    {
+        on_edge = on_edge || (cabin == (hvac->setpoint_c + k_auto_edges_c[i]));
+    }
+    if (!on_edge)
+    {
+        return 0.0;
+    }
+
+    ExactRegime at_edge;
+    exact_regime(hvac, cabin, 0.0, &at_edge);
+    return at_edge.dir * EXACT_PROBE_C;
+}
+
+static void integrate_hvac_exact(HvacState *hvac, double dt)
+{
+    double cabin = hvac->cabin_temp_c;
+    double remaining = dt;
+    double bias = exact_entry_bias(hvac, cabin);
+    int segment = 0;
+
+    for (; (segment < EXACT_MAX_SEGMENTS) && (remaining > 0.0); ++segment)
+    {
+        ExactRegime regime;
+        exact_regime(hvac, cabin, bias, &regime);
+        if ((regime.dir == 0.0) || ((bias * regime.dir) < 0.0))
+        {
+            /* At rest, or the new regime pushes straight back: hold on the edge. */
+            break;
+        }
+
+        const double t_cross = exact_time_to_edge(&regime, cabin);
+        if (t_cross >= remaining)
+        {
+            cabin = regime.t_eq + ((cabin - regime.t_eq) * exp(-regime.lambda * remaining));
+            remaining = 0.0;
+            break;
+        }
+
+        cabin = regime.edge;
+        remaining -= t_cross;
+        bias = regime.dir * EXACT_PROBE_C;
+        if ((regime.edge == 60.0) || (regime.edge == -20.0))
+        {
+            break;
+        }
+    }
+
+    if ((segment == EXACT_MAX_SEGMENTS) && (remaining > 0.0))
+    {
+        /* Out of segments: finish in the current regime rather than dropping time. */
+        ExactRegime regime;
+        exact_regime(hvac, cabin, bias, &regime);
+        cabin = regime.t_eq + ((cabin - regime.t_eq) * exp(-regime.lambda * remaining));
+    }
+
+    hvac->cabin_temp_c = sim_clamp_range(cabin, -20.0, 60.0);
 }
 
 void sim_step(SimState *state, double dt)
@@ -218,24 +356,302 @@ void sim_step(SimState *state, double dt)
 #endif
 
     const double step_dt = safe_dt;
+    SYS_TRACE_BEGIN(sim_step);
     state->runtime_s += step_dt;
 
+    SYS_TRACE_BEGIN(update_indicators);
     update_indicators(&state->indicators, step_dt);
+    SYS_TRACE_END(update_indicators);
+    update_drivetrain(state, step_dt);
+    SYS_TRACE_BEGIN(update_engine_state);
+    update_engine_state(state, step_dt);
+    SYS_TRACE_END(update_engine_state);
+    SYS_TRACE_BEGIN(update_hvac);
+    update_hvac(state, step_dt);
+    SYS_TRACE_END(update_hvac);
+    SYS_TRACE_END(sim_step);
+}
 
-    state->throttle_pct = clamp_range(state->throttle_pct, 0.0, 100.0);
-    state->brake_pct = clamp_range(state->brake_pct, 0.0, 100.0);
+void sim_stage_update_indicators(IndicatorState *indicators, double dt)
+{
+    if (indicators == NULL)
+    {
+        return;
+    }
 
-    const double accel_term = (0.05 * state->throttle_pct - 0.04 - 0.15 * state->brake_pct) * step_dt * 100.0;
-    state->velocity_kmh = clamp_range(state->velocity_kmh + accel_term, 0.0, 200.0);
+    update_indicators(indicators, dt);
+}
 
-    const double rpm_value = 800.0 + (state->velocity_kmh * 60.0);
-    state->rpm = clamp_range(rpm_value, 800.0, 7000.0);
+void sim_stage_update_engine_state(SimState *state, double dt)
+{
+    if (state == NULL)
+    {
+        return;
+    }
 
-    const double fuel_delta = 0.002 * state->throttle_pct * step_dt;
-    state->fuel_pct = clamp_range(state->fuel_pct - fuel_delta, 0.0, 100.0);
+    update_engine_state(state, dt);
+}
 
-    update_engine_state(state, step_dt);
-    update_hvac(state, step_dt);
+void sim_stage_apply_auto_logic(HvacState *hvac)
+{
+    if (hvac == NULL)
+    {
+        return;
+    }
+
+    apply_auto_logic(hvac);
+}
+
+void sim_stage_update_hvac(SimState *state, double dt)
+{
+    if (state == NULL)
+    {
+        return;
+    }
+
+    update_hvac(state, dt);
+}
+
+/* Blink phase advanced in O(1); same result as update_indicators() up to rounding. */
+static void advance_indicators(IndicatorState *indicators, double dt)
+{
+    const double blink_interval = 1.0 / 3.0;
+    double elapsed = indicators->blink_elapsed + dt;
+    if (elapsed < blink_interval)
+    {
+        indicators->blink_elapsed = elapsed;
+        return;
+    }
+
+    double toggles = floor(elapsed / blink_interval);
+    elapsed -= toggles * blink_interval;
+    if (elapsed >= blink_interval)
+    {
+        elapsed -= blink_interval;
+        toggles += 1.0;
+    }
+    else if (elapsed < 0.0)
+    {
+        elapsed += blink_interval;
+        toggles -= 1.0;
+    }
+    else
+    {
+        /* no action */
+    }
+
+    if (fmod(toggles, 2.0) != 0.0)
+    {
+        indicators->blink_on = !indicators->blink_on;
+    }
+    indicators->blink_elapsed = elapsed;
+}
+
+static double accel_kmh_per_s(const SimState *state)
+{
+    const double throttle = sim_clamp_range(state->throttle_pct, 0.0, 100.0);
+    const double brake = sim_clamp_range(state->brake_pct, 0.0, 100.0);
+    return (0.05 * throttle - 0.04 - 0.15 * brake) * 100.0;
+}
+
+/* Time for velocity to move linearly from v to target at accel; HUGE_VAL if never. */
+static double time_to_velocity(double v, double accel, double target)
+{
+    if (((accel > 0.0) && (v < target)) || ((accel < 0.0) && (v > target)))
+    {
+        return (target - v) / accel;
+    }
+    return HUGE_VAL;
+}
+
+double sim_time_to_next_event(const SimState *state, unsigned event_mask, SimEventKind *kind)
+{
+    double best = HUGE_VAL;
+    SimEventKind best_kind = SIM_EVENT_NONE;
+    if (state == NULL)
+    {
+        if (kind != NULL)
+        {
+            *kind = best_kind;
+        }
+        return best;
+    }
+
+    double candidate[6];
+    const SimEventKind kinds[6] = {
+        SIM_EVENT_BLINK_TOGGLE, SIM_EVENT_ENGINE_WARM, SIM_EVENT_VELOCITY_LIMIT,
+        SIM_EVENT_RPM_HOT, SIM_EVENT_FUEL_EMPTY, SIM_EVENT_AUTO_THRESHOLD,
+    };
+
+    candidate[0] = (1.0 / 3.0) - state->indicators.blink_elapsed;
+
+    const double accel = accel_kmh_per_s(state);
+    const double rpm_hot_kmh = (1500.0 - 800.0) / 60.0;
+    const bool rpm_hot = (state->rpm > 1500.0);
+    candidate[1] = HUGE_VAL;
+    if (!state->hvac.engine_warm)
+    {
+        candidate[1] = 60.0 - state->hvac.warmup_elapsed_s;
+        if (rpm_hot && ((10.0 - state->hvac.rpm_hot_s) < candidate[1]))
+        {
+            candidate[1] = 10.0 - state->hvac.rpm_hot_s;
+        }
+    }
+
+    candidate[2] = (accel > 0.0) ? time_to_velocity(state->velocity_kmh, accel, 200.0)
+        : time_to_velocity(state->velocity_kmh, accel, 0.0);
+    candidate[3] = time_to_velocity(state->velocity_kmh, accel, rpm_hot_kmh);
+
+    const double throttle = sim_clamp_range(state->throttle_pct, 0.0, 100.0);
+    candidate[4] = ((throttle > 0.0) && (state->fuel_pct > 0.0))
+        ? (state->fuel_pct / (0.002 * throttle)) : HUGE_VAL;
+
+    candidate[5] = HUGE_VAL;
+    if (state->hvac.auto_mode)
+    {
+        HvacState scratch = state->hvac;
+        ExactRegime regime;
+        scratch.fan_level = sim_clamp_int(scratch.fan_level, 0, 7);
+        exact_regime(&scratch, scratch.cabin_temp_c, 0.0, &regime);
+        candidate[5] = exact_time_to_edge(&regime, state->hvac.cabin_temp_c);
+    }
+
+    for (size_t i = 0U; i < (sizeof(kinds) / sizeof(kinds[0])); ++i)
+    {
+        if (((event_mask & (unsigned)kinds[i]) != 0U) && (candidate[i] < best))
+        {
+            best = (candidate[i] > 0.0) ? candidate[i] : 0.0;
+            best_kind = kinds[i];
+        }
+    }
+
+    if (kind != NULL)
+    {
+        *kind = best_kind;
+    }
+    return best;
+}
+
+/* Drivetrain, warm-up and cabin over a span that crosses neither the 1500 rpm
+ * edge nor the warm-up event, so one rpm_hot value and heater gain hold throughout. */
+static void advance_powertrain(SimState *state, double dt)
+{
+    /* The span never straddles the 1500 rpm edge, so its midpoint decides. */
+    const double mid_kmh = sim_clamp_range(state->velocity_kmh + (0.5 * accel_kmh_per_s(state) * dt), 0.0, 200.0);
+    const bool rpm_hot = ((800.0 + (mid_kmh * 60.0)) > 1500.0);
+
+    update_drivetrain(state, dt);
+
+    /* The span ends at the warm-up event, so all of it still runs with the heater
+     * gain it started with; the flag latches afterwards. */
+    HvacState *hvac = &state->hvac;
+    hvac->fan_level = sim_clamp_int(hvac->fan_level, 0, 7);
+    integrate_hvac_exact(hvac, dt);
+
+    hvac->warmup_elapsed_s += dt;
+    hvac->rpm_hot_s = rpm_hot ? (hvac->rpm_hot_s + dt) : 0.0;
+    if (!hvac->engine_warm && ((hvac->warmup_elapsed_s >= 60.0) || (hvac->rpm_hot_s >= 10.0)))
+    {
+        hvac->engine_warm = true;
+    }
+}
+
+/* Between two events every quantity is linear, clamped-linear or exponential. */
+static void advance_segment(SimState *state, double dt)
+{
+    state->runtime_s += dt;
+    advance_indicators(&state->indicators, dt);
+    advance_powertrain(state, dt);
+}
+
+void sim_step_exact(SimState *state, double dt)
+{
+    if (state == NULL)
+    {
+        return;
+    }
+
+    const double step_dt = (dt > 0.0) ? dt : 0.0;
+    state->runtime_s += step_dt;
+    update_indicators(&state->indicators, step_dt);
+
+    /* rpm_hot_s and the heater gain change at the 1500 rpm edge and at warm-up, so
+     * split the step there; at most a few pieces since velocity is monotonic. */
+    const unsigned split_mask = (unsigned)SIM_EVENT_ENGINE_WARM | (unsigned)SIM_EVENT_RPM_HOT;
+    const double min_piece_s = 1e-6;
+    double remaining = step_dt;
+    while (remaining > 0.0)
+    {
+        double piece = sim_time_to_next_event(state, split_mask, NULL);
+        if (piece < min_piece_s)
+        {
+            piece = min_piece_s;
+        }
+        if (piece > remaining)
+        {
+            piece = remaining;
+        }
+
+        advance_powertrain(state, piece);
+        remaining -= piece;
+    }
+}
+
+void sim_advance_to(SimState *state, double t_target)
+{
+    if (state == NULL)
+    {
+        return;
+    }
+
+    /* Blink toggles and AUTO crossings are handled inside a segment; only events
+     * that change the coefficients of the other stages need their own segment. */
+    const unsigned split_mask = (unsigned)SIM_EVENT_ENGINE_WARM | (unsigned)SIM_EVENT_VELOCITY_LIMIT
+        | (unsigned)SIM_EVENT_RPM_HOT | (unsigned)SIM_EVENT_FUEL_EMPTY;
+    const double min_segment_s = 1e-6;
+
+    while (state->runtime_s < t_target)
+    {
+        const double remaining = t_target - state->runtime_s;
+        double segment = sim_time_to_next_event(state, split_mask, NULL);
+        if (segment < min_segment_s)
+        {
+            segment = min_segment_s;
+        }
+
+        if (segment >= remaining)
+        {
+            advance_segment(state, remaining);
+            state->runtime_s = t_target;
+        }
+        else
+        {
+            advance_segment(state, segment);
+        }
+    }
+}
+
+static double lerp(double a, double b, double t)
+{
+    return a + ((b - a) * t);
+}
+
+void sim_interpolate(const SimState *from, const SimState *to, double alpha, SimState *out)
+{
+    if ((from == NULL) || (to == NULL) || (out == NULL))
+    {
+        return;
+    }
+
+    const double t = sim_clamp_range(alpha, 0.0, 1.0);
+    *out = *to;
+    out->velocity_kmh = lerp(from->velocity_kmh, to->velocity_kmh, t);
+    out->throttle_pct = lerp(from->throttle_pct, to->throttle_pct, t);
+    out->brake_pct = lerp(from->brake_pct, to->brake_pct, t);
+    out->rpm = lerp(from->rpm, to->rpm, t);
+    out->fuel_pct = lerp(from->fuel_pct, to->fuel_pct, t);
+    out->runtime_s = lerp(from->runtime_s, to->runtime_s, t);
+    out->hvac.cabin_temp_c = lerp(from->hvac.cabin_temp_c, to->hvac.cabin_temp_c, t);
 }
 
 void sim_toggle_left_signal(SimState *state)
@@ -299,7 +715,7 @@ void sim_adjust_throttle(SimState *state, double delta_pct)
         return;
     }
 
-    state->throttle_pct = clamp_range(state->throttle_pct + delta_pct, 0.0, 100.0);
+    state->throttle_pct = sim_clamp_range(state->throttle_pct + delta_pct, 0.0, 100.0);
 }
 
 void sim_apply_brake(SimState *state, bool pressed)
@@ -397,6 +813,6 @@ void sim_adjust_setpoint(SimState *state, double delta_c)
         return;
     }
 
-    state->hvac.setpoint_c = clamp_range(state->hvac.setpoint_c + delta_c, 16.0, 30.0);
+    state->hvac.setpoint_c = sim_clamp_range(state->hvac.setpoint_c + delta_c, 16.0, 30.0);
     normalize_setpoint(&state->hvac);
 }
@@ -53,8 +53,32 @@ typedef struct
     HvacState hvac;
 } SimState;
 
+typedef enum
+{
+    SIM_EVENT_NONE = 0,
+    SIM_EVENT_BLINK_TOGGLE = 0x01,
+    SIM_EVENT_ENGINE_WARM = 0x02,
+    SIM_EVENT_VELOCITY_LIMIT = 0x04,
+    SIM_EVENT_RPM_HOT = 0x08,
+    SIM_EVENT_FUEL_EMPTY = 0x10,
+    SIM_EVENT_AUTO_THRESHOLD = 0x20,
+    SIM_EVENT_ALL = 0x3F
+} SimEventKind;
+
 void sim_init(SimState *state);
 void sim_step(SimState *state, double dt);
+/* Same as sim_step() but integrates the cabin temperature analytically, so dt may
+ * be minutes long without losing accuracy or stability. */
+void sim_step_exact(SimState *state, double dt);
+/* Seconds until the next event in event_mask (SimEventKind bits) with the current
+ * inputs held, or HUGE_VAL if none is pending; *kind (optional) names it. */
+double sim_time_to_next_event(const SimState *state, unsigned event_mask, SimEventKind *kind);
+/* Advances to runtime_s == t_target with inputs held, jumping from event to event
+ * instead of ticking; cost depends on the number of events, not on the span. */
+void sim_advance_to(SimState *state, double t_target);
+/* Blends the continuous quantities (speed, rpm, fuel, cabin temperature, ...) of
+ * two states; discrete flags and levels are taken from to. */
+void sim_interpolate(const SimState *from, const SimState *to, double alpha, SimState *out);
 void sim_toggle_left_signal(SimState *state);
 void sim_toggle_right_signal(SimState *state);
 void sim_toggle_hazard(SimState *state);
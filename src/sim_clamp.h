@@ -0,0 +1,53 @@
+#ifndef SIM_CLAMP_H
+#define SIM_CLAMP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Range clamps shared by the scalar step, the fleet stages and the scalar HVAC
+ * kernel. Internal to the simulation core. A NaN passes through unchanged, which
+ * the vector kernels rely on to stay bit-identical to the scalar path.
+ */
+static inline double sim_clamp_range(double value, double min_value, double max_value)
+{
+    double result = value;
+    if (result < min_value)
+    {
+        result = min_value;
+    }
+    else if (result > max_value)
+    {
+        result = max_value;
+    }
+    else
+    {
+        /* no action */
+    }
+    return result;
+}
+
+static inline int sim_clamp_int(int value, int min_value, int max_value)
+{
+    int result = value;
+    if (result < min_value)
+    {
+        result = min_value;
+    }
+    else if (result > max_value)
+    {
+        result = max_value;
+    }
+    else
+    {
+        /* no action */
+    }
+    return result;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_CLAMP_H */
@@ -0,0 +1,254 @@
+#include "sim_command.h"
+
+#include <math.h>
+
+#define SIM_COMMAND_QUEUE_MASK ((int64_t)SIM_COMMAND_QUEUE_CAPACITY - 1)
+#define SIM_COMMAND_FAN_PERIOD 8U
+#define SIM_COMMAND_AIRFLOW_PERIOD 3U
+
+void sim_command_queue_init(SimCommandQueue *queue)
+{
+    if (queue == NULL)
+    {
+        return;
+    }
+
+    sys_atomic_init(&queue->head, 0);
+    sys_atomic_init(&queue->tail, 0);
+    queue->dropped = 0U;
+}
+
+bool sim_command_queue_push(SimCommandQueue *queue, const SimCommand *command)
+{
+    if ((queue == NULL) || (command == NULL))
+    {
+        return false;
+    }
+
+    const int64_t tail = sys_atomic_load_relaxed(&queue->tail);
+    const int64_t head = sys_atomic_load_acquire(&queue->head);
+    if ((tail - head) >= (int64_t)SIM_COMMAND_QUEUE_CAPACITY)
+    {
+        ++queue->dropped;
+        return false;
+    }
+
+    queue->slots[tail & SIM_COMMAND_QUEUE_MASK] = *command;
+    sys_atomic_store_release(&queue->tail, tail + 1);
+    return true;
+}
+
+size_t sim_command_queue_pop(SimCommandQueue *queue, SimCommand *out, size_t max)
+{
+    if ((queue == NULL) || (out == NULL))
+    {
+        return 0U;
+    }
+
+    const int64_t head = sys_atomic_load_relaxed(&queue->head);
+    const int64_t tail = sys_atomic_load_acquire(&queue->tail);
+    size_t count = (size_t)(tail - head);
+    if (count > max)
+    {
+        count = max;
+    }
+
+    for (size_t i = 0U; i < count; ++i)
+    {
+        out[i] = queue->slots[(head + (int64_t)i) & SIM_COMMAND_QUEUE_MASK];
+    }
+    sys_atomic_store_release(&queue->head, head + (int64_t)count);
+    return count;
+}
+
+static unsigned command_repeats(const SimCommand *command)
+{
+    return (command->value > 0.0) ? (unsigned)(command->value + 0.5) : 0U;
+}
+
+static unsigned command_period(SimCommandKind kind)
+{
+    switch (kind)
+    {
+        case SIM_COMMAND_THROTTLE_DELTA:
+        case SIM_COMMAND_BRAKE:
+        case SIM_COMMAND_SETPOINT_DELTA:
+            return 0U;
+        case SIM_COMMAND_CYCLE_FAN:
+            return SIM_COMMAND_FAN_PERIOD;
+        case SIM_COMMAND_CYCLE_AIRFLOW:
+            return SIM_COMMAND_AIRFLOW_PERIOD;
+        default:
+            return 2U;
+    }
+}
+
+/* Whether next can be folded into prev (same kind) with the same end state as applying both. */
+static bool command_can_merge(const SimCommand *prev, const SimCommand *next)
+{
+    switch (next->kind)
+    {
+        case SIM_COMMAND_THROTTLE_DELTA:
+            /* The clamp saturates in one direction only, so same-sign sums clamp the same. */
+            return ((prev->value >= 0.0) == (next->value >= 0.0));
+        case SIM_COMMAND_SETPOINT_DELTA:
+            /* Off-grid deltas are snapped after each step, which a sum would skip. */
+            return ((prev->value >= 0.0) == (next->value >= 0.0))
+                && ((prev->value * 2.0) == floor(prev->value * 2.0))
+                && ((next->value * 2.0) == floor(next->value * 2.0));
+        case SIM_COMMAND_TOGGLE_LEFT:
+        case SIM_COMMAND_TOGGLE_RIGHT:
+        case SIM_COMMAND_TOGGLE_HAZARD:
+        case SIM_COMMAND_TOGGLE_AUTO:
+            /* These also clear the other signal, restart the blink or raise fan 0 to 1. */
+            return false;
+        default:
+            return true;
+    }
+}
+
+size_t sim_command_coalesce(SimCommand *commands, size_t count)
+{
+    if (commands == NULL)
+    {
+        return 0U;
+    }
+
+    size_t out = 0U;
+    for (size_t i = 0U; i < count; ++i)
+    {
+        const SimCommand *command = &commands[i];
+        if ((out == 0U) || (commands[out - 1U].kind != command->kind)
+            || !command_can_merge(&commands[out - 1U], command))
+        {
+            commands[out] = *command;
+            ++out;
+            continue;
+        }
+
+        SimCommand *merged = &commands[out - 1U];
+        const unsigned period = command_period(command->kind);
+        merged->time_s = command->time_s;
+        if (command->kind == SIM_COMMAND_BRAKE)
+        {
+            merged->value = command->value;
+        }
+        else if (period == 0U)
+        {
+            merged->value += command->value;
+        }
+        else
+        {
+            /* Keeps at least one cycle so side effects (AUTO off) survive a full lap. */
+            const unsigned repeats = command_repeats(merged) + command_repeats(command);
+            if ((period == 2U) && ((repeats % 2U) == 0U))
+            {
+                --out;
+            }
+            else
+            {
+                merged->value = (double)(((repeats - 1U) % period) + 1U);
+            }
+        }
+    }
+
+    return out;
+}
+
+void sim_command_apply(SimState *state, const SimCommand *command)
+{
+    if ((state == NULL) || (command == NULL))
+    {
+        return;
+    }
+
+    const unsigned repeats = command_repeats(command);
+    const bool toggled = ((repeats % 2U) != 0U);
+    switch (command->kind)
+    {
+        case SIM_COMMAND_THROTTLE_DELTA:
+            sim_adjust_throttle(state, command->value);
+            break;
+        case SIM_COMMAND_BRAKE:
+            sim_apply_brake(state, command->value != 0.0);
+            break;
+        case SIM_COMMAND_SETPOINT_DELTA:
+            sim_adjust_setpoint(state, command->value);
+            break;
+        case SIM_COMMAND_TOGGLE_LEFT:
+            if (toggled)
+            {
+                sim_toggle_left_signal(state);
+            }
+            break;
+        case SIM_COMMAND_TOGGLE_RIGHT:
+            if (toggled)
+            {
+                sim_toggle_right_signal(state);
+            }
+            break;
+        case SIM_COMMAND_TOGGLE_HAZARD:
+            if (toggled)
+            {
+                sim_toggle_hazard(state);
+            }
+            break;
+        case SIM_COMMAND_TOGGLE_HEADLIGHT:
+            if (toggled)
+            {
+                sim_toggle_headlight(state);
+            }
+            break;
+        case SIM_COMMAND_TOGGLE_AC:
+            if (toggled)
+            {
+                sim_toggle_ac(state);
+            }
+            break;
+        case SIM_COMMAND_TOGGLE_RECIRC:
+            if (toggled)
+            {
+                sim_toggle_recirc(state);
+            }
+            break;
+        case SIM_COMMAND_TOGGLE_DEFROST:
+            if (toggled)
+            {
+                sim_toggle_defrost(state);
+            }
+            break;
+        case SIM_COMMAND_TOGGLE_AUTO:
+            if (toggled)
+            {
+                sim_toggle_auto(state);
+            }
+            break;
+        case SIM_COMMAND_CYCLE_FAN:
+            for (unsigned i = 0U; i < repeats; ++i)
+            {
+                sim_cycle_fan(state);
+            }
+            break;
+        case SIM_COMMAND_CYCLE_AIRFLOW:
+            for (unsigned i = 0U; i < repeats; ++i)
+            {
+                sim_cycle_airflow(state);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+size_t sim_command_queue_drain(SimCommandQueue *queue, SimState *state)
+{
+    SimCommand batch[SIM_COMMAND_QUEUE_CAPACITY];
+    const size_t popped = sim_command_queue_pop(queue, batch, SIM_COMMAND_QUEUE_CAPACITY);
+    const size_t count = sim_command_coalesce(batch, popped);
+    for (size_t i = 0U; i < count; ++i)
+    {
+        sim_command_apply(state, &batch[i]);
+    }
+
+    return popped;
+}
@@ -0,0 +1,81 @@
+#ifndef SIM_COMMAND_H
+#define SIM_COMMAND_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sim.h"
+#include "sys_atomic.h"
+
+#define SIM_COMMAND_QUEUE_CAPACITY 256U
+
+typedef enum
+{
+    SIM_COMMAND_THROTTLE_DELTA = 0,
+    SIM_COMMAND_BRAKE,
+    SIM_COMMAND_TOGGLE_LEFT,
+    SIM_COMMAND_TOGGLE_RIGHT,
+    SIM_COMMAND_TOGGLE_HAZARD,
+    SIM_COMMAND_TOGGLE_HEADLIGHT,
+    SIM_COMMAND_TOGGLE_AC,
+    SIM_COMMAND_TOGGLE_RECIRC,
+    SIM_COMMAND_TOGGLE_DEFROST,
+    SIM_COMMAND_TOGGLE_AUTO,
+    SIM_COMMAND_CYCLE_FAN,
+    SIM_COMMAND_CYCLE_AIRFLOW,
+    SIM_COMMAND_SETPOINT_DELTA
+} SimCommandKind;
+
+/*
+ * One user action. value is the delta for THROTTLE/SETPOINT, 1 or 0 for BRAKE and a
+ * repeat count for toggles and cycles (1 when freshly translated from a key).
+ */
+typedef struct
+{
+    SimCommandKind kind;
+    double value;
+    double time_s;
+} SimCommand;
+
+/*
+ * Bounded lock-free single-producer / single-consumer ring. head is only written by
+ * the consumer and tail only by the producer; each sits on its own cache line.
+ */
+typedef struct
+{
+    SysAtomicI64 head;
+    char head_pad[64 - sizeof(SysAtomicI64)];
+    SysAtomicI64 tail;
+    char tail_pad[64 - sizeof(SysAtomicI64)];
+    /* Producer-owned: pushes rejected because the ring was full. */
+    uint64_t dropped;
+    SimCommand slots[SIM_COMMAND_QUEUE_CAPACITY];
+} SimCommandQueue;
+
+void sim_command_queue_init(SimCommandQueue *queue);
+/* Producer side; false (and dropped++) when full. */
+bool sim_command_queue_push(SimCommandQueue *queue, const SimCommand *command);
+/* Consumer side; moves up to max queued commands into out. */
+size_t sim_command_queue_pop(SimCommandQueue *queue, SimCommand *out, size_t max);
+
+/*
+ * Collapses runs of the same kind in place without changing the end state: same-sign
+ * deltas are summed, the last brake state wins, pairs of side-effect-free toggles
+ * cancel and cycles are reduced modulo their period. Signal, hazard and AUTO toggles
+ * are kept one by one. Order across different kinds is preserved. Returns the new count.
+ */
+size_t sim_command_coalesce(SimCommand *commands, size_t count);
+void sim_command_apply(SimState *state, const SimCommand *command);
+/* Consumer side: pop, coalesce and apply everything queued; returns commands popped. */
+size_t sim_command_queue_drain(SimCommandQueue *queue, SimState *state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_COMMAND_H */
@@ -0,0 +1,310 @@
+#include "sim_fleet.h"
+
+#include "sim_clamp.h"
+#include "sim_hvac_simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_FLEET_ALIGN 64U
+/* Vehicles per tile; every stage runs over one tile before the next tile starts so
+ * the working set of a tile (~30 arrays x 256 entries) stays resident in L1/L2. */
+#define SIM_FLEET_TILE 256U
+
+static size_t fleet_align_size(size_t bytes)
+{
+    return (bytes + (SIM_FLEET_ALIGN - 1U)) & ~(size_t)(SIM_FLEET_ALIGN - 1U);
+}
+
+typedef struct
+{
+    void **slot;
+    size_t element_size;
+} FleetColumn;
+
+static size_t fleet_describe_columns(SimFleet *fleet, FleetColumn *columns)
+{
+    size_t n = 0U;
+#define FLEET_COLUMN(field) \
+    columns[n].slot = (void **)&fleet->field; \
+    columns[n].element_size = sizeof(*fleet->field); \
+    ++n
+    FLEET_COLUMN(velocity_kmh);
+    FLEET_COLUMN(throttle_pct);
+    FLEET_COLUMN(brake_pct);
+    FLEET_COLUMN(rpm);
+    FLEET_COLUMN(fuel_pct);
+    FLEET_COLUMN(runtime_s);
+    FLEET_COLUMN(left_enabled);
+    FLEET_COLUMN(right_enabled);
+    FLEET_COLUMN(hazard_enabled);
+    FLEET_COLUMN(headlight_on);
+    FLEET_COLUMN(blink_on);
+    FLEET_COLUMN(blink_elapsed);
+    FLEET_COLUMN(ac_on);
+    FLEET_COLUMN(auto_mode);
+    FLEET_COLUMN(recirculation_on);
+    FLEET_COLUMN(defrost_on);
+    FLEET_COLUMN(airflow_mode);
+    FLEET_COLUMN(fan_level);
+    FLEET_COLUMN(setpoint_c);
+    FLEET_COLUMN(cabin_temp_c);
+    FLEET_COLUMN(outside_temp_c);
+    FLEET_COLUMN(warmup_elapsed_s);
+    FLEET_COLUMN(rpm_hot_s);
+    FLEET_COLUMN(engine_warm);
+#undef FLEET_COLUMN
+    return n;
+}
+
+bool sim_fleet_create(SimFleet *fleet, size_t count)
+{
+    if (fleet == NULL)
+    {
+        return false;
+    }
+
+    memset(fleet, 0, sizeof(*fleet));
+
+    FleetColumn columns[32];
+    const size_t column_count = fleet_describe_columns(fleet, columns);
+    const size_t slots = (count > 0U) ? count : 1U;
+
+    size_t total = SIM_FLEET_ALIGN;
+    for (size_t i = 0U; i < column_count; ++i)
+    {
+        total += fleet_align_size(slots * columns[i].element_size);
+    }
+
+    unsigned char *storage = (unsigned char *)malloc(total);
+    if (storage == NULL)
+    {
+        return false;
+    }
+
+    unsigned char *cursor = storage;
+    const uintptr_t misalign = (uintptr_t)cursor & (uintptr_t)(SIM_FLEET_ALIGN - 1U);
+    if (misalign != 0U)
+    {
+        cursor += SIM_FLEET_ALIGN - misalign;
+    }
+
+    for (size_t i = 0U; i < column_count; ++i)
+    {
+        *columns[i].slot = cursor;
+        cursor += fleet_align_size(slots * columns[i].element_size);
+    }
+
+    fleet->storage = storage;
+    fleet->count = count;
+
+    /* Resolve the HVAC kernel here so worker threads only ever read it. */
+    (void)sim_hvac_kernel_active();
+
+    SimState initial;
+    sim_init(&initial);
+    for (size_t i = 0U; i < count; ++i)
+    {
+        sim_fleet_scatter(fleet, i, &initial);
+    }
+
+    return true;
+}
+
+void sim_fleet_destroy(SimFleet *fleet)
+{
+    if (fleet == NULL)
+    {
+        return;
+    }
+
+    free(fleet->storage);
+    memset(fleet, 0, sizeof(*fleet));
+}
+
+size_t sim_fleet_bytes_per_vehicle(void)
+{
+    SimFleet layout;
+    FleetColumn columns[32];
+    const size_t column_count = fleet_describe_columns(&layout, columns);
+
+    size_t bytes = 0U;
+    for (size_t i = 0U; i < column_count; ++i)
+    {
+        bytes += columns[i].element_size;
+    }
+    return bytes;
+}
+
+void sim_fleet_gather(const SimFleet *fleet, size_t index, SimState *state)
+{
+    if ((fleet == NULL) || (state == NULL) || (index >= fleet->count))
+    {
+        return;
+    }
+
+    state->velocity_kmh = fleet->velocity_kmh[index];
+    state->throttle_pct = fleet->throttle_pct[index];
+    state->brake_pct = fleet->brake_pct[index];
+    state->rpm = fleet->rpm[index];
+    state->fuel_pct = fleet->fuel_pct[index];
+    state->runtime_s = fleet->runtime_s[index];
+
+    state->indicators.left_enabled = (fleet->left_enabled[index] != 0U);
+    state->indicators.right_enabled = (fleet->right_enabled[index] != 0U);
+    state->indicators.hazard_enabled = (fleet->hazard_enabled[index] != 0U);
+    state->indicators.headlight_on = (fleet->headlight_on[index] != 0U);
+    state->indicators.blink_on = (fleet->blink_on[index] != 0U);
+    state->indicators.blink_elapsed = fleet->blink_elapsed[index];
+
+    state->hvac.ac_on = (fleet->ac_on[index] != 0U);
+    state->hvac.auto_mode = (fleet->auto_mode[index] != 0U);
+    state->hvac.recirculation_on = (fleet->recirculation_on[index] != 0U);
+    state->hvac.defrost_on = (fleet->defrost_on[index] != 0U);
+    state->hvac.airflow_mode = (HvacAirflowMode)fleet->airflow_mode[index];
+    state->hvac.fan_level = fleet->fan_level[index];
+    state->hvac.setpoint_c = fleet->setpoint_c[index];
+    state->hvac.cabin_temp_c = fleet->cabin_temp_c[index];
+    state->hvac.outside_temp_c = fleet->outside_temp_c[index];
+    state->hvac.warmup_elapsed_s = fleet->warmup_elapsed_s[index];
+    state->hvac.rpm_hot_s = fleet->rpm_hot_s[index];
+    state->hvac.engine_warm = (fleet->engine_warm[index] != 0U);
+}
+
+void sim_fleet_scatter(SimFleet *fleet, size_t index, const SimState *state)
+{
+    if ((fleet == NULL) || (state == NULL) || (index >= fleet->count))
+    {
+        return;
+    }
+
+    fleet->velocity_kmh[index] = state->velocity_kmh;
+    fleet->throttle_pct[index] = state->throttle_pct;
+    fleet->brake_pct[index] = state->brake_pct;
+    fleet->rpm[index] = state->rpm;
+    fleet->fuel_pct[index] = state->fuel_pct;
+    fleet->runtime_s[index] = state->runtime_s;
+
+    fleet->left_enabled[index] = state->indicators.left_enabled ? 1U : 0U;
+    fleet->right_enabled[index] = state->indicators.right_enabled ? 1U : 0U;
+    fleet->hazard_enabled[index] = state->indicators.hazard_enabled ? 1U : 0U;
+    fleet->headlight_on[index] = state->indicators.headlight_on ? 1U : 0U;
+    fleet->blink_on[index] = state->indicators.blink_on ? 1U : 0U;
+    fleet->blink_elapsed[index] = state->indicators.blink_elapsed;
+
+    fleet->ac_on[index] = state->hvac.ac_on ? 1U : 0U;
+    fleet->auto_mode[index] = state->hvac.auto_mode ? 1U : 0U;
+    fleet->recirculation_on[index] = state->hvac.recirculation_on ? 1U : 0U;
+    fleet->defrost_on[index] = state->hvac.defrost_on ? 1U : 0U;
+    fleet->airflow_mode[index] = (uint8_t)state->hvac.airflow_mode;
+    fleet->fan_level[index] = state->hvac.fan_level;
+    fleet->setpoint_c[index] = state->hvac.setpoint_c;
+    fleet->cabin_temp_c[index] = state->hvac.cabin_temp_c;
+    fleet->outside_temp_c[index] = state->hvac.outside_temp_c;
+    fleet->warmup_elapsed_s[index] = state->hvac.warmup_elapsed_s;
+    fleet->rpm_hot_s[index] = state->hvac.rpm_hot_s;
+    fleet->engine_warm[index] = state->hvac.engine_warm ? 1U : 0U;
+}
+
+/* Each stage below repeats the arithmetic of its sim.c counterpart in the same
+ * operation order so batch and single-vehicle stepping stay bit-identical. */
+
+static void fleet_update_indicators(SimFleet *fleet, size_t begin, size_t end, double dt)
+{
+    const double blink_interval = 1.0 / 3.0;
+    double *blink_elapsed = fleet->blink_elapsed;
+    uint8_t *blink_on = fleet->blink_on;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        double elapsed = blink_elapsed[i] + dt;
+        uint8_t on = blink_on[i];
+        while (elapsed >= blink_interval)
+        {
+            elapsed -= blink_interval;
+            on ^= 1U;
+        }
+        blink_elapsed[i] = elapsed;
+        blink_on[i] = on;
+    }
+}
+
+static void fleet_update_dynamics(SimFleet *fleet, size_t begin, size_t end, double dt)
+{
+    double *throttle = fleet->throttle_pct;
+    double *brake = fleet->brake_pct;
+    double *velocity = fleet->velocity_kmh;
+    double *rpm = fleet->rpm;
+    double *fuel = fleet->fuel_pct;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        const double throttle_pct = sim_clamp_range(throttle[i], 0.0, 100.0);
+        const double brake_pct = sim_clamp_range(brake[i], 0.0, 100.0);
+        throttle[i] = throttle_pct;
+        brake[i] = brake_pct;
+
+        const double accel_term = (0.05 * throttle_pct - 0.04 - 0.15 * brake_pct) * dt * 100.0;
+        const double velocity_kmh = sim_clamp_range(velocity[i] + accel_term, 0.0, 200.0);
+        velocity[i] = velocity_kmh;
+
+        rpm[i] = sim_clamp_range(800.0 + (velocity_kmh * 60.0), 800.0, 7000.0);
+
+        const double fuel_delta = 0.002 * throttle_pct * dt;
+        fuel[i] = sim_clamp_range(fuel[i] - fuel_delta, 0.0, 100.0);
+    }
+}
+
+static void fleet_update_engine_state(SimFleet *fleet, size_t begin, size_t end, double dt)
+{
+    double *warmup = fleet->warmup_elapsed_s;
+    double *rpm_hot = fleet->rpm_hot_s;
+    const double *rpm = fleet->rpm;
+    uint8_t *engine_warm = fleet->engine_warm;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        const double warmup_s = warmup[i] + dt;
+        const double hot_s = (rpm[i] > 1500.0) ? (rpm_hot[i] + dt) : 0.0;
+        warmup[i] = warmup_s;
+        rpm_hot[i] = hot_s;
+        engine_warm[i] |= ((warmup_s >= 60.0) || (hot_s >= 10.0)) ? 1U : 0U;
+    }
+}
+
+void sim_step_batch(SimFleet *fleet, double dt)
+{
+    if (fleet == NULL)
+    {
+        return;
+    }
+
+    sim_step_batch_range(fleet, 0U, fleet->count, dt);
+}
+
+void sim_step_batch_range(SimFleet *fleet, size_t begin, size_t end, double dt)
+{
+    if ((fleet == NULL) || (end > fleet->count))
+    {
+        return;
+    }
+
+    const double step_dt = (dt > 0.0) ? dt : 0.0;
+
+    for (size_t tile = begin; tile < end; tile += SIM_FLEET_TILE)
+    {
+        const size_t remaining = end - tile;
+        const size_t tile_end = tile + ((remaining < SIM_FLEET_TILE) ? remaining : SIM_FLEET_TILE);
+
+        double *runtime = fleet->runtime_s;
+        for (size_t i = tile; i < tile_end; ++i)
+        {
+            runtime[i] += step_dt;
+        }
+
+        fleet_update_indicators(fleet, tile, tile_end, step_dt);
+        fleet_update_dynamics(fleet, tile, tile_end, step_dt);
+        fleet_update_engine_state(fleet, tile, tile_end, step_dt);
+        sim_hvac_batch(fleet, tile, tile_end, step_dt);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef SIM_FLEET_H
+#define SIM_FLEET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+/*
+ * Structure-of-arrays mirror of SimState for stepping many vehicles at once.
+ * Every field of SimState (including the nested IndicatorState and HvacState)
+ * lives in its own contiguous, 64-byte aligned array indexed by vehicle.
+ * Booleans and the airflow enum are stored as uint8_t so the hot loops touch
+ * no padding.
+ */
+typedef struct
+{
+    size_t count;
+    void *storage;
+
+    double *velocity_kmh;
+    double *throttle_pct;
+    double *brake_pct;
+    double *rpm;
+    double *fuel_pct;
+    double *runtime_s;
+
+    uint8_t *left_enabled;
+    uint8_t *right_enabled;
+    uint8_t *hazard_enabled;
+    uint8_t *headlight_on;
+    uint8_t *blink_on;
+    double *blink_elapsed;
+
+    uint8_t *ac_on;
+    uint8_t *auto_mode;
+    uint8_t *recirculation_on;
+    uint8_t *defrost_on;
+    uint8_t *airflow_mode;
+    int *fan_level;
+    double *setpoint_c;
+    double *cabin_temp_c;
+    double *outside_temp_c;
+    double *warmup_elapsed_s;
+    double *rpm_hot_s;
+    uint8_t *engine_warm;
+} SimFleet;
+
+/* Allocates storage for count vehicles, each initialised as by sim_init(). */
+bool sim_fleet_create(SimFleet *fleet, size_t count);
+void sim_fleet_destroy(SimFleet *fleet);
+/* Bytes of column storage per vehicle, i.e. what one batch step streams. */
+size_t sim_fleet_bytes_per_vehicle(void);
+
+/* Copies vehicle index out of the fleet into a regular SimState. */
+void sim_fleet_gather(const SimFleet *fleet, size_t index, SimState *state);
+/* Copies a regular SimState into vehicle index of the fleet. */
+void sim_fleet_scatter(SimFleet *fleet, size_t index, const SimState *state);
+
+/* Advances every vehicle by dt; per vehicle the result equals sim_step(). */
+void sim_step_batch(SimFleet *fleet, double dt);
+/* Advances only vehicles [begin, end); disjoint ranges may run concurrently. */
+void sim_step_batch_range(SimFleet *fleet, size_t begin, size_t end, double dt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_FLEET_H */
@@ -0,0 +1,420 @@
+#include "sim_hvac_simd.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "sim_clamp.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIM_HVAC_HAVE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SIM_TARGET_AVX2
+#else
+#define SIM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define SIM_HVAC_HAVE_X86 0
+#endif
+
+typedef struct
+{
+    uint8_t *ac_on;
+    const uint8_t *auto_mode;
+    const uint8_t *recirc;
+    uint8_t *defrost;
+    uint8_t *airflow;
+    int *fan_level;
+    const double *setpoint;
+    double *cabin;
+    const double *outside;
+    const uint8_t *engine_warm;
+} HvacColumns;
+
+static SimHvacKernel g_hvac_kernel = SIM_HVAC_KERNEL_SCALAR;
+static bool g_hvac_kernel_resolved = false;
+
+static void hvac_columns_bind(HvacColumns *cols, SimFleet *fleet)
+{
+    cols->ac_on = fleet->ac_on;
+    cols->auto_mode = fleet->auto_mode;
+    cols->recirc = fleet->recirculation_on;
+    cols->defrost = fleet->defrost_on;
+    cols->airflow = fleet->airflow_mode;
+    cols->fan_level = fleet->fan_level;
+    cols->setpoint = fleet->setpoint_c;
+    cols->cabin = fleet->cabin_temp_c;
+    cols->outside = fleet->outside_temp_c;
+    cols->engine_warm = fleet->engine_warm;
+}
+
+/* Reference implementation: the branchy update_hvac()/apply_auto_logic() pair. */
+static void hvac_batch_scalar(const HvacColumns *c, size_t begin, size_t end, double dt)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        int fan = sim_clamp_int(c->fan_level[i], 0, 7);
+        const double delta = c->cabin[i] - c->setpoint[i];
+
+        if (c->auto_mode[i] != 0U)
+        {
+            if (delta > 0.5)
+            {
+                c->ac_on[i] = 1U;
+            }
+            else if (delta < -1.0)
+            {
+                c->ac_on[i] = 0U;
+            }
+            else
+            {
+                /* leave as-is */
+            }
+
+            const int fan_target = (int)floor((2.0 + (3.0 * fabs(delta))) + 0.5);
+            fan = sim_clamp_int(fan_target, 1, 7);
+
+            c->airflow[i] = (uint8_t)((delta >= 0.5) ? HVAC_AIRFLOW_FACE
+                : ((delta <= -0.5) ? HVAC_AIRFLOW_FOOT : HVAC_AIRFLOW_BI_LEVEL));
+            c->defrost[i] = (delta <= -2.0) ? 1U : 0U;
+        }
+        c->fan_level[i] = fan;
+
+        const double fan_ratio = (fan <= 0) ? 0.0 : ((double)fan / 7.0);
+        const double recirc_gain = (c->recirc[i] != 0U) ? 1.2 : 1.0;
+        const double leak_factor = (c->recirc[i] != 0U) ? 0.5 : 1.0;
+        const double q_cool = ((c->ac_on[i] != 0U) && (delta > 0.0))
+            ? (2.5 * fan_ratio * recirc_gain * delta) : 0.0;
+        const double heater_gain = (c->engine_warm[i] != 0U) ? 3.0 : 0.6;
+        const double q_heat = (delta < 0.0) ? (heater_gain * fan_ratio * (-delta)) : 0.0;
+        const double q_leak = 0.15 * (c->outside[i] - c->cabin[i]) * leak_factor;
+
+        c->cabin[i] = sim_clamp_range(c->cabin[i] + (dt * ((-q_cool) + q_heat + q_leak)), -20.0, 60.0);
+    }
+}
+
+#if SIM_HVAC_HAVE_X86
+
+/*
+ * Branchless formulation shared by both vector kernels:
+ *   ac      = auto ? ((delta > 0.5) | (ac & !(delta < -1.0))) : ac
+ *   fan     = auto ? trunc(min(max(2 + 3|delta| + 0.5, 1), 7.5)) : clamp(fan, 0, 7)
+ *   airflow = auto ? 1 - (delta >= 0.5) + (delta <= -0.5) : airflow
+ *   defrost = auto ? (delta <= -2.0) : defrost
+ * trunc() equals floor() here because the argument is always >= 1, and capping at
+ * 7.5 before truncating equals clamping the rounded value to 7.
+ */
+
+static __m128d sse2_select(__m128d mask, __m128d when_true, __m128d when_false)
+{
+    return _mm_or_pd(_mm_and_pd(mask, when_true), _mm_andnot_pd(mask, when_false));
+}
+
+static __m128d sse2_load_mask(const uint8_t *flags)
+{
+    return _mm_castsi128_pd(_mm_set_epi64x(-(long long)(flags[1] != 0U), -(long long)(flags[0] != 0U)));
+}
+
+static void sse2_store_mask(uint8_t *flags, __m128d mask)
+{
+    const int bits = _mm_movemask_pd(mask);
+    flags[0] = (uint8_t)(bits & 1);
+    flags[1] = (uint8_t)((bits >> 1) & 1);
+}
+
+static void hvac_sse2_block(const HvacColumns *c, size_t i, __m128d dt)
+{
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d seven = _mm_set1_pd(7.0);
+
+    const __m128d cabin = _mm_loadu_pd(&c->cabin[i]);
+    const __m128d delta = _mm_sub_pd(cabin, _mm_loadu_pd(&c->setpoint[i]));
+    const __m128d auto_m = sse2_load_mask(&c->auto_mode[i]);
+    const __m128d recirc_m = sse2_load_mask(&c->recirc[i]);
+    const __m128d warm_m = sse2_load_mask(&c->engine_warm[i]);
+
+    __m128d fan = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i *)(const void *)&c->fan_level[i]));
+    fan = _mm_min_pd(_mm_max_pd(fan, zero), seven);
+
+    const __m128d raise_ac = _mm_and_pd(auto_m, _mm_cmpgt_pd(delta, _mm_set1_pd(0.5)));
+    const __m128d drop_ac = _mm_and_pd(auto_m, _mm_cmplt_pd(delta, _mm_set1_pd(-1.0)));
+    const __m128d ac_m = _mm_or_pd(raise_ac, _mm_andnot_pd(drop_ac, sse2_load_mask(&c->ac_on[i])));
+
+    __m128d target = _mm_add_pd(_mm_add_pd(_mm_set1_pd(2.0),
+        _mm_mul_pd(_mm_set1_pd(3.0), _mm_andnot_pd(sign, delta))), _mm_set1_pd(0.5));
+    target = _mm_min_pd(_mm_max_pd(target, one), _mm_set1_pd(7.5));
+    target = _mm_cvtepi32_pd(_mm_cvttpd_epi32(target));
+    fan = sse2_select(auto_m, target, fan);
+
+    const __m128d face = _mm_and_pd(_mm_cmpge_pd(delta, _mm_set1_pd(0.5)), one);
+    const __m128d foot = _mm_and_pd(_mm_cmple_pd(delta, _mm_set1_pd(-0.5)), one);
+    const __m128d airflow_old = _mm_set_pd((double)c->airflow[i + 1U], (double)c->airflow[i]);
+    const __m128d airflow = sse2_select(auto_m, _mm_add_pd(_mm_sub_pd(one, face), foot), airflow_old);
+    const __m128d defrost_m = sse2_select(auto_m,
+        _mm_cmple_pd(delta, _mm_set1_pd(-2.0)), sse2_load_mask(&c->defrost[i]));
+
+    const __m128d fan_ratio = _mm_div_pd(fan, seven);
+    const __m128d recirc_gain = sse2_select(recirc_m, _mm_set1_pd(1.2), one);
+    const __m128d leak_factor = sse2_select(recirc_m, _mm_set1_pd(0.5), one);
+    const __m128d heater_gain = sse2_select(warm_m, _mm_set1_pd(3.0), _mm_set1_pd(0.6));
+
+    const __m128d q_cool = _mm_and_pd(_mm_and_pd(ac_m, _mm_cmpgt_pd(delta, zero)),
+        _mm_mul_pd(_mm_mul_pd(_mm_mul_pd(_mm_set1_pd(2.5), fan_ratio), recirc_gain), delta));
+    const __m128d q_heat = _mm_and_pd(_mm_cmplt_pd(delta, zero),
+        _mm_mul_pd(_mm_mul_pd(heater_gain, fan_ratio), _mm_xor_pd(delta, sign)));
+    const __m128d q_leak = _mm_mul_pd(_mm_mul_pd(_mm_set1_pd(0.15),
+        _mm_sub_pd(_mm_loadu_pd(&c->outside[i]), cabin)), leak_factor);
+
+    const __m128d rate = _mm_add_pd(_mm_add_pd(_mm_xor_pd(q_cool, sign), q_heat), q_leak);
+    __m128d next = _mm_add_pd(cabin, _mm_mul_pd(dt, rate));
+    next = _mm_min_pd(_mm_max_pd(next, _mm_set1_pd(-20.0)), _mm_set1_pd(60.0));
+    _mm_storeu_pd(&c->cabin[i], next);
+
+    _mm_storel_epi64((__m128i *)(void *)&c->fan_level[i], _mm_cvttpd_epi32(fan));
+    const __m128i airflow_i = _mm_cvttpd_epi32(airflow);
+    c->airflow[i] = (uint8_t)_mm_cvtsi128_si32(airflow_i);
+    c->airflow[i + 1U] = (uint8_t)_mm_cvtsi128_si32(_mm_srli_si128(airflow_i, 4));
+    sse2_store_mask(&c->ac_on[i], ac_m);
+    sse2_store_mask(&c->defrost[i], defrost_m);
+}
+
+static void hvac_batch_sse2(const HvacColumns *c, size_t begin, size_t end, double dt)
+{
+    const __m128d dt_v = _mm_set1_pd(dt);
+    size_t i = begin;
+    for (; (i + 4U) <= end; i += 4U)
+    {
+        hvac_sse2_block(c, i, dt_v);
+        hvac_sse2_block(c, i + 2U, dt_v);
+    }
+    for (; (i + 2U) <= end; i += 2U)
+    {
+        hvac_sse2_block(c, i, dt_v);
+    }
+    hvac_batch_scalar(c, i, end, dt);
+}
+
+/* Byte-per-lane expansion of a 4-bit movemask: lane j -> byte j set to 0/1. */
+static const uint32_t k_mask_bytes[16] = {
+    0x00000000U, 0x00000001U, 0x00000100U, 0x00000101U,
+    0x00010000U, 0x00010001U, 0x00010100U, 0x00010101U,
+    0x01000000U, 0x01000001U, 0x01000100U, 0x01000101U,
+    0x01010000U, 0x01010001U, 0x01010100U, 0x01010101U,
+};
+
+static SIM_TARGET_AVX2 __m256d avx2_select(__m256d mask, __m256d when_true, __m256d when_false)
+{
+    return _mm256_blendv_pd(when_false, when_true, mask);
+}
+
+static SIM_TARGET_AVX2 __m256d avx2_load_mask(const uint8_t *flags)
+{
+    int32_t packed;
+    memcpy(&packed, flags, sizeof(packed));
+    const __m256i wide = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(packed));
+    return _mm256_castsi256_pd(_mm256_cmpgt_epi64(wide, _mm256_setzero_si256()));
+}
+
+static SIM_TARGET_AVX2 void avx2_store_mask(uint8_t *flags, __m256d mask)
+{
+    const uint32_t packed = k_mask_bytes[_mm256_movemask_pd(mask)];
+    memcpy(flags, &packed, sizeof(packed));
+}
+
+static SIM_TARGET_AVX2 void hvac_avx2_block(const HvacColumns *c, size_t i, __m256d dt)
+{
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d seven = _mm256_set1_pd(7.0);
+
+    const __m256d cabin = _mm256_loadu_pd(&c->cabin[i]);
+    const __m256d delta = _mm256_sub_pd(cabin, _mm256_loadu_pd(&c->setpoint[i]));
+    const __m256d auto_m = avx2_load_mask(&c->auto_mode[i]);
+    const __m256d recirc_m = avx2_load_mask(&c->recirc[i]);
+    const __m256d warm_m = avx2_load_mask(&c->engine_warm[i]);
+
+    __m256d fan = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)(const void *)&c->fan_level[i]));
+    fan = _mm256_min_pd(_mm256_max_pd(fan, zero), seven);
+
+    const __m256d raise_ac = _mm256_and_pd(auto_m, _mm256_cmp_pd(delta, _mm256_set1_pd(0.5), _CMP_GT_OQ));
+    const __m256d drop_ac = _mm256_and_pd(auto_m, _mm256_cmp_pd(delta, _mm256_set1_pd(-1.0), _CMP_LT_OQ));
+    const __m256d ac_m = _mm256_or_pd(raise_ac, _mm256_andnot_pd(drop_ac, avx2_load_mask(&c->ac_on[i])));
+
+    __m256d target = _mm256_add_pd(_mm256_add_pd(_mm256_set1_pd(2.0),
+        _mm256_mul_pd(_mm256_set1_pd(3.0), _mm256_andnot_pd(sign, delta))), _mm256_set1_pd(0.5));
+    target = _mm256_min_pd(_mm256_max_pd(target, one), _mm256_set1_pd(7.5));
+    target = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(target));
+    fan = avx2_select(auto_m, target, fan);
+
+    const __m256d face = _mm256_and_pd(_mm256_cmp_pd(delta, _mm256_set1_pd(0.5), _CMP_GE_OQ), one);
+    const __m256d foot = _mm256_and_pd(_mm256_cmp_pd(delta, _mm256_set1_pd(-0.5), _CMP_LE_OQ), one);
+    int32_t airflow_packed;
+    memcpy(&airflow_packed, &c->airflow[i], sizeof(airflow_packed));
+    const __m256d airflow_old = _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(airflow_packed)));
+    const __m256d airflow = avx2_select(auto_m,
+        _mm256_add_pd(_mm256_sub_pd(one, face), foot), airflow_old);
+    const __m256d defrost_m = avx2_select(auto_m,
+        _mm256_cmp_pd(delta, _mm256_set1_pd(-2.0), _CMP_LE_OQ), avx2_load_mask(&c->defrost[i]));
+
+    const __m256d fan_ratio = _mm256_div_pd(fan, seven);
+    const __m256d recirc_gain = avx2_select(recirc_m, _mm256_set1_pd(1.2), one);
+    const __m256d leak_factor = avx2_select(recirc_m, _mm256_set1_pd(0.5), one);
+    const __m256d heater_gain = avx2_select(warm_m, _mm256_set1_pd(3.0), _mm256_set1_pd(0.6));
+
+    const __m256d q_cool = _mm256_and_pd(_mm256_and_pd(ac_m, _mm256_cmp_pd(delta, zero, _CMP_GT_OQ)),
+        _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(2.5), fan_ratio), recirc_gain), delta));
+    const __m256d q_heat = _mm256_and_pd(_mm256_cmp_pd(delta, zero, _CMP_LT_OQ),
+        _mm256_mul_pd(_mm256_mul_pd(heater_gain, fan_ratio), _mm256_xor_pd(delta, sign)));
+    const __m256d q_leak = _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(0.15),
+        _mm256_sub_pd(_mm256_loadu_pd(&c->outside[i]), cabin)), leak_factor);
+
+    const __m256d rate = _mm256_add_pd(_mm256_add_pd(_mm256_xor_pd(q_cool, sign), q_heat), q_leak);
+    __m256d next = _mm256_add_pd(cabin, _mm256_mul_pd(dt, rate));
+    next = _mm256_min_pd(_mm256_max_pd(next, _mm256_set1_pd(-20.0)), _mm256_set1_pd(60.0));
+    _mm256_storeu_pd(&c->cabin[i], next);
+
+    _mm_storeu_si128((__m128i *)(void *)&c->fan_level[i], _mm256_cvttpd_epi32(fan));
+    const __m128i airflow_i = _mm256_cvttpd_epi32(airflow);
+    const int32_t airflow_bytes = _mm_cvtsi128_si32(
+        _mm_packus_epi16(_mm_packs_epi32(airflow_i, airflow_i), _mm_setzero_si128()));
+    memcpy(&c->airflow[i], &airflow_bytes, sizeof(airflow_bytes));
+    avx2_store_mask(&c->ac_on[i], ac_m);
+    avx2_store_mask(&c->defrost[i], defrost_m);
+}
+
+static SIM_TARGET_AVX2 void hvac_batch_avx2(const HvacColumns *c, size_t begin, size_t end, double dt)
+{
+    const __m256d dt_v = _mm256_set1_pd(dt);
+    size_t i = begin;
+    for (; (i + 8U) <= end; i += 8U)
+    {
+        hvac_avx2_block(c, i, dt_v);
+        hvac_avx2_block(c, i + 4U, dt_v);
+    }
+    for (; (i + 4U) <= end; i += 4U)
+    {
+        hvac_avx2_block(c, i, dt_v);
+    }
+    hvac_batch_scalar(c, i, end, dt);
+}
+
+static bool hvac_cpu_has_avx2(void)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool os_saves_ymm = ((info[2] & (1 << 27)) != 0) && ((info[2] & (1 << 28)) != 0)
+        && ((_xgetbv(0) & 0x6U) == 0x6U);
+    if (!os_saves_ymm)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return ((info[1] & (1 << 5)) != 0);
+#else
+    __builtin_cpu_init();
+    return (__builtin_cpu_supports("avx2") != 0);
+#endif
+}
+
+#endif /* SIM_HVAC_HAVE_X86 */
+
+static bool hvac_kernel_supported(SimHvacKernel kernel)
+{
+    switch (kernel)
+    {
+        case SIM_HVAC_KERNEL_SCALAR:
+            return true;
+#if SIM_HVAC_HAVE_X86
+        case SIM_HVAC_KERNEL_SSE2:
+            return true;
+        case SIM_HVAC_KERNEL_AVX2:
+            return hvac_cpu_has_avx2();
+#endif
+        default:
+            return false;
+    }
+}
+
+SimHvacKernel sim_hvac_kernel_active(void)
+{
+    if (!g_hvac_kernel_resolved)
+    {
+        if (hvac_kernel_supported(SIM_HVAC_KERNEL_AVX2))
+        {
+            g_hvac_kernel = SIM_HVAC_KERNEL_AVX2;
+        }
+        else if (hvac_kernel_supported(SIM_HVAC_KERNEL_SSE2))
+        {
+            g_hvac_kernel = SIM_HVAC_KERNEL_SSE2;
+        }
+        else
+        {
+            g_hvac_kernel = SIM_HVAC_KERNEL_SCALAR;
+        }
+        g_hvac_kernel_resolved = true;
+    }
+    return g_hvac_kernel;
+}
+
+bool sim_hvac_kernel_select(SimHvacKernel kernel)
+{
+    if (!hvac_kernel_supported(kernel))
+    {
+        return false;
+    }
+
+    g_hvac_kernel = kernel;
+    g_hvac_kernel_resolved = true;
+    return true;
+}
+
+const char *sim_hvac_kernel_name(SimHvacKernel kernel)
+{
+    switch (kernel)
+    {
+        case SIM_HVAC_KERNEL_SSE2:
+            return "sse2";
+        case SIM_HVAC_KERNEL_AVX2:
+            return "avx2";
+        case SIM_HVAC_KERNEL_SCALAR:
+        default:
+            return "scalar";
+    }
+}
+
+void sim_hvac_batch(SimFleet *fleet, size_t begin, size_t end, double dt)
+{
+    if ((fleet == NULL) || (begin >= end) || (end > fleet->count))
+    {
+        return;
+    }
+
+    HvacColumns cols;
+    hvac_columns_bind(&cols, fleet);
+
+    switch (sim_hvac_kernel_active())
+    {
+#if SIM_HVAC_HAVE_X86
+        case SIM_HVAC_KERNEL_AVX2:
+            hvac_batch_avx2(&cols, begin, end, dt);
+            break;
+        case SIM_HVAC_KERNEL_SSE2:
+            hvac_batch_sse2(&cols, begin, end, dt);
+            break;
+#endif
+        case SIM_HVAC_KERNEL_SCALAR:
+        default:
+            hvac_batch_scalar(&cols, begin, end, dt);
+            break;
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef SIM_HVAC_SIMD_H
+#define SIM_HVAC_SIMD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "sim_fleet.h"
+
+/*
+ * Maximum per-step difference in cabin_temp_c between the vector kernels and the
+ * scalar update_hvac(). The kernels issue the same IEEE-754 double operations in
+ * the same order as sim.c, so on SSE2 targets results are bit-identical; the bound
+ * only matters when the scalar reference is built with FP contraction (FMA) or x87
+ * extended precision. The discrete outputs (ac_on, fan_level, airflow_mode,
+ * defrost_on) match exactly unless the cabin/setpoint delta lies within this
+ * tolerance of an AUTO threshold.
+ */
+#define SIM_HVAC_SIMD_TOLERANCE_C 1e-9
+
+typedef enum
+{
+    SIM_HVAC_KERNEL_SCALAR = 0,
+    SIM_HVAC_KERNEL_SSE2 = 1,
+    SIM_HVAC_KERNEL_AVX2 = 2
+} SimHvacKernel;
+
+/* Best kernel supported by this CPU; detected once on first use. */
+SimHvacKernel sim_hvac_kernel_active(void);
+/* Forces a kernel (for comparisons/benchmarks); fails if the CPU lacks it. */
+bool sim_hvac_kernel_select(SimHvacKernel kernel);
+const char *sim_hvac_kernel_name(SimHvacKernel kernel);
+
+/* Runs apply_auto_logic() + update_hvac() for vehicles [begin, end). */
+void sim_hvac_batch(SimFleet *fleet, size_t begin, size_t end, double dt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_HVAC_SIMD_H */
@@ -0,0 +1,93 @@
+#include "sim_loop.h"
+
+#include <stddef.h>
+
+#define SIM_LOOP_DEFAULT_HZ 240.0
+#define SIM_LOOP_MAX_FRAME_S 0.25
+
+void sim_loop_init(SimLoop *loop, double rate_hz, const SimState *initial)
+{
+    if (loop == NULL)
+    {
+        return;
+    }
+
+    const double hz = (rate_hz > 0.0) ? rate_hz : SIM_LOOP_DEFAULT_HZ;
+    loop->step_s = 1.0 / hz;
+    loop->max_frame_s = SIM_LOOP_MAX_FRAME_S;
+    loop->accumulator_s = 0.0;
+    loop->steps = 0U;
+    loop->dropped_s = 0.0;
+    loop->recorder = NULL;
+
+    if (initial != NULL)
+    {
+        loop->current = *initial;
+    }
+    else
+    {
+        sim_init(&loop->current);
+    }
+    loop->previous = loop->current;
+}
+
+unsigned sim_loop_advance(SimLoop *loop, double frame_dt)
+{
+    if (loop == NULL)
+    {
+        return 0U;
+    }
+
+    double dt = (frame_dt > 0.0) ? frame_dt : 0.0;
+    if (dt > loop->max_frame_s)
+    {
+        loop->dropped_s += dt - loop->max_frame_s;
+        dt = loop->max_frame_s;
+    }
+
+    loop->accumulator_s += dt;
+    unsigned taken = 0U;
+    while (loop->accumulator_s >= loop->step_s)
+    {
+        loop->previous = loop->current;
+        sim_step(&loop->current, loop->step_s);
+        sim_recorder_step(loop->recorder, loop->step_s, &loop->current);
+        loop->accumulator_s -= loop->step_s;
+        ++taken;
+    }
+
+    loop->steps += taken;
+    return taken;
+}
+
+void sim_loop_apply_command(SimLoop *loop, const SimCommand *command)
+{
+    if ((loop == NULL) || (command == NULL))
+    {
+        return;
+    }
+
+    sim_command_apply(&loop->current, command);
+    sim_recorder_command(loop->recorder, command);
+}
+
+double sim_loop_alpha(const SimLoop *loop)
+{
+    if ((loop == NULL) || (loop->step_s <= 0.0))
+    {
+        return 1.0;
+    }
+
+    const double alpha = loop->accumulator_s / loop->step_s;
+    return (alpha > 1.0) ? 1.0 : alpha;
+}
+
+void sim_loop_render_state(const SimLoop *loop, SimState *out)
+{
+    if ((loop == NULL) || (out == NULL))
+    {
+        return;
+    }
+
+    sim_interpolate(&loop->previous, &loop->current, sim_loop_alpha(loop), out);
+}
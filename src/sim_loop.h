@@ -0,0 +1,48 @@
+#ifndef SIM_LOOP_H
+#define SIM_LOOP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "sim.h"
+#include "sim_command.h"
+#include "sim_replay.h"
+
+/*
+ * Fixed-timestep driver. Real frame time is accumulated and consumed in whole
+ * sim steps of step_s, so physics never depends on timer jitter. The leftover
+ * fraction becomes the render interpolation factor between the last two states.
+ * Frames longer than max_frame_s (window drags, breakpoints) are truncated so a
+ * stall cannot snowball into ever longer catch-up frames.
+ */
+typedef struct
+{
+    double step_s;
+    double max_frame_s;
+    double accumulator_s;
+    SimState previous;
+    SimState current;
+    uint64_t steps;
+    double dropped_s;
+    /* Optional session log of every command and step; NULL when not recording. */
+    SimRecorder *recorder;
+} SimLoop;
+
+void sim_loop_init(SimLoop *loop, double rate_hz, const SimState *initial);
+/* Consumes frame_dt of real time; returns the number of sim steps taken. */
+unsigned sim_loop_advance(SimLoop *loop, double frame_dt);
+/* Applies a command to the current state (and logs it when recording). */
+void sim_loop_apply_command(SimLoop *loop, const SimCommand *command);
+/* Position of the render time between previous (0) and current (1). */
+double sim_loop_alpha(const SimLoop *loop);
+/* Interpolated snapshot for rendering. */
+void sim_loop_render_state(const SimLoop *loop, SimState *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_LOOP_H */
@@ -0,0 +1,366 @@
+#include "sim_playback.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PLAYBACK_NO_BLOCK ((size_t)-1)
+
+static bool playback_load_block(SimPlayback *playback, size_t block_index)
+{
+    if (playback->cached_block == block_index)
+    {
+        return true;
+    }
+
+    SimTelemetryBlock block;
+    if (!sim_telemetry_block_at(&playback->reader, block_index, &block))
+    {
+        return false;
+    }
+
+    /* The column buffers are overwritten below, so nothing is cached until they all decode. */
+    playback->cached_block = PLAYBACK_NO_BLOCK;
+    bool ok = true;
+    for (unsigned c = 0U; c < SIM_TELEMETRY_DOUBLE_COUNT; ++c)
+    {
+        ok = sim_telemetry_decode_double(&block, (SimTelemetryDouble)c, playback->doubles[c]) && ok;
+    }
+    for (unsigned c = 0U; c < SIM_TELEMETRY_SMALL_COUNT; ++c)
+    {
+        ok = sim_telemetry_decode_small(&block, (SimTelemetrySmall)c, playback->smalls[c]) && ok;
+    }
+    if (!ok)
+    {
+        return false;
+    }
+    playback->cached_block = block_index;
+    playback->cached_rows = block.rows;
+    playback->cached_first_row = block.first_row;
+    ++playback->blocks_decoded;
+    return true;
+}
+
+static void playback_row_state(const SimPlayback *playback, uint32_t row, SimState *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->velocity_kmh = playback->doubles[SIM_TELEMETRY_VELOCITY_KMH][row];
+    out->throttle_pct = playback->doubles[SIM_TELEMETRY_THROTTLE_PCT][row];
+    out->brake_pct = playback->doubles[SIM_TELEMETRY_BRAKE_PCT][row];
+    out->rpm = playback->doubles[SIM_TELEMETRY_RPM][row];
+    out->fuel_pct = playback->doubles[SIM_TELEMETRY_FUEL_PCT][row];
+    out->runtime_s = playback->doubles[SIM_TELEMETRY_RUNTIME_S][row];
+    out->hvac.cabin_temp_c = playback->doubles[SIM_TELEMETRY_CABIN_TEMP_C][row];
+    out->hvac.setpoint_c = playback->doubles[SIM_TELEMETRY_SETPOINT_C][row];
+    out->hvac.outside_temp_c = playback->doubles[SIM_TELEMETRY_OUTSIDE_TEMP_C][row];
+
+    out->indicators.left_enabled = (playback->smalls[SIM_TELEMETRY_LEFT_ENABLED][row] != 0U);
+    out->indicators.right_enabled = (playback->smalls[SIM_TELEMETRY_RIGHT_ENABLED][row] != 0U);
+    out->indicators.hazard_enabled = (playback->smalls[SIM_TELEMETRY_HAZARD_ENABLED][row] != 0U);
+    out->indicators.headlight_on = (playback->smalls[SIM_TELEMETRY_HEADLIGHT_ON][row] != 0U);
+    out->indicators.blink_on = (playback->smalls[SIM_TELEMETRY_BLINK_ON][row] != 0U);
+    out->hvac.ac_on = (playback->smalls[SIM_TELEMETRY_AC_ON][row] != 0U);
+    out->hvac.auto_mode = (playback->smalls[SIM_TELEMETRY_AUTO_MODE][row] != 0U);
+    out->hvac.recirculation_on = (playback->smalls[SIM_TELEMETRY_RECIRCULATION_ON][row] != 0U);
+    out->hvac.defrost_on = (playback->smalls[SIM_TELEMETRY_DEFROST_ON][row] != 0U);
+    out->hvac.engine_warm = (playback->smalls[SIM_TELEMETRY_ENGINE_WARM][row] != 0U);
+    out->hvac.airflow_mode = (HvacAirflowMode)playback->smalls[SIM_TELEMETRY_AIRFLOW_MODE][row];
+    out->hvac.fan_level = (int)playback->smalls[SIM_TELEMETRY_FAN_LEVEL][row];
+}
+
+/* Samples of the vehicle in the cached block, the first at row *first. */
+static uint32_t playback_vehicle_samples(const SimPlayback *playback, uint32_t *first)
+{
+    const uint32_t rows_per_tick = playback->reader.rows_per_tick;
+    const uint32_t phase = (uint32_t)(playback->cached_first_row % rows_per_tick);
+    *first = (playback->vehicle + rows_per_tick - phase) % rows_per_tick;
+    if (*first >= playback->cached_rows)
+    {
+        return 0U;
+    }
+    return ((playback->cached_rows - *first - 1U) / rows_per_tick) + 1U;
+}
+
+/*
+ * The vehicle's last sample in a block before block_index, or with forward its
+ * first sample in a block after it. *found is false when there is none; false
+ * only when a block on the way does not decode.
+ */
+static bool playback_neighbor_sample(SimPlayback *playback, size_t block_index, bool forward, SimState *out,
+    bool *found)
+{
+    const size_t blocks = sim_telemetry_block_count(&playback->reader);
+    size_t index = block_index;
+    *found = false;
+    while (forward ? ((index + 1U) < blocks) : (index > 0U))
+    {
+        index = forward ? (index + 1U) : (index - 1U);
+        if (!playback_load_block(playback, index))
+        {
+            return false;
+        }
+
+        uint32_t first = 0U;
+        const uint32_t samples = playback_vehicle_samples(playback, &first);
+        if (samples > 0U)
+        {
+            const uint32_t sample = forward ? 0U : (samples - 1U);
+            playback_row_state(playback, first + (sample * playback->reader.rows_per_tick), out);
+            *found = true;
+            return true;
+        }
+    }
+    return true;
+}
+
+/* a and b are the samples at or before and after t_s. */
+static void playback_interpolate(const SimState *a, const SimState *b, double t_s, SimState *out)
+{
+    const double span = b->runtime_s - a->runtime_s;
+    const double alpha = (span > 0.0) ? ((t_s - a->runtime_s) / span) : 0.0;
+    sim_interpolate(a, b, alpha, out);
+}
+
+bool sim_playback_open(SimPlayback *playback, const char *path, uint32_t vehicle)
+{
+    if ((playback == NULL) || (path == NULL))
+    {
+        return false;
+    }
+
+    memset(playback, 0, sizeof(*playback));
+    if (!sim_telemetry_reader_open(&playback->reader, path))
+    {
+        return false;
+    }
+
+    const size_t blocks = sim_telemetry_block_count(&playback->reader);
+    const size_t double_bytes = (size_t)SIM_TELEMETRY_DOUBLE_COUNT * SIM_TELEMETRY_BLOCK_ROWS * sizeof(double);
+    const size_t small_bytes = (size_t)SIM_TELEMETRY_SMALL_COUNT * SIM_TELEMETRY_BLOCK_ROWS;
+    if ((blocks == 0U) || (vehicle >= playback->reader.rows_per_tick))
+    {
+        sim_telemetry_reader_close(&playback->reader);
+        return false;
+    }
+    playback->storage = malloc(double_bytes + small_bytes);
+    if (playback->storage == NULL)
+    {
+        sim_telemetry_reader_close(&playback->reader);
+        return false;
+    }
+
+    uint8_t *cursor = (uint8_t *)playback->storage;
+    for (unsigned c = 0U; c < SIM_TELEMETRY_DOUBLE_COUNT; ++c)
+    {
+        playback->doubles[c] = (double *)cursor;
+        cursor += SIM_TELEMETRY_BLOCK_ROWS * sizeof(double);
+    }
+    for (unsigned c = 0U; c < SIM_TELEMETRY_SMALL_COUNT; ++c)
+    {
+        playback->smalls[c] = cursor;
+        cursor += SIM_TELEMETRY_BLOCK_ROWS;
+    }
+
+    playback->vehicle = vehicle;
+    playback->cached_block = PLAYBACK_NO_BLOCK;
+    playback->resolved_s = -1.0;
+    sim_telemetry_block_time(&playback->reader, 0U, &playback->start_s, NULL);
+    sim_telemetry_block_time(&playback->reader, blocks - 1U, NULL, &playback->end_s);
+    playback->position_s = playback->start_s;
+    playback->speed = 1.0;
+    playback->paused = false;
+    return true;
+}
+
+void sim_playback_close(SimPlayback *playback)
+{
+    if (playback == NULL)
+    {
+        return;
+    }
+
+    free(playback->storage);
+    playback->storage = NULL;
+    sim_telemetry_reader_close(&playback->reader);
+}
+
+void sim_playback_seek(SimPlayback *playback, double t_s)
+{
+    if (playback == NULL)
+    {
+        return;
+    }
+
+    if (t_s < playback->start_s)
+    {
+        t_s = playback->start_s;
+    }
+    else if (t_s > playback->end_s)
+    {
+        t_s = playback->end_s;
+    }
+    else
+    {
+        /* no action */
+    }
+    playback->position_s = t_s;
+}
+
+void sim_playback_set_speed(SimPlayback *playback, double speed)
+{
+    if (playback == NULL)
+    {
+        return;
+    }
+
+    if (speed < SIM_PLAYBACK_MIN_SPEED)
+    {
+        speed = SIM_PLAYBACK_MIN_SPEED;
+    }
+    else if (speed > SIM_PLAYBACK_MAX_SPEED)
+    {
+        speed = SIM_PLAYBACK_MAX_SPEED;
+    }
+    else
+    {
+        /* no action */
+    }
+    playback->speed = speed;
+}
+
+void sim_playback_advance(SimPlayback *playback, double wall_dt)
+{
+    if ((playback == NULL) || playback->paused || (wall_dt <= 0.0))
+    {
+        return;
+    }
+
+    sim_playback_seek(playback, playback->position_s + (wall_dt * playback->speed));
+    if (playback->position_s >= playback->end_s)
+    {
+        playback->paused = true;
+    }
+}
+
+bool sim_playback_state(SimPlayback *playback, SimState *out)
+{
+    if ((playback == NULL) || (out == NULL))
+    {
+        return false;
+    }
+
+    /* Between two samples in different blocks: reuse them rather than decoding both blocks again. */
+    if (playback->edge_valid && (playback->edge_a.runtime_s <= playback->position_s)
+        && (playback->position_s <= playback->edge_b.runtime_s))
+    {
+        playback_interpolate(&playback->edge_a, &playback->edge_b, playback->position_s, out);
+        return true;
+    }
+
+    /* With more vehicles than rows per block a tick spans blocks; step forward to this vehicle's row. */
+    const uint32_t rows_per_tick = playback->reader.rows_per_tick;
+    const size_t blocks = sim_telemetry_block_count(&playback->reader);
+    size_t block_index = (playback->position_s == playback->resolved_s)
+        ? playback->resolved_block
+        : sim_telemetry_find_time(&playback->reader, playback->position_s);
+    uint32_t first = 0U;
+    uint32_t samples = 0U;
+    for (; block_index < blocks; ++block_index)
+    {
+        if (!playback_load_block(playback, block_index))
+        {
+            return false;
+        }
+
+        samples = playback_vehicle_samples(playback, &first);
+        if (samples == 0U)
+        {
+            continue;
+        }
+
+        const double last_s = playback->doubles[SIM_TELEMETRY_RUNTIME_S][first + ((samples - 1U) * rows_per_tick)];
+        double next_min_s = playback->end_s;
+        if ((block_index + 1U) < blocks)
+        {
+            sim_telemetry_block_time(&playback->reader, block_index + 1U, &next_min_s, NULL);
+        }
+        if ((last_s >= playback->position_s) || ((block_index + 1U) >= blocks) || (next_min_s > playback->position_s))
+        {
+            break;
+        }
+    }
+    if (block_index >= blocks)
+    {
+        /* The trailing blocks hold no sample of this vehicle: show its last one. */
+        bool found = false;
+        return playback_neighbor_sample(playback, blocks, false, out, &found) && found;
+    }
+    playback->resolved_s = playback->position_s;
+    playback->resolved_block = block_index;
+
+    /* Last sample at or before the playhead; runtime_s is monotonic per vehicle. */
+    const double *runtime = playback->doubles[SIM_TELEMETRY_RUNTIME_S];
+    uint32_t low = 0U;
+    uint32_t high = samples - 1U;
+    while (low < high)
+    {
+        const uint32_t mid = low + ((high - low + 1U) / 2U);
+        if (runtime[first + (mid * rows_per_tick)] <= playback->position_s)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid - 1U;
+        }
+    }
+
+    /*
+     * The surrounding pair can straddle a block boundary: the search lands on the
+     * first sample of the block after the playhead, or the playhead lies past the
+     * last sample of its block. Take the other sample from the neighbouring block.
+     */
+    const uint32_t row_a = first + (low * rows_per_tick);
+    SimState a;
+    SimState b;
+    bool across = false;
+    bool found = true;
+    bool ok = true;
+    if (runtime[row_a] > playback->position_s)
+    {
+        playback_row_state(playback, row_a, &b);
+        ok = playback_neighbor_sample(playback, block_index, false, &a, &found);
+        across = true;
+        if (!found)
+        {
+            a = b;
+        }
+    }
+    else if ((low + 1U) >= samples)
+    {
+        playback_row_state(playback, row_a, &a);
+        ok = playback_neighbor_sample(playback, block_index, true, &b, &found);
+        across = true;
+        if (!found)
+        {
+            b = a;
+        }
+    }
+    else
+    {
+        playback_row_state(playback, row_a, &a);
+        playback_row_state(playback, row_a + rows_per_tick, &b);
+    }
+    if (!ok)
+    {
+        return false;
+    }
+
+    if (across && found)
+    {
+        playback->edge_a = a;
+        playback->edge_b = b;
+        playback->edge_valid = true;
+    }
+    playback_interpolate(&a, &b, playback->position_s, out);
+    return true;
+}
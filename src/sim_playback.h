@@ -0,0 +1,66 @@
+#ifndef SIM_PLAYBACK_H
+#define SIM_PLAYBACK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sim.h"
+#include "sim_telemetry.h"
+
+#define SIM_PLAYBACK_MIN_SPEED 0.1
+#define SIM_PLAYBACK_MAX_SPEED 1000.0
+
+/*
+ * Scrubbable view of one vehicle in a telemetry trace. The file is memory-mapped,
+ * seeks binary-search the block time index, and only the block under the playhead
+ * is decoded (once, then cached), so position changes cost O(log blocks) plus a
+ * single block decode regardless of trace length. A playhead between the last
+ * sample of one block and the first of the next also decodes the neighbour.
+ */
+typedef struct
+{
+    SimTelemetryReader reader;
+    uint32_t vehicle;
+    double start_s;
+    double end_s;
+    double position_s;
+    double speed;
+    bool paused;
+
+    void *storage;
+    double *doubles[SIM_TELEMETRY_DOUBLE_COUNT];
+    uint8_t *smalls[SIM_TELEMETRY_SMALL_COUNT];
+    size_t cached_block;
+    uint32_t cached_rows;
+    uint64_t cached_first_row;
+    uint64_t blocks_decoded;
+    /* Last playhead resolved to a block, so a paused frame skips the search. */
+    double resolved_s;
+    size_t resolved_block;
+    /* The vehicle's samples either side of the last block boundary the playhead crossed. */
+    SimState edge_a;
+    SimState edge_b;
+    bool edge_valid;
+} SimPlayback;
+
+bool sim_playback_open(SimPlayback *playback, const char *path, uint32_t vehicle);
+void sim_playback_close(SimPlayback *playback);
+/* Moves the playhead to t_s (clamped to the trace). */
+void sim_playback_seek(SimPlayback *playback, double t_s);
+/* Clamps to SIM_PLAYBACK_MIN_SPEED .. SIM_PLAYBACK_MAX_SPEED. */
+void sim_playback_set_speed(SimPlayback *playback, double speed);
+/* Moves the playhead by wall_dt * speed unless paused; stops at the end. */
+void sim_playback_advance(SimPlayback *playback, double wall_dt);
+/* Recorded state at the playhead, interpolated between the surrounding samples. */
+bool sim_playback_state(SimPlayback *playback, SimState *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_PLAYBACK_H */
@@ -0,0 +1,205 @@
+#include "sim_replay.h"
+
+#include <string.h>
+
+#define REPLAY_OFFSET_VERSION 8U
+#define REPLAY_OFFSET_RECORD_BYTES 12U
+#define REPLAY_OFFSET_COUNT 16U
+#define REPLAY_OFFSET_HASH 24U
+#define REPLAY_OFFSET_SNAPSHOT 32U
+
+static void recorder_write(SimRecorder *recorder, const uint8_t *bytes, size_t size)
+{
+    if (!recorder->failed && (fwrite(bytes, 1U, size, recorder->file) != size))
+    {
+        recorder->failed = true;
+    }
+}
+
+static void recorder_write_record(SimRecorder *recorder, SimReplayRecordType type, unsigned kind,
+    double value, uint64_t tail)
+{
+    uint8_t record[SIM_REPLAY_RECORD_BYTES];
+    memset(record, 0, sizeof(record));
+    record[0] = (uint8_t)type;
+    record[1] = (uint8_t)kind;
+    sim_put_f64(record + 8, value);
+    sim_put_u64(record + 16, tail);
+    recorder_write(recorder, record, sizeof(record));
+    ++recorder->records;
+}
+
+static void replay_write_header(uint8_t header[SIM_REPLAY_HEADER_BYTES], const SimState *initial,
+    uint64_t records, uint64_t hash)
+{
+    memset(header, 0, SIM_REPLAY_HEADER_BYTES);
+    sim_put_u64(header, SIM_REPLAY_MAGIC);
+    sim_put_u32(header + REPLAY_OFFSET_VERSION, SIM_REPLAY_VERSION);
+    sim_put_u32(header + REPLAY_OFFSET_RECORD_BYTES, SIM_REPLAY_RECORD_BYTES);
+    sim_put_u64(header + REPLAY_OFFSET_COUNT, records);
+    sim_put_u64(header + REPLAY_OFFSET_HASH, hash);
+    sim_snapshot_write(initial, header + REPLAY_OFFSET_SNAPSHOT);
+}
+
+bool sim_recorder_open(SimRecorder *recorder, const char *path, const SimState *initial)
+{
+    if ((recorder == NULL) || (path == NULL) || (initial == NULL))
+    {
+        return false;
+    }
+
+    recorder->records = 0U;
+    recorder->hash = sim_snapshot_hash(initial, 0U);
+    recorder->failed = false;
+    recorder->file = fopen(path, "wb");
+    if (recorder->file == NULL)
+    {
+        return false;
+    }
+
+    /* Count and hash stay zero until close; the replayer derives the count from the file size. */
+    uint8_t header[SIM_REPLAY_HEADER_BYTES];
+    replay_write_header(header, initial, 0U, 0U);
+    recorder_write(recorder, header, sizeof(header));
+    return !recorder->failed;
+}
+
+void sim_recorder_command(SimRecorder *recorder, const SimCommand *command)
+{
+    if ((recorder == NULL) || (recorder->file == NULL) || (command == NULL))
+    {
+        return;
+    }
+
+    uint64_t time_bits;
+    memcpy(&time_bits, &command->time_s, sizeof(time_bits));
+    recorder_write_record(recorder, SIM_REPLAY_RECORD_COMMAND, (unsigned)command->kind, command->value, time_bits);
+}
+
+void sim_recorder_step(SimRecorder *recorder, double dt, const SimState *after)
+{
+    if ((recorder == NULL) || (recorder->file == NULL) || (after == NULL))
+    {
+        return;
+    }
+
+    recorder->hash = sim_snapshot_hash(after, recorder->hash);
+    recorder_write_record(recorder, SIM_REPLAY_RECORD_STEP, 0U, dt, recorder->hash);
+}
+
+bool sim_recorder_close(SimRecorder *recorder)
+{
+    if ((recorder == NULL) || (recorder->file == NULL))
+    {
+        return false;
+    }
+
+    uint8_t fields[16];
+    sim_put_u64(fields, recorder->records);
+    sim_put_u64(fields + 8, recorder->hash);
+    if (fseek(recorder->file, (long)REPLAY_OFFSET_COUNT, SEEK_SET) == 0)
+    {
+        recorder_write(recorder, fields, sizeof(fields));
+    }
+    else
+    {
+        recorder->failed = true;
+    }
+
+    if (fclose(recorder->file) != 0)
+    {
+        recorder->failed = true;
+    }
+    recorder->file = NULL;
+    return !recorder->failed;
+}
+
+bool sim_replay_open(SimReplay *replay, const char *path)
+{
+    if ((replay == NULL) || (path == NULL))
+    {
+        return false;
+    }
+
+    memset(replay, 0, sizeof(*replay));
+    if (!sys_file_map(&replay->map, path))
+    {
+        return false;
+    }
+
+    const uint8_t *header = replay->map.data;
+    const bool valid = (replay->map.size >= SIM_REPLAY_HEADER_BYTES)
+        && (sim_get_u64(header) == SIM_REPLAY_MAGIC)
+        && (sim_get_u32(header + REPLAY_OFFSET_VERSION) == SIM_REPLAY_VERSION)
+        && (sim_get_u32(header + REPLAY_OFFSET_RECORD_BYTES) == SIM_REPLAY_RECORD_BYTES)
+        && sim_snapshot_read(header + REPLAY_OFFSET_SNAPSHOT, SIM_SNAPSHOT_BYTES, &replay->initial);
+    if (!valid)
+    {
+        sys_file_unmap(&replay->map);
+        return false;
+    }
+
+    /* A session that crashed before close still replays up to its last whole record. */
+    replay->record_count = (uint64_t)((replay->map.size - SIM_REPLAY_HEADER_BYTES) / SIM_REPLAY_RECORD_BYTES);
+    replay->recorded_hash = sim_get_u64(header + REPLAY_OFFSET_HASH);
+    sys_file_advise_sequential(&replay->map);
+    return true;
+}
+
+void sim_replay_close(SimReplay *replay)
+{
+    if (replay == NULL)
+    {
+        return;
+    }
+
+    sys_file_unmap(&replay->map);
+}
+
+bool sim_replay_run(const SimReplay *replay, SimState *state, SimReplayResult *result)
+{
+    if ((replay == NULL) || (state == NULL) || (result == NULL) || (replay->map.data == NULL))
+    {
+        return false;
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->first_mismatch = UINT64_MAX;
+    *state = replay->initial;
+
+    uint64_t hash = sim_snapshot_hash(state, 0U);
+    const uint8_t *record = replay->map.data + SIM_REPLAY_HEADER_BYTES;
+    for (uint64_t i = 0U; i < replay->record_count; ++i, record += SIM_REPLAY_RECORD_BYTES)
+    {
+        const double value = sim_get_f64(record + 8);
+        if (record[0] == (uint8_t)SIM_REPLAY_RECORD_STEP)
+        {
+            sim_step(state, value);
+            hash = sim_snapshot_hash(state, hash);
+            ++result->steps;
+            result->sim_seconds += value;
+            if (hash != sim_get_u64(record + 16))
+            {
+                result->first_mismatch = i;
+                break;
+            }
+        }
+        else if (record[0] == (uint8_t)SIM_REPLAY_RECORD_COMMAND)
+        {
+            SimCommand command;
+            command.kind = (SimCommandKind)record[1];
+            command.value = value;
+            command.time_s = sim_get_f64(record + 16);
+            sim_command_apply(state, &command);
+            ++result->commands;
+        }
+        else
+        {
+            result->first_mismatch = i;
+            break;
+        }
+    }
+
+    result->final_hash = hash;
+    return (result->first_mismatch == UINT64_MAX);
+}
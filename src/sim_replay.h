@@ -0,0 +1,77 @@
+#ifndef SIM_REPLAY_H
+#define SIM_REPLAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sim.h"
+#include "sim_command.h"
+#include "sim_snapshot.h"
+#include "sys_file.h"
+
+/*
+ * Session log: a 256-byte header holding the initial SimState snapshot, followed by
+ * fixed 24-byte records. A STEP record carries the dt given to sim_step() and the
+ * rolling state hash after it; a COMMAND record carries an input command applied
+ * between steps. Fixed-size records let the replayer walk a memory-mapped file
+ * without parsing or buffering, whatever its size.
+ */
+#define SIM_REPLAY_MAGIC 0x594C5045524D4953ULL /* "SIMREPLY" */
+#define SIM_REPLAY_VERSION 1U
+#define SIM_REPLAY_HEADER_BYTES 256U
+#define SIM_REPLAY_RECORD_BYTES 24U
+
+typedef enum
+{
+    SIM_REPLAY_RECORD_STEP = 1,
+    SIM_REPLAY_RECORD_COMMAND = 2
+} SimReplayRecordType;
+
+typedef struct
+{
+    FILE *file;
+    uint64_t records;
+    uint64_t hash;
+    bool failed;
+} SimRecorder;
+
+bool sim_recorder_open(SimRecorder *recorder, const char *path, const SimState *initial);
+void sim_recorder_command(SimRecorder *recorder, const SimCommand *command);
+/* Call after sim_step(state, dt) with the resulting state. */
+void sim_recorder_step(SimRecorder *recorder, double dt, const SimState *after);
+/* Patches record count and final hash into the header; false if any write failed. */
+bool sim_recorder_close(SimRecorder *recorder);
+
+typedef struct
+{
+    SysFileMap map;
+    SimState initial;
+    uint64_t record_count;
+    uint64_t recorded_hash;
+} SimReplay;
+
+typedef struct
+{
+    uint64_t steps;
+    uint64_t commands;
+    double sim_seconds;
+    uint64_t final_hash;
+    /* Record index of the first hash mismatch, or UINT64_MAX when none. */
+    uint64_t first_mismatch;
+} SimReplayResult;
+
+bool sim_replay_open(SimReplay *replay, const char *path);
+void sim_replay_close(SimReplay *replay);
+/* Re-executes the log from its initial state; true when every hash matched. */
+bool sim_replay_run(const SimReplay *replay, SimState *state, SimReplayResult *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_REPLAY_H */
@@ -0,0 +1,183 @@
+#include "sim_runner.h"
+
+#include "sys_trace.h"
+
+/* Returns true when anything was popped, even if coalescing cancelled it out. */
+static bool sim_runner_drain_commands(SimRunner *runner)
+{
+    SimCommand batch[SIM_COMMAND_QUEUE_CAPACITY];
+    const size_t popped = sim_command_queue_pop(&runner->commands, batch, SIM_COMMAND_QUEUE_CAPACITY);
+    for (size_t i = 0U; i < popped; ++i)
+    {
+        if (batch[i].time_s > runner->input_time_s)
+        {
+            runner->input_time_s = batch[i].time_s;
+        }
+    }
+    const size_t count = sim_command_coalesce(batch, popped);
+    for (size_t i = 0U; i < count; ++i)
+    {
+        sim_loop_apply_command(&runner->loop, &batch[i]);
+    }
+    return popped > 0U;
+}
+
+static void sim_runner_publish(SimRunner *runner, double now_s)
+{
+    SimFrame *frame = sim_triple_write_slot(&runner->frames);
+    frame->previous = runner->loop.previous;
+    frame->current = runner->loop.current;
+    frame->step_s = runner->loop.step_s;
+    frame->current_time_s = now_s - runner->loop.accumulator_s;
+    frame->input_time_s = runner->input_time_s;
+    frame->sequence = runner->loop.steps;
+    sim_triple_publish(&runner->frames);
+}
+
+/* Sleeps until the next step is due, or in low-latency mode until a command is posted. */
+static void sim_runner_sleep(SimRunner *runner, double seconds)
+{
+    if (!runner->low_latency)
+    {
+        sys_sleep_seconds(seconds);
+        return;
+    }
+
+    sys_mutex_lock(&runner->wake_lock);
+    if (!runner->wake_pending && (seconds > 0.0))
+    {
+        (void)sys_cond_wait_seconds(&runner->wake, &runner->wake_lock, seconds);
+    }
+    runner->wake_pending = false;
+    sys_mutex_unlock(&runner->wake_lock);
+}
+
+static void sim_runner_wake(SimRunner *runner)
+{
+    sys_mutex_lock(&runner->wake_lock);
+    runner->wake_pending = true;
+    sys_cond_broadcast(&runner->wake);
+    sys_mutex_unlock(&runner->wake_lock);
+}
+
+static void sim_runner_main(void *arg)
+{
+    SimRunner *runner = (SimRunner *)arg;
+    double last_s = sys_time_seconds();
+
+    SYS_TRACE_THREAD("sim");
+    while (sys_atomic_load_acquire(&runner->running) != 0)
+    {
+        SYS_TRACE_BEGIN(sim_runner_tick);
+        const bool applied = sim_runner_drain_commands(runner) && runner->low_latency;
+
+        const double now_s = sys_time_seconds();
+        const unsigned steps = sim_loop_advance(&runner->loop, now_s - last_s);
+        last_s = now_s;
+        if ((steps > 0U) || applied)
+        {
+            sim_runner_publish(runner, now_s);
+        }
+        if (applied && (runner->notify != NULL))
+        {
+            runner->notify(runner->notify_context);
+        }
+        SYS_TRACE_END(sim_runner_tick);
+
+        sim_runner_sleep(runner, runner->loop.step_s - runner->loop.accumulator_s);
+    }
+}
+
+void sim_runner_set_low_latency(SimRunner *runner, SimRunnerNotifyFn notify, void *context)
+{
+    if (runner == NULL)
+    {
+        return;
+    }
+
+    runner->low_latency = true;
+    runner->notify = notify;
+    runner->notify_context = context;
+}
+
+bool sim_runner_start(SimRunner *runner, double rate_hz, const SimState *initial, SimRecorder *recorder)
+{
+    if (runner == NULL)
+    {
+        return false;
+    }
+
+    sim_loop_init(&runner->loop, rate_hz, initial);
+    runner->loop.recorder = recorder;
+    sim_command_queue_init(&runner->commands);
+    runner->input_time_s = 0.0;
+    if (runner->low_latency)
+    {
+        sys_mutex_init(&runner->wake_lock);
+        sys_cond_init(&runner->wake);
+        runner->wake_pending = false;
+    }
+
+    SimFrame first;
+    first.previous = runner->loop.current;
+    first.current = runner->loop.current;
+    first.step_s = runner->loop.step_s;
+    first.current_time_s = sys_time_seconds();
+    first.input_time_s = 0.0;
+    first.sequence = 0U;
+    sim_triple_init(&runner->frames, &first);
+
+    sys_atomic_init(&runner->running, 1);
+    return sys_thread_start(&runner->thread, sim_runner_main, runner);
+}
+
+void sim_runner_stop(SimRunner *runner)
+{
+    if ((runner == NULL) || !runner->thread.started)
+    {
+        return;
+    }
+
+    sys_atomic_store_release(&runner->running, 0);
+    if (runner->low_latency)
+    {
+        sim_runner_wake(runner);
+    }
+    sys_thread_join(&runner->thread);
+    if (runner->low_latency)
+    {
+        sys_cond_destroy(&runner->wake);
+        sys_mutex_destroy(&runner->wake_lock);
+    }
+}
+
+bool sim_runner_post_command(SimRunner *runner, const SimCommand *command)
+{
+    if (runner == NULL)
+    {
+        return false;
+    }
+
+    const bool queued = sim_command_queue_push(&runner->commands, command);
+    if (queued && runner->low_latency)
+    {
+        sim_runner_wake(runner);
+    }
+    return queued;
+}
+
+void sim_runner_render_state(SimRunner *runner, double now_s, SimState *out, double *input_time_s)
+{
+    if ((runner == NULL) || (out == NULL))
+    {
+        return;
+    }
+
+    const SimFrame *frame = sim_triple_acquire(&runner->frames, NULL);
+    const double alpha = (frame->step_s > 0.0) ? ((now_s - frame->current_time_s) / frame->step_s) : 1.0;
+    sim_interpolate(&frame->previous, &frame->current, alpha, out);
+    if (input_time_s != NULL)
+    {
+        *input_time_s = frame->input_time_s;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef SIM_RUNNER_H
+#define SIM_RUNNER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sim.h"
+#include "sim_command.h"
+#include "sim_loop.h"
+#include "sim_triple.h"
+#include "sys_atomic.h"
+#include "sys_thread.h"
+
+/*
+ * Runs a SimLoop on its own thread. Every batch of fixed steps is published through
+ * a triple buffer, so the renderer reads the newest frame without ever waiting on
+ * the simulation and a slow paint never stalls physics. Commands arrive through a
+ * lock-free SPSC queue and are coalesced and applied once per sim iteration.
+ *
+ * In low-latency mode a posted command wakes the sim thread instead of waiting out
+ * its sleep; the command is applied and published at once, and notify runs on the
+ * sim thread so the UI can repaint without waiting for its timer.
+ */
+typedef void (*SimRunnerNotifyFn)(void *context);
+
+typedef struct
+{
+    SimLoop loop;
+    SimTripleBuffer frames;
+    SysThread thread;
+    SysAtomicI64 running;
+    SimCommandQueue commands;
+    double input_time_s;        /* sim thread: newest command time_s applied so far */
+    bool low_latency;
+    SimRunnerNotifyFn notify;   /* low-latency mode: after a frame with new commands is published */
+    void *notify_context;
+    SysMutex wake_lock;
+    SysCond wake;
+    bool wake_pending;          /* guarded by wake_lock */
+} SimRunner;
+
+/* Before sim_runner_start(): switch to low-latency mode; notify may be NULL. */
+void sim_runner_set_low_latency(SimRunner *runner, SimRunnerNotifyFn notify, void *context);
+
+/* recorder (optional) is written from the sim thread until sim_runner_stop(). */
+bool sim_runner_start(SimRunner *runner, double rate_hz, const SimState *initial, SimRecorder *recorder);
+void sim_runner_stop(SimRunner *runner);
+/* UI thread (single producer): queue a command; false if the queue is full. */
+bool sim_runner_post_command(SimRunner *runner, const SimCommand *command);
+/*
+ * UI thread: newest published state, interpolated to now_s (sys_time_seconds()).
+ * input_time_s (optional) receives the time_s of the newest command it includes.
+ */
+void sim_runner_render_state(SimRunner *runner, double now_s, SimState *out, double *input_time_s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_RUNNER_H */
@@ -0,0 +1,404 @@
+#include "sim_sched.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sys_atomic.h"
+#include "sys_thread.h"
+#include "sys_trace.h"
+
+#define SCHED_DEFAULT_CHUNK 1024U
+/* Yields a waiting worker makes before it parks on the condition variable. */
+#define SCHED_SPIN_YIELDS 2000U
+#define SCHED_CACHE_LINE 64U
+
+struct SchedPool;
+
+typedef struct
+{
+    /* Remaining chunk run of this worker: head in the upper, tail in the lower
+     * 32 bits. The owner pops at head, thieves take from tail; both use CAS. */
+    SysAtomicI64 range;
+    char pad_range[SCHED_CACHE_LINE - sizeof(SysAtomicI64)];
+
+    SysThread thread;
+    struct SchedPool *pool;
+    unsigned index;
+    uint64_t chunks_run;
+    uint64_t steals;
+    uint64_t failed_steals;
+    double busy_s;
+    char pad_stats[SCHED_CACHE_LINE];
+} SchedWorker;
+
+typedef struct SchedPool
+{
+    SchedWorker *workers;
+    unsigned worker_count;
+    SimSchedConfig config;
+
+    SysMutex lock;
+    SysCond wake;
+    int sleepers;
+
+    SysAtomicI64 generation;
+    SysAtomicI64 pending;
+    SysAtomicI64 quit;
+
+    /* Current epoch; written before generation is bumped. */
+    SimFleet *fleet;
+    double dt;
+    unsigned epoch_ticks;
+    size_t chunk_count;
+} SchedPool;
+
+static int64_t sched_pack_range(uint32_t head, uint32_t tail)
+{
+    return (int64_t)(((uint64_t)head << 32) | (uint64_t)tail);
+}
+
+static void sched_unpack_range(int64_t packed, uint32_t *head, uint32_t *tail)
+{
+    *head = (uint32_t)((uint64_t)packed >> 32);
+    *tail = (uint32_t)((uint64_t)packed & 0xFFFFFFFFU);
+}
+
+static bool sched_pop_own(SchedWorker *worker, uint32_t *chunk)
+{
+    int64_t current = sys_atomic_load_acquire(&worker->range);
+    for (;;)
+    {
+        uint32_t head;
+        uint32_t tail;
+        sched_unpack_range(current, &head, &tail);
+        if (head >= tail)
+        {
+            return false;
+        }
+        if (sys_atomic_compare_exchange(&worker->range, &current, sched_pack_range(head + 1U, tail)))
+        {
+            *chunk = head;
+            return true;
+        }
+    }
+}
+
+/* Returns 1 on success, 0 if the victim is empty, -1 if the CAS lost a race. */
+static int sched_steal(SchedWorker *victim, uint32_t *chunk)
+{
+    int64_t current = sys_atomic_load_acquire(&victim->range);
+    uint32_t head;
+    uint32_t tail;
+    sched_unpack_range(current, &head, &tail);
+    if (head >= tail)
+    {
+        return 0;
+    }
+    if (sys_atomic_compare_exchange(&victim->range, &current, sched_pack_range(head, tail - 1U)))
+    {
+        *chunk = tail - 1U;
+        return 1;
+    }
+    return -1;
+}
+
+static void sched_run_chunk(SchedPool *pool, SchedWorker *worker, uint32_t chunk)
+{
+    const size_t chunk_vehicles = pool->config.chunk_vehicles;
+    const size_t begin = (size_t)chunk * chunk_vehicles;
+    const size_t remaining = pool->fleet->count - begin;
+    const size_t end = begin + ((remaining < chunk_vehicles) ? remaining : chunk_vehicles);
+
+    const double start = sys_time_seconds();
+    SYS_TRACE_BEGIN(sched_chunk);
+    for (unsigned tick = 0U; tick < pool->epoch_ticks; ++tick)
+    {
+        sim_step_batch_range(pool->fleet, begin, end, pool->dt);
+    }
+    SYS_TRACE_END(sched_chunk);
+    worker->busy_s += sys_time_seconds() - start;
+    ++worker->chunks_run;
+}
+
+static void sched_run_epoch(SchedPool *pool, SchedWorker *worker)
+{
+    uint32_t chunk;
+    for (;;)
+    {
+        while (sched_pop_own(worker, &chunk))
+        {
+            sched_run_chunk(pool, worker, chunk);
+        }
+
+        bool stole = false;
+        bool contended = false;
+        for (unsigned offset = 1U; (offset < pool->worker_count) && !stole; ++offset)
+        {
+            SchedWorker *victim = &pool->workers[(worker->index + offset) % pool->worker_count];
+            const int result = sched_steal(victim, &chunk);
+            if (result > 0)
+            {
+                ++worker->steals;
+                stole = true;
+            }
+            else if (result < 0)
+            {
+                ++worker->failed_steals;
+                contended = true;
+            }
+            else
+            {
+                /* victim empty */
+            }
+        }
+
+        if (stole)
+        {
+            sched_run_chunk(pool, worker, chunk);
+        }
+        else if (!contended)
+        {
+            /* Ranges only shrink within an epoch, so one clean sweep means done. */
+            return;
+        }
+        else
+        {
+            /* lost a race; rescan */
+        }
+    }
+}
+
+static int64_t sched_wait_generation(SchedPool *pool, int64_t seen)
+{
+    for (unsigned spin = 0U; spin < SCHED_SPIN_YIELDS; ++spin)
+    {
+        const int64_t generation = sys_atomic_load_acquire(&pool->generation);
+        if (generation != seen)
+        {
+            return generation;
+        }
+        sys_thread_yield();
+    }
+
+    sys_mutex_lock(&pool->lock);
+    ++pool->sleepers;
+    while (sys_atomic_load_acquire(&pool->generation) == seen)
+    {
+        sys_cond_wait(&pool->wake, &pool->lock);
+    }
+    --pool->sleepers;
+    sys_mutex_unlock(&pool->lock);
+    return sys_atomic_load_acquire(&pool->generation);
+}
+
+static void sched_worker_main(void *arg)
+{
+    SchedWorker *worker = (SchedWorker *)arg;
+    SchedPool *pool = worker->pool;
+    int64_t seen = 0;
+
+    SYS_TRACE_THREAD("sched worker");
+    for (;;)
+    {
+        seen = sched_wait_generation(pool, seen);
+        if (sys_atomic_load_acquire(&pool->quit) != 0)
+        {
+            return;
+        }
+
+        sched_run_epoch(pool, worker);
+        (void)sys_atomic_fetch_add(&pool->pending, -1);
+    }
+}
+
+static void sched_publish(SchedPool *pool)
+{
+    sys_mutex_lock(&pool->lock);
+    (void)sys_atomic_fetch_add(&pool->generation, 1);
+    if (pool->sleepers > 0)
+    {
+        sys_cond_broadcast(&pool->wake);
+    }
+    sys_mutex_unlock(&pool->lock);
+}
+
+bool sim_sched_create(SimScheduler *sched, const SimSchedConfig *config)
+{
+    if (sched == NULL)
+    {
+        return false;
+    }
+
+    memset(sched, 0, sizeof(*sched));
+
+    SchedPool *pool = (SchedPool *)calloc(1U, sizeof(*pool));
+    if (pool == NULL)
+    {
+        return false;
+    }
+
+    if (config != NULL)
+    {
+        pool->config = *config;
+    }
+    if (pool->config.thread_count == 0U)
+    {
+        pool->config.thread_count = sys_cpu_count();
+    }
+    if (pool->config.chunk_vehicles == 0U)
+    {
+        pool->config.chunk_vehicles = SCHED_DEFAULT_CHUNK;
+    }
+    if (pool->config.ticks_per_epoch == 0U)
+    {
+        pool->config.ticks_per_epoch = 1U;
+    }
+
+    pool->workers = (SchedWorker *)calloc(pool->config.thread_count, sizeof(SchedWorker));
+    if (pool->workers == NULL)
+    {
+        free(pool);
+        return false;
+    }
+
+    sys_mutex_init(&pool->lock);
+    sys_cond_init(&pool->wake);
+    sys_atomic_init(&pool->generation, 0);
+    sys_atomic_init(&pool->pending, 0);
+    sys_atomic_init(&pool->quit, 0);
+
+    pool->worker_count = 1U;
+    pool->workers[0].pool = pool;
+    pool->workers[0].index = 0U;
+    sys_atomic_init(&pool->workers[0].range, 0);
+    for (unsigned i = 1U; i < pool->config.thread_count; ++i)
+    {
+        SchedWorker *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->index = i;
+        sys_atomic_init(&worker->range, 0);
+        if (!sys_thread_start(&worker->thread, sched_worker_main, worker))
+        {
+            break;
+        }
+        pool->worker_count = i + 1U;
+    }
+
+    sched->thread_count = pool->worker_count;
+    sched->impl = pool;
+    return true;
+}
+
+void sim_sched_destroy(SimScheduler *sched)
+{
+    if ((sched == NULL) || (sched->impl == NULL))
+    {
+        return;
+    }
+
+    SchedPool *pool = (SchedPool *)sched->impl;
+    sys_atomic_store_release(&pool->quit, 1);
+    sched_publish(pool);
+    for (unsigned i = 1U; i < pool->worker_count; ++i)
+    {
+        sys_thread_join(&pool->workers[i].thread);
+    }
+
+    sys_cond_destroy(&pool->wake);
+    sys_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+    memset(sched, 0, sizeof(*sched));
+}
+
+bool sim_sched_run(SimScheduler *sched, SimFleet *fleet, double dt, uint64_t ticks)
+{
+    if ((sched == NULL) || (sched->impl == NULL) || (fleet == NULL))
+    {
+        return false;
+    }
+
+    SchedPool *pool = (SchedPool *)sched->impl;
+    const size_t chunk_count = (fleet->count + pool->config.chunk_vehicles - 1U) / pool->config.chunk_vehicles;
+    if (chunk_count > (size_t)0x7FFFFFFF)
+    {
+        return false;
+    }
+
+    const double start = sys_time_seconds();
+    pool->fleet = fleet;
+    pool->dt = dt;
+    pool->chunk_count = chunk_count;
+
+    uint64_t done = 0U;
+    while (done < ticks)
+    {
+        const uint64_t left = ticks - done;
+        pool->epoch_ticks = (left < pool->config.ticks_per_epoch)
+            ? (unsigned)left : pool->config.ticks_per_epoch;
+
+        for (unsigned w = 0U; w < pool->worker_count; ++w)
+        {
+            const uint32_t head = (uint32_t)((chunk_count * w) / pool->worker_count);
+            const uint32_t tail = (uint32_t)((chunk_count * (w + 1U)) / pool->worker_count);
+            sys_atomic_store_release(&pool->workers[w].range, sched_pack_range(head, tail));
+        }
+        sys_atomic_store_release(&pool->pending, (int64_t)pool->worker_count - 1);
+        sched_publish(pool);
+
+        sched_run_epoch(pool, &pool->workers[0]);
+        while (sys_atomic_load_acquire(&pool->pending) != 0)
+        {
+            sys_thread_yield();
+        }
+
+        done += pool->epoch_ticks;
+        if (pool->config.on_epoch != NULL)
+        {
+            pool->config.on_epoch(pool->config.user, fleet, done);
+        }
+    }
+
+    sched->wall_s += sys_time_seconds() - start;
+    return true;
+}
+
+void sim_sched_get_stats(const SimScheduler *sched, unsigned thread_index, SimSchedThreadStats *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    if ((sched == NULL) || (sched->impl == NULL) || (thread_index >= sched->thread_count))
+    {
+        return;
+    }
+
+    const SchedPool *pool = (const SchedPool *)sched->impl;
+    const SchedWorker *worker = &pool->workers[thread_index];
+    stats->chunks_run = worker->chunks_run;
+    stats->steals = worker->steals;
+    stats->failed_steals = worker->failed_steals;
+    stats->busy_s = worker->busy_s;
+    stats->utilization = (sched->wall_s > 0.0) ? (worker->busy_s / sched->wall_s) : 0.0;
+}
+
+void sim_sched_reset_stats(SimScheduler *sched)
+{
+    if ((sched == NULL) || (sched->impl == NULL))
+    {
+        return;
+    }
+
+    SchedPool *pool = (SchedPool *)sched->impl;
+    for (unsigned i = 0U; i < pool->worker_count; ++i)
+    {
+        pool->workers[i].chunks_run = 0U;
+        pool->workers[i].steals = 0U;
+        pool->workers[i].failed_steals = 0U;
+        pool->workers[i].busy_s = 0.0;
+    }
+    sched->wall_s = 0.0;
+}
@@ -0,0 +1,64 @@
+#ifndef SIM_SCHED_H
+#define SIM_SCHED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sim_fleet.h"
+
+/*
+ * Multi-core fleet stepping. A fleet is cut into fixed chunks of vehicles; each
+ * worker starts an epoch owning a contiguous run of chunks and steals from the
+ * back of other workers' runs once its own is empty. Every chunk advances
+ * ticks_per_epoch ticks, then all workers meet at a barrier. Vehicles never
+ * interact, so results are bit-identical for any thread count or steal order.
+ */
+
+/* Called on the thread that invoked sim_sched_run() at every epoch barrier. */
+typedef void (*SimSchedEpochFn)(void *user, const SimFleet *fleet, uint64_t ticks_done);
+
+typedef struct
+{
+    unsigned thread_count;     /* 0 selects one thread per online CPU */
+    size_t chunk_vehicles;     /* vehicles per work item, 0 selects 1024 */
+    unsigned ticks_per_epoch;  /* ticks between barriers, 0 selects 1 */
+    SimSchedEpochFn on_epoch;
+    void *user;
+} SimSchedConfig;
+
+typedef struct
+{
+    uint64_t chunks_run;
+    uint64_t steals;
+    uint64_t failed_steals;
+    double busy_s;
+    double utilization;        /* busy_s / wall time of all runs since reset */
+} SimSchedThreadStats;
+
+typedef struct
+{
+    unsigned thread_count;
+    double wall_s;
+    void *impl;
+} SimScheduler;
+
+bool sim_sched_create(SimScheduler *sched, const SimSchedConfig *config);
+void sim_sched_destroy(SimScheduler *sched);
+
+/* Steps every vehicle in fleet by dt, ticks times; returns once all are done. */
+bool sim_sched_run(SimScheduler *sched, SimFleet *fleet, double dt, uint64_t ticks);
+
+/* Thread 0 is the caller of sim_sched_run(); 1..thread_count-1 are pool threads. */
+void sim_sched_get_stats(const SimScheduler *sched, unsigned thread_index, SimSchedThreadStats *stats);
+void sim_sched_reset_stats(SimScheduler *sched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_SCHED_H */
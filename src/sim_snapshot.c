@@ -0,0 +1,197 @@
+#include "sim_snapshot.h"
+
+#include <string.h>
+
+#define SNAPSHOT_FNV_OFFSET 0xCBF29CE484222325ULL
+#define SNAPSHOT_FNV_PRIME 0x00000100000001B3ULL
+
+enum
+{
+    SNAPSHOT_FLAG_LEFT = 0x0001,
+    SNAPSHOT_FLAG_RIGHT = 0x0002,
+    SNAPSHOT_FLAG_HAZARD = 0x0004,
+    SNAPSHOT_FLAG_HEADLIGHT = 0x0008,
+    SNAPSHOT_FLAG_BLINK_ON = 0x0010,
+    SNAPSHOT_FLAG_AC = 0x0020,
+    SNAPSHOT_FLAG_AUTO = 0x0040,
+    SNAPSHOT_FLAG_RECIRC = 0x0080,
+    SNAPSHOT_FLAG_DEFROST = 0x0100,
+    SNAPSHOT_FLAG_ENGINE_WARM = 0x0200
+};
+
+/* Byte offsets: 8-byte header, 12 doubles, then flags, airflow and fan level. */
+#define SNAPSHOT_OFFSET_DOUBLES 8U
+#define SNAPSHOT_DOUBLE_COUNT 12U
+#define SNAPSHOT_OFFSET_FLAGS (SNAPSHOT_OFFSET_DOUBLES + (SNAPSHOT_DOUBLE_COUNT * 8U))
+#define SNAPSHOT_OFFSET_AIRFLOW (SNAPSHOT_OFFSET_FLAGS + 2U)
+#define SNAPSHOT_OFFSET_FAN (SNAPSHOT_OFFSET_FLAGS + 4U)
+
+void sim_put_u16(uint8_t *out, uint16_t value)
+{
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+void sim_put_u32(uint8_t *out, uint32_t value)
+{
+    for (unsigned i = 0U; i < 4U; ++i)
+    {
+        out[i] = (uint8_t)(value >> (8U * i));
+    }
+}
+
+void sim_put_u64(uint8_t *out, uint64_t value)
+{
+    for (unsigned i = 0U; i < 8U; ++i)
+    {
+        out[i] = (uint8_t)(value >> (8U * i));
+    }
+}
+
+void sim_put_f64(uint8_t *out, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    sim_put_u64(out, bits);
+}
+
+uint16_t sim_get_u16(const uint8_t *in)
+{
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+uint32_t sim_get_u32(const uint8_t *in)
+{
+    uint32_t value = 0U;
+    for (unsigned i = 0U; i < 4U; ++i)
+    {
+        value |= (uint32_t)in[i] << (8U * i);
+    }
+    return value;
+}
+
+uint64_t sim_get_u64(const uint8_t *in)
+{
+    uint64_t value = 0U;
+    for (unsigned i = 0U; i < 8U; ++i)
+    {
+        value |= (uint64_t)in[i] << (8U * i);
+    }
+    return value;
+}
+
+double sim_get_f64(const uint8_t *in)
+{
+    const uint64_t bits = sim_get_u64(in);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void sim_snapshot_write(const SimState *state, uint8_t out[SIM_SNAPSHOT_BYTES])
+{
+    if ((state == NULL) || (out == NULL))
+    {
+        return;
+    }
+
+    memset(out, 0, SIM_SNAPSHOT_BYTES);
+    sim_put_u32(out, SIM_SNAPSHOT_MAGIC);
+    sim_put_u16(out + 4, (uint16_t)SIM_SNAPSHOT_VERSION);
+    sim_put_u16(out + 6, (uint16_t)SIM_SNAPSHOT_BYTES);
+
+    const double doubles[SNAPSHOT_DOUBLE_COUNT] = {
+        state->velocity_kmh,
+        state->throttle_pct,
+        state->brake_pct,
+        state->rpm,
+        state->fuel_pct,
+        state->runtime_s,
+        state->indicators.blink_elapsed,
+        state->hvac.setpoint_c,
+        state->hvac.cabin_temp_c,
+        state->hvac.outside_temp_c,
+        state->hvac.warmup_elapsed_s,
+        state->hvac.rpm_hot_s
+    };
+    for (unsigned i = 0U; i < SNAPSHOT_DOUBLE_COUNT; ++i)
+    {
+        sim_put_f64(out + SNAPSHOT_OFFSET_DOUBLES + (8U * i), doubles[i]);
+    }
+
+    uint16_t flags = 0U;
+    flags |= state->indicators.left_enabled ? SNAPSHOT_FLAG_LEFT : 0U;
+    flags |= state->indicators.right_enabled ? SNAPSHOT_FLAG_RIGHT : 0U;
+    flags |= state->indicators.hazard_enabled ? SNAPSHOT_FLAG_HAZARD : 0U;
+    flags |= state->indicators.headlight_on ? SNAPSHOT_FLAG_HEADLIGHT : 0U;
+    flags |= state->indicators.blink_on ? SNAPSHOT_FLAG_BLINK_ON : 0U;
+    flags |= state->hvac.ac_on ? SNAPSHOT_FLAG_AC : 0U;
+    flags |= state->hvac.auto_mode ? SNAPSHOT_FLAG_AUTO : 0U;
+    flags |= state->hvac.recirculation_on ? SNAPSHOT_FLAG_RECIRC : 0U;
+    flags |= state->hvac.defrost_on ? SNAPSHOT_FLAG_DEFROST : 0U;
+    flags |= state->hvac.engine_warm ? SNAPSHOT_FLAG_ENGINE_WARM : 0U;
+    sim_put_u16(out + SNAPSHOT_OFFSET_FLAGS, flags);
+    sim_put_u16(out + SNAPSHOT_OFFSET_AIRFLOW, (uint16_t)state->hvac.airflow_mode);
+    sim_put_u32(out + SNAPSHOT_OFFSET_FAN, (uint32_t)state->hvac.fan_level);
+}
+
+bool sim_snapshot_read(const uint8_t *in, size_t size, SimState *state)
+{
+    if ((in == NULL) || (state == NULL) || (size < SIM_SNAPSHOT_BYTES))
+    {
+        return false;
+    }
+    if ((sim_get_u32(in) != SIM_SNAPSHOT_MAGIC) || (sim_get_u16(in + 4) != SIM_SNAPSHOT_VERSION))
+    {
+        return false;
+    }
+
+    double doubles[SNAPSHOT_DOUBLE_COUNT];
+    for (unsigned i = 0U; i < SNAPSHOT_DOUBLE_COUNT; ++i)
+    {
+        doubles[i] = sim_get_f64(in + SNAPSHOT_OFFSET_DOUBLES + (8U * i));
+    }
+
+    memset(state, 0, sizeof(*state));
+    state->velocity_kmh = doubles[0];
+    state->throttle_pct = doubles[1];
+    state->brake_pct = doubles[2];
+    state->rpm = doubles[3];
+    state->fuel_pct = doubles[4];
+    state->runtime_s = doubles[5];
+    state->indicators.blink_elapsed = doubles[6];
+    state->hvac.setpoint_c = doubles[7];
+    state->hvac.cabin_temp_c = doubles[8];
+    state->hvac.outside_temp_c = doubles[9];
+    state->hvac.warmup_elapsed_s = doubles[10];
+    state->hvac.rpm_hot_s = doubles[11];
+
+    const uint16_t flags = sim_get_u16(in + SNAPSHOT_OFFSET_FLAGS);
+    state->indicators.left_enabled = ((flags & SNAPSHOT_FLAG_LEFT) != 0U);
+    state->indicators.right_enabled = ((flags & SNAPSHOT_FLAG_RIGHT) != 0U);
+    state->indicators.hazard_enabled = ((flags & SNAPSHOT_FLAG_HAZARD) != 0U);
+    state->indicators.headlight_on = ((flags & SNAPSHOT_FLAG_HEADLIGHT) != 0U);
+    state->indicators.blink_on = ((flags & SNAPSHOT_FLAG_BLINK_ON) != 0U);
+    state->hvac.ac_on = ((flags & SNAPSHOT_FLAG_AC) != 0U);
+    state->hvac.auto_mode = ((flags & SNAPSHOT_FLAG_AUTO) != 0U);
+    state->hvac.recirculation_on = ((flags & SNAPSHOT_FLAG_RECIRC) != 0U);
+    state->hvac.defrost_on = ((flags & SNAPSHOT_FLAG_DEFROST) != 0U);
+    state->hvac.engine_warm = ((flags & SNAPSHOT_FLAG_ENGINE_WARM) != 0U);
+    state->hvac.airflow_mode = (HvacAirflowMode)sim_get_u16(in + SNAPSHOT_OFFSET_AIRFLOW);
+    state->hvac.fan_level = (int)sim_get_u32(in + SNAPSHOT_OFFSET_FAN);
+    return true;
+}
+
+uint64_t sim_snapshot_hash(const SimState *state, uint64_t seed)
+{
+    uint8_t bytes[SIM_SNAPSHOT_BYTES];
+    sim_snapshot_write(state, bytes);
+
+    uint64_t hash = (seed != 0U) ? seed : SNAPSHOT_FNV_OFFSET;
+    for (unsigned i = 0U; i < SIM_SNAPSHOT_BYTES; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= SNAPSHOT_FNV_PRIME;
+    }
+    return hash;
+}
@@ -0,0 +1,44 @@
+#ifndef SIM_SNAPSHOT_H
+#define SIM_SNAPSHOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+/*
+ * Versioned, fixed-size binary form of SimState. Every field is stored explicitly
+ * in little-endian order (doubles as their IEEE-754 bit pattern), so the bytes are
+ * identical across compilers, struct padding and host endianness.
+ */
+#define SIM_SNAPSHOT_MAGIC 0x534D4953U /* "SIMS" */
+#define SIM_SNAPSHOT_VERSION 1U
+#define SIM_SNAPSHOT_BYTES 112U
+
+void sim_snapshot_write(const SimState *state, uint8_t out[SIM_SNAPSHOT_BYTES]);
+/* False on bad magic, unknown version or short input. */
+bool sim_snapshot_read(const uint8_t *in, size_t size, SimState *state);
+
+/* FNV-1a over the snapshot bytes, chained from seed; 0 seeds a fresh hash. */
+uint64_t sim_snapshot_hash(const SimState *state, uint64_t seed);
+
+/* Little-endian field helpers shared with the replay and telemetry formats. */
+void sim_put_u16(uint8_t *out, uint16_t value);
+void sim_put_u32(uint8_t *out, uint32_t value);
+void sim_put_u64(uint8_t *out, uint64_t value);
+void sim_put_f64(uint8_t *out, double value);
+uint16_t sim_get_u16(const uint8_t *in);
+uint32_t sim_get_u32(const uint8_t *in);
+uint64_t sim_get_u64(const uint8_t *in);
+double sim_get_f64(const uint8_t *in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_SNAPSHOT_H */
@@ -0,0 +1,24 @@
+#ifndef SIM_STAGES_H
+#define SIM_STAGES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "sim.h"
+
+/*
+ * The individual stages of sim_step(), exported for benchmarks and tools that
+ * need to time or drive them in isolation. sim_step() itself calls the static
+ * versions directly, so these wrappers cost nothing on the normal path.
+ */
+void sim_stage_update_indicators(IndicatorState *indicators, double dt);
+void sim_stage_update_engine_state(SimState *state, double dt);
+void sim_stage_apply_auto_logic(HvacState *hvac);
+void sim_stage_update_hvac(SimState *state, double dt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_STAGES_H */
@@ -0,0 +1,496 @@
+#include "sim_sweep.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sys_atomic.h"
+#include "sys_thread.h"
+#include "sys_trace.h"
+
+#define SWEEP_CHUNK_POINTS 256U
+#define SWEEP_MAX_THREADS 256U
+/*
+ * Settling is judged on window means, so the AUTO fan-level and AC hysteresis
+ * limit cycles count as settled once their average stops moving.
+ */
+#define SWEEP_SETTLE_WINDOW_S 5.0
+#define SWEEP_SETTLE_C 1e-3
+/* Halvings of one step when locating the comfort-band entry (~step / 1.7e7). */
+#define SWEEP_BISECT_STEPS 24
+
+typedef struct SweepRun SweepRun;
+
+typedef struct
+{
+    SweepRun *run;
+    SysThread thread;
+    SimSweepSummary summary;
+} SweepWorker;
+
+struct SweepRun
+{
+    const SimSweepConfig *config;
+    SimSweepPoint *points;
+    uint64_t point_count;
+    SysAtomicI64 next;
+};
+
+void sim_sweep_config_default(SimSweepConfig *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    /* Setpoints on the 0.5 C steps the cockpit can select. */
+    config->setpoint_c.min = 16.0;
+    config->setpoint_c.max = 30.0;
+    config->setpoint_c.count = 29U;
+    config->outside_c.min = -20.0;
+    config->outside_c.max = 40.0;
+    config->outside_c.count = 61U;
+    config->cabin_c.min = -10.0;
+    config->cabin_c.max = 50.0;
+    config->cabin_c.count = 61U;
+    config->comfort_c = 0.5;
+    config->step_s = 0.1;
+    config->max_s = 3600.0;
+    config->threads = 0U;
+}
+
+bool sim_sweep_parse_axis(const char *text, SimSweepAxis *axis)
+{
+    if ((text == NULL) || (axis == NULL))
+    {
+        return false;
+    }
+
+    char *end = NULL;
+    const double first = strtod(text, &end);
+    if (end == text)
+    {
+        return false;
+    }
+    if (*end == '\0')
+    {
+        axis->min = first;
+        axis->max = first;
+        axis->count = 1U;
+        return true;
+    }
+    if (*end != ':')
+    {
+        return false;
+    }
+
+    const char *next = end + 1;
+    const double second = strtod(next, &end);
+    if ((end == next) || (*end != ':'))
+    {
+        return false;
+    }
+    next = end + 1;
+    const unsigned long count = strtoul(next, &end, 10);
+    if ((end == next) || (*end != '\0') || (count == 0UL) || (count > 0xFFFFFFFFUL))
+    {
+        return false;
+    }
+
+    axis->min = first;
+    axis->max = second;
+    axis->count = (uint32_t)count;
+    return true;
+}
+
+uint64_t sim_sweep_point_count(const SimSweepConfig *config)
+{
+    if ((config == NULL) || (config->comfort_c <= 0.0) || (config->step_s <= 0.0) || (config->max_s <= 0.0))
+    {
+        return 0U;
+    }
+
+    /* Two recirculation states x two engine states. */
+    return (uint64_t)config->setpoint_c.count * (uint64_t)config->outside_c.count
+        * (uint64_t)config->cabin_c.count * 4U;
+}
+
+static double sweep_axis_value(const SimSweepAxis *axis, uint32_t index)
+{
+    if (axis->count <= 1U)
+    {
+        return axis->min;
+    }
+    return axis->min + (((axis->max - axis->min) * (double)index) / (double)(axis->count - 1U));
+}
+
+void sim_sweep_point_state(const SimSweepConfig *config, uint64_t index, SimState *state)
+{
+    if ((config == NULL) || (state == NULL))
+    {
+        return;
+    }
+
+    const bool warm = ((index & 1U) != 0U);
+    const bool recirc = ((index & 2U) != 0U);
+    uint64_t rest = index >> 2;
+    const uint32_t cabin = (uint32_t)(rest % config->cabin_c.count);
+    rest /= config->cabin_c.count;
+    const uint32_t outside = (uint32_t)(rest % config->outside_c.count);
+    rest /= config->outside_c.count;
+    const uint32_t setpoint = (uint32_t)rest;
+
+    sim_init(state);
+    state->hvac.auto_mode = true;
+    state->hvac.recirculation_on = recirc;
+    state->hvac.setpoint_c = sweep_axis_value(&config->setpoint_c, setpoint);
+    state->hvac.outside_temp_c = sweep_axis_value(&config->outside_c, outside);
+    state->hvac.cabin_temp_c = sweep_axis_value(&config->cabin_c, cabin);
+    if (warm)
+    {
+        state->hvac.engine_warm = true;
+        state->hvac.warmup_elapsed_s = 60.0;
+    }
+}
+
+/* Offset into [0, dt] at which the cabin first gets within comfort_c of the setpoint. */
+static double sweep_comfort_entry(const SimState *before, double dt, double comfort_c)
+{
+    double lo = 0.0;
+    double hi = dt;
+    for (int i = 0; i < SWEEP_BISECT_STEPS; ++i)
+    {
+        const double mid = 0.5 * (lo + hi);
+        SimState probe = *before;
+        sim_step_exact(&probe, mid);
+        if (fabs(probe.hvac.cabin_temp_c - probe.hvac.setpoint_c) < comfort_c)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid;
+        }
+    }
+    return hi;
+}
+
+void sim_sweep_run_point(const SimSweepConfig *config, const SimState *initial, SimSweepPoint *point,
+    double *fan_s)
+{
+    if ((config == NULL) || (initial == NULL) || (point == NULL))
+    {
+        return;
+    }
+
+    SimState state = *initial;
+    const double setpoint = state.hvac.setpoint_c;
+    const double start_delta = state.hvac.cabin_temp_c - setpoint;
+    const double side = (start_delta >= 0.0) ? 1.0 : -1.0;
+
+    memset(point, 0, sizeof(*point));
+    point->time_to_comfort_s = (fabs(start_delta) < config->comfort_c) ? 0.0 : -1.0;
+
+    double t = 0.0;
+    double ac_s = 0.0;
+    double window_s = 0.0;
+    double window_sum = 0.0;
+    double last_mean = 0.0;
+    bool has_mean = false;
+    while (t < config->max_s)
+    {
+        const SimState before = state;
+        const double dt = ((config->max_s - t) < config->step_s) ? (config->max_s - t) : config->step_s;
+        sim_step_exact(&state, dt);
+
+        /* The settings at the end of a step stand for the whole step. */
+        const HvacState *hvac = &state.hvac;
+        const double delta = hvac->cabin_temp_c - setpoint;
+        if (hvac->ac_on)
+        {
+            ac_s += dt;
+        }
+        if ((fan_s != NULL) && (hvac->fan_level >= 0) && (hvac->fan_level < (int)SIM_SWEEP_FAN_LEVELS))
+        {
+            fan_s[hvac->fan_level] += dt;
+        }
+        if ((-side * delta) > point->overshoot_c)
+        {
+            point->overshoot_c = -side * delta;
+        }
+        if ((point->time_to_comfort_s < 0.0) && (fabs(delta) < config->comfort_c))
+        {
+            point->time_to_comfort_s = t + sweep_comfort_entry(&before, dt, config->comfort_c);
+        }
+        t += dt;
+
+        window_sum += hvac->cabin_temp_c * dt;
+        window_s += dt;
+        if (window_s >= SWEEP_SETTLE_WINDOW_S)
+        {
+            const double mean = window_sum / window_s;
+            /* The heater gain still changes at warm-up, so a cold engine never counts as settled. */
+            if (hvac->engine_warm && has_mean && (fabs(mean - last_mean) < SWEEP_SETTLE_C))
+            {
+                point->settled = true;
+                break;
+            }
+            last_mean = mean;
+            has_mean = hvac->engine_warm;
+            window_s = 0.0;
+            window_sum = 0.0;
+        }
+    }
+
+    point->span_s = t;
+    point->ac_duty = (t > 0.0) ? (ac_s / t) : 0.0;
+    point->final_delta_c = state.hvac.cabin_temp_c - setpoint;
+}
+
+static size_t sweep_bin(double value, double bin_width, size_t bins)
+{
+    if (value <= 0.0)
+    {
+        return 0U;
+    }
+    const double index = floor(value / bin_width);
+    return (index >= (double)bins) ? bins : (size_t)index;
+}
+
+static void sweep_summary_add(SimSweepSummary *summary, const SimSweepPoint *point)
+{
+    ++summary->points;
+    summary->simulated_s += point->span_s;
+    if (point->time_to_comfort_s >= 0.0)
+    {
+        ++summary->reached;
+        ++summary->time_to_comfort[sweep_bin(point->time_to_comfort_s, SIM_SWEEP_TTC_BIN_S, SIM_SWEEP_TTC_BINS)];
+        if (point->time_to_comfort_s > summary->max_time_to_comfort_s)
+        {
+            summary->max_time_to_comfort_s = point->time_to_comfort_s;
+        }
+    }
+    else if (point->settled)
+    {
+        ++summary->settled_outside;
+    }
+    else
+    {
+        /* no action */
+    }
+    if (!point->settled)
+    {
+        ++summary->timed_out;
+    }
+
+    ++summary->overshoot[sweep_bin(point->overshoot_c, SIM_SWEEP_OVERSHOOT_BIN_C, SIM_SWEEP_OVERSHOOT_BINS)];
+    if (point->overshoot_c > summary->max_overshoot_c)
+    {
+        summary->max_overshoot_c = point->overshoot_c;
+    }
+    size_t duty = sweep_bin(point->ac_duty, 1.0 / (double)SIM_SWEEP_DUTY_BINS, SIM_SWEEP_DUTY_BINS);
+    duty = (duty >= SIM_SWEEP_DUTY_BINS) ? (SIM_SWEEP_DUTY_BINS - 1U) : duty;
+    ++summary->ac_duty[duty];
+}
+
+static void sweep_summary_merge(SimSweepSummary *dst, const SimSweepSummary *src)
+{
+    dst->points += src->points;
+    dst->reached += src->reached;
+    dst->settled_outside += src->settled_outside;
+    dst->timed_out += src->timed_out;
+    dst->simulated_s += src->simulated_s;
+    dst->max_time_to_comfort_s = (src->max_time_to_comfort_s > dst->max_time_to_comfort_s)
+        ? src->max_time_to_comfort_s : dst->max_time_to_comfort_s;
+    dst->max_overshoot_c = (src->max_overshoot_c > dst->max_overshoot_c) ? src->max_overshoot_c : dst->max_overshoot_c;
+    for (size_t i = 0U; i <= SIM_SWEEP_TTC_BINS; ++i)
+    {
+        dst->time_to_comfort[i] += src->time_to_comfort[i];
+    }
+    for (size_t i = 0U; i <= SIM_SWEEP_OVERSHOOT_BINS; ++i)
+    {
+        dst->overshoot[i] += src->overshoot[i];
+    }
+    for (size_t i = 0U; i < SIM_SWEEP_DUTY_BINS; ++i)
+    {
+        dst->ac_duty[i] += src->ac_duty[i];
+    }
+    for (size_t i = 0U; i < SIM_SWEEP_FAN_LEVELS; ++i)
+    {
+        dst->fan_s[i] += src->fan_s[i];
+    }
+}
+
+static void sweep_worker_main(void *arg)
+{
+    SweepWorker *worker = (SweepWorker *)arg;
+    SweepRun *run = worker->run;
+
+    for (;;)
+    {
+        const uint64_t begin = (uint64_t)sys_atomic_fetch_add(&run->next, (int64_t)SWEEP_CHUNK_POINTS);
+        if (begin >= run->point_count)
+        {
+            return;
+        }
+        const uint64_t end = ((run->point_count - begin) < SWEEP_CHUNK_POINTS)
+            ? run->point_count : (begin + SWEEP_CHUNK_POINTS);
+
+        SYS_TRACE_BEGIN(sweep_chunk);
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            SimState initial;
+            SimSweepPoint point;
+            memset(&point, 0, sizeof(point));
+            sim_sweep_point_state(run->config, i, &initial);
+            sim_sweep_run_point(run->config, &initial, &point, worker->summary.fan_s);
+            sweep_summary_add(&worker->summary, &point);
+            if (run->points != NULL)
+            {
+                run->points[i] = point;
+            }
+        }
+        SYS_TRACE_END(sweep_chunk);
+    }
+}
+
+static void sweep_thread_main(void *arg)
+{
+    SYS_TRACE_THREAD("sweep worker");
+    sweep_worker_main(arg);
+}
+
+bool sim_sweep_run(const SimSweepConfig *config, SimSweepSummary *summary, SimSweepPoint *points)
+{
+    if ((config == NULL) || (summary == NULL))
+    {
+        return false;
+    }
+
+    memset(summary, 0, sizeof(*summary));
+    const uint64_t point_count = sim_sweep_point_count(config);
+    if (point_count == 0U)
+    {
+        return false;
+    }
+
+    unsigned threads = (config->threads == 0U) ? sys_cpu_count() : config->threads;
+    threads = (threads > SWEEP_MAX_THREADS) ? SWEEP_MAX_THREADS : threads;
+    SweepWorker *workers = (SweepWorker *)calloc(threads, sizeof(SweepWorker));
+    if (workers == NULL)
+    {
+        return false;
+    }
+
+    SweepRun run;
+    run.config = config;
+    run.points = points;
+    run.point_count = point_count;
+    sys_atomic_init(&run.next, 0);
+
+    /* Worker 0 is the calling thread. */
+    unsigned started = 1U;
+    for (unsigned i = 0U; i < threads; ++i)
+    {
+        workers[i].run = &run;
+    }
+    for (unsigned i = 1U; i < threads; ++i)
+    {
+        if (!sys_thread_start(&workers[i].thread, sweep_thread_main, &workers[i]))
+        {
+            break;
+        }
+        started = i + 1U;
+    }
+    sweep_worker_main(&workers[0]);
+
+    for (unsigned i = 0U; i < started; ++i)
+    {
+        if (i > 0U)
+        {
+            sys_thread_join(&workers[i].thread);
+        }
+        sweep_summary_merge(summary, &workers[i].summary);
+    }
+    summary->threads_used = started;
+    free(workers);
+    return true;
+}
+
+static bool sweep_write_histogram(FILE *out, const char *name, double bin_width, const uint64_t *counts,
+    size_t bins, bool overflow)
+{
+    bool ok = fprintf(out, "histogram=%s bin=%g\n", name, bin_width) > 0;
+    for (size_t i = 0U; i < bins; ++i)
+    {
+        if (counts[i] != 0U)
+        {
+            ok = (fprintf(out, "  from=%g to=%g count=%llu\n", (double)i * bin_width, (double)(i + 1U) * bin_width,
+                (unsigned long long)counts[i]) > 0) && ok;
+        }
+    }
+    if (overflow && (counts[bins] != 0U))
+    {
+        ok = (fprintf(out, "  from=%g count=%llu\n", (double)bins * bin_width, (unsigned long long)counts[bins]) > 0)
+            && ok;
+    }
+    return ok;
+}
+
+bool sim_sweep_write_report(const SimSweepConfig *config, const SimSweepSummary *summary, FILE *out)
+{
+    if ((config == NULL) || (summary == NULL) || (out == NULL))
+    {
+        return false;
+    }
+
+    bool ok = fprintf(out, "sweep points=%llu setpoint_c=%g:%g:%u outside_c=%g:%g:%u cabin_c=%g:%g:%u "
+        "comfort_c=%g step_s=%g max_s=%g threads=%u\n",
+        (unsigned long long)summary->points, config->setpoint_c.min, config->setpoint_c.max,
+        (unsigned)config->setpoint_c.count, config->outside_c.min, config->outside_c.max,
+        (unsigned)config->outside_c.count, config->cabin_c.min, config->cabin_c.max, (unsigned)config->cabin_c.count,
+        config->comfort_c, config->step_s, config->max_s, summary->threads_used) > 0;
+    ok = (fprintf(out, "reached=%llu settled_outside=%llu timed_out=%llu max_time_to_comfort_s=%.3f "
+        "max_overshoot_c=%.3f simulated_s=%.0f\n",
+        (unsigned long long)summary->reached, (unsigned long long)summary->settled_outside,
+        (unsigned long long)summary->timed_out, summary->max_time_to_comfort_s, summary->max_overshoot_c,
+        summary->simulated_s) > 0) && ok;
+
+    ok = sweep_write_histogram(out, "time_to_comfort_s", SIM_SWEEP_TTC_BIN_S, summary->time_to_comfort,
+        SIM_SWEEP_TTC_BINS, true) && ok;
+    ok = sweep_write_histogram(out, "overshoot_c", SIM_SWEEP_OVERSHOOT_BIN_C, summary->overshoot,
+        SIM_SWEEP_OVERSHOOT_BINS, true) && ok;
+    ok = sweep_write_histogram(out, "ac_duty", 1.0 / (double)SIM_SWEEP_DUTY_BINS, summary->ac_duty,
+        SIM_SWEEP_DUTY_BINS, false) && ok;
+
+    ok = (fprintf(out, "histogram=fan_level unit=simulated_s\n") > 0) && ok;
+    for (size_t i = 0U; i < SIM_SWEEP_FAN_LEVELS; ++i)
+    {
+        ok = (fprintf(out, "  level=%zu seconds=%.0f share=%.4f\n", i, summary->fan_s[i],
+            (summary->simulated_s > 0.0) ? (summary->fan_s[i] / summary->simulated_s) : 0.0) > 0) && ok;
+    }
+    return ok;
+}
+
+bool sim_sweep_write_points(const SimSweepConfig *config, const SimSweepPoint *points, FILE *out)
+{
+    if ((config == NULL) || (points == NULL) || (out == NULL))
+    {
+        return false;
+    }
+
+    bool ok = fprintf(out, "setpoint_c,outside_c,cabin_c,recirc,warm,time_to_comfort_s,overshoot_c,ac_duty,"
+        "span_s,final_delta_c,settled\n") > 0;
+    const uint64_t count = sim_sweep_point_count(config);
+    for (uint64_t i = 0U; (i < count) && ok; ++i)
+    {
+        SimState initial;
+        sim_sweep_point_state(config, i, &initial);
+        const SimSweepPoint *point = &points[i];
+        ok = fprintf(out, "%g,%g,%g,%d,%d,%.3f,%.4f,%.4f,%.1f,%.4f,%d\n", initial.hvac.setpoint_c,
+            initial.hvac.outside_temp_c, initial.hvac.cabin_temp_c, initial.hvac.recirculation_on ? 1 : 0,
+            initial.hvac.engine_warm ? 1 : 0, point->time_to_comfort_s, point->overshoot_c, point->ac_duty,
+            point->span_s, point->final_delta_c, point->settled ? 1 : 0) > 0;
+    }
+    return ok;
+}
@@ -0,0 +1,103 @@
+#ifndef SIM_SWEEP_H
+#define SIM_SWEEP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sim.h"
+
+/*
+ * HVAC AUTO comfort sweep. Every point of the grid setpoint x outside x initial
+ * cabin x recirculation (off, on) x engine (cold, warm) starts parked in AUTO
+ * and is advanced with sim_step_exact() until the cabin settles or max_s runs
+ * out. The cabin is integrated in closed form, so step_s only sets how finely
+ * AC duty, fan time and overshoot are sampled; the first entry into the comfort
+ * band is refined by bisection. Points are dealt to threads in chunks from an
+ * atomic counter; every point is independent, so the counts do not depend on
+ * the thread count (the summed seconds only up to rounding).
+ */
+#define SIM_SWEEP_FAN_LEVELS 8U
+#define SIM_SWEEP_TTC_BIN_S 0.25
+#define SIM_SWEEP_TTC_BINS 120U         /* 0..30 s, plus one bin for longer */
+#define SIM_SWEEP_OVERSHOOT_BIN_C 0.05
+#define SIM_SWEEP_OVERSHOOT_BINS 60U    /* 0..3 C, plus one bin for more */
+#define SIM_SWEEP_DUTY_BINS 20U         /* 5 % each; 100 % lands in the last */
+
+/* count evenly spaced values from min to max (just min when count is 1). */
+typedef struct
+{
+    double min;
+    double max;
+    uint32_t count;
+} SimSweepAxis;
+
+typedef struct
+{
+    SimSweepAxis setpoint_c;
+    SimSweepAxis outside_c;
+    SimSweepAxis cabin_c;
+    double comfort_c;    /* comfortable while |cabin - setpoint| < comfort_c */
+    double step_s;       /* sampling step; the thermal model itself is exact */
+    double max_s;        /* give up on a point after this much simulated time */
+    unsigned threads;    /* 0 selects one thread per online CPU */
+} SimSweepConfig;
+
+typedef struct
+{
+    double time_to_comfort_s;  /* first time inside the band; negative if never */
+    double overshoot_c;        /* furthest excursion past the setpoint, away from the start side */
+    double ac_duty;            /* share of the simulated span with the AC on */
+    double span_s;             /* simulated time until settled (or max_s) */
+    double final_delta_c;      /* cabin - setpoint at the end */
+    bool settled;              /* window mean at rest (limit cycles included); false: still drifting at max_s */
+} SimSweepPoint;
+
+typedef struct
+{
+    uint64_t points;
+    uint64_t reached;          /* entered the comfort band */
+    uint64_t settled_outside;  /* came to rest without ever entering it */
+    uint64_t timed_out;        /* still drifting at max_s */
+    double simulated_s;
+    double max_time_to_comfort_s;
+    double max_overshoot_c;
+    uint64_t time_to_comfort[SIM_SWEEP_TTC_BINS + 1U];
+    uint64_t overshoot[SIM_SWEEP_OVERSHOOT_BINS + 1U];
+    uint64_t ac_duty[SIM_SWEEP_DUTY_BINS];
+    double fan_s[SIM_SWEEP_FAN_LEVELS]; /* simulated seconds at each fan level, all points */
+    unsigned threads_used;
+} SimSweepSummary;
+
+/* 29 setpoints x 61 outside x 61 cabin temperatures x 4 = 431,636 points. */
+void sim_sweep_config_default(SimSweepConfig *config);
+/* Parses "min:max:count" (or a single value); false when malformed. */
+bool sim_sweep_parse_axis(const char *text, SimSweepAxis *axis);
+/* Grid size; 0 when the config is unusable. */
+uint64_t sim_sweep_point_count(const SimSweepConfig *config);
+/* Initial state of grid point index; the warm flag varies fastest, the setpoint slowest. */
+void sim_sweep_point_state(const SimSweepConfig *config, uint64_t index, SimState *state);
+/* Runs one point; fan_s (optional) gets the seconds spent at each fan level added. */
+void sim_sweep_run_point(const SimSweepConfig *config, const SimState *initial, SimSweepPoint *point,
+    double *fan_s);
+/*
+ * Runs the whole grid across threads. points (optional) must hold
+ * sim_sweep_point_count() entries and receives every result in grid order.
+ */
+bool sim_sweep_run(const SimSweepConfig *config, SimSweepSummary *summary, SimSweepPoint *points);
+
+/* Grid, outcome counts and the histograms as text; false on a write error. */
+bool sim_sweep_write_report(const SimSweepConfig *config, const SimSweepSummary *summary, FILE *out);
+/* One CSV row per point with its inputs and results; false on a write error. */
+bool sim_sweep_write_points(const SimSweepConfig *config, const SimSweepPoint *points, FILE *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_SWEEP_H */
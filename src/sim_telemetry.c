@@ -0,0 +1,862 @@
+#include "sim_telemetry.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim_snapshot.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/* Block layout: 24-byte header, column directory, then column payloads. */
+#define TELEMETRY_BLOCK_HEADER_BYTES 24U
+#define TELEMETRY_DOUBLE_DIR_BYTES 24U
+#define TELEMETRY_SMALL_DIR_BYTES 12U
+#define TELEMETRY_DIR_END (TELEMETRY_BLOCK_HEADER_BYTES \
+    + (SIM_TELEMETRY_DOUBLE_COUNT * TELEMETRY_DOUBLE_DIR_BYTES) \
+    + (SIM_TELEMETRY_SMALL_COUNT * TELEMETRY_SMALL_DIR_BYTES))
+
+/* Worst case per XOR-encoded value: 2 control + 5 lead + 6 length + 64 payload bits. */
+#define TELEMETRY_MAX_DOUBLE_BYTES (16U + ((SIM_TELEMETRY_BLOCK_ROWS * 77U) / 8U))
+#define TELEMETRY_MAX_SMALL_BYTES (8U + ((SIM_TELEMETRY_BLOCK_ROWS * 8U) / 8U))
+#define TELEMETRY_MAX_BLOCK_BYTES (TELEMETRY_DIR_END \
+    + (SIM_TELEMETRY_DOUBLE_COUNT * TELEMETRY_MAX_DOUBLE_BYTES) \
+    + (SIM_TELEMETRY_SMALL_COUNT * TELEMETRY_MAX_SMALL_BYTES))
+
+static const unsigned TELEMETRY_SMALL_BITS[SIM_TELEMETRY_SMALL_COUNT] = {
+    1U, 1U, 1U, 1U, 1U, 1U, 1U, 1U, 1U, 1U, 2U, 3U
+};
+
+typedef struct
+{
+    uint8_t *out;
+    size_t pos;
+    uint64_t acc;
+    unsigned bits;
+} TelemetryBitWriter;
+
+typedef struct
+{
+    const uint8_t *in;
+    size_t size;
+    size_t pos;
+    uint64_t acc;
+    unsigned bits;
+} TelemetryBitReader;
+
+static unsigned telemetry_clz64(uint64_t x)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    (void)_BitScanReverse64(&index, x);
+    return 63U - (unsigned)index;
+#else
+    return (unsigned)__builtin_clzll(x);
+#endif
+}
+
+static unsigned telemetry_ctz64(uint64_t x)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    (void)_BitScanForward64(&index, x);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctzll(x);
+#endif
+}
+
+/* n <= 32; whole 32-bit words are stored as soon as they fill. */
+static void bits_put(TelemetryBitWriter *writer, uint64_t value, unsigned n)
+{
+    writer->acc |= (value & ((1ULL << n) - 1U)) << writer->bits;
+    writer->bits += n;
+    if (writer->bits >= 32U)
+    {
+        uint8_t *out = writer->out + writer->pos;
+        out[0] = (uint8_t)writer->acc;
+        out[1] = (uint8_t)(writer->acc >> 8);
+        out[2] = (uint8_t)(writer->acc >> 16);
+        out[3] = (uint8_t)(writer->acc >> 24);
+        writer->pos += 4U;
+        writer->acc >>= 32;
+        writer->bits -= 32U;
+    }
+}
+
+static void bits_put_wide(TelemetryBitWriter *writer, uint64_t value, unsigned n)
+{
+    if (n > 32U)
+    {
+        bits_put(writer, value, 32U);
+        bits_put(writer, value >> 32, n - 32U);
+    }
+    else
+    {
+        bits_put(writer, value, n);
+    }
+}
+
+static size_t bits_finish(TelemetryBitWriter *writer)
+{
+    while (writer->bits > 0U)
+    {
+        writer->out[writer->pos] = (uint8_t)writer->acc;
+        ++writer->pos;
+        writer->acc >>= 8;
+        writer->bits = (writer->bits > 8U) ? (writer->bits - 8U) : 0U;
+    }
+    writer->acc = 0U;
+    writer->bits = 0U;
+    return writer->pos;
+}
+
+/* n <= 32; reads past the end return zero bits instead of faulting. */
+static uint64_t bits_get(TelemetryBitReader *reader, unsigned n)
+{
+    while (reader->bits < n)
+    {
+        const uint64_t byte = (reader->pos < reader->size) ? reader->in[reader->pos] : 0U;
+        ++reader->pos;
+        reader->acc |= byte << reader->bits;
+        reader->bits += 8U;
+    }
+
+    const uint64_t value = reader->acc & ((1ULL << n) - 1U);
+    reader->acc >>= n;
+    reader->bits -= n;
+    return value;
+}
+
+static uint64_t bits_get_wide(TelemetryBitReader *reader, unsigned n)
+{
+    if (n > 32U)
+    {
+        const uint64_t low = bits_get(reader, 32U);
+        return low | (bits_get(reader, n - 32U) << 32);
+    }
+    return bits_get(reader, n);
+}
+
+static uint64_t telemetry_bits_of(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static size_t telemetry_encode_doubles(const double *values, uint32_t rows, uint8_t *out,
+    double *min_out, double *max_out)
+{
+    TelemetryBitWriter writer = { out, 0U, 0U, 0U };
+    uint64_t previous = telemetry_bits_of(values[0]);
+    bits_put_wide(&writer, previous, 64U);
+
+    double min_value = values[0];
+    double max_value = values[0];
+    unsigned window_lead = 64U;
+    unsigned window_trail = 0U;
+    for (uint32_t i = 1U; i < rows; ++i)
+    {
+        const double value = values[i];
+        min_value = (value < min_value) ? value : min_value;
+        max_value = (value > max_value) ? value : max_value;
+
+        const uint64_t bits = telemetry_bits_of(value);
+        const uint64_t x = bits ^ previous;
+        previous = bits;
+        if (x == 0U)
+        {
+            bits_put(&writer, 0U, 1U);
+            continue;
+        }
+
+        unsigned lead = telemetry_clz64(x);
+        const unsigned trail = telemetry_ctz64(x);
+        lead = (lead > 31U) ? 31U : lead;
+        if ((window_lead < 64U) && (lead >= window_lead) && (trail >= window_trail))
+        {
+            /* '10': reuse the previous meaningful-bit window. */
+            bits_put(&writer, 1U, 2U);
+            bits_put_wide(&writer, x >> window_trail, 64U - window_lead - window_trail);
+        }
+        else
+        {
+            /* '11': new window, 5-bit leading zeros and 6-bit length (0 means 64). */
+            const unsigned significant = 64U - lead - trail;
+            bits_put(&writer, 3U, 2U);
+            bits_put(&writer, lead, 5U);
+            bits_put(&writer, significant & 63U, 6U);
+            bits_put_wide(&writer, x >> trail, significant);
+            window_lead = lead;
+            window_trail = trail;
+        }
+    }
+
+    *min_out = min_value;
+    *max_out = max_value;
+    return bits_finish(&writer);
+}
+
+static size_t telemetry_encode_small(const uint8_t *values, uint32_t rows, unsigned width, uint8_t *out,
+    uint8_t *min_out, uint8_t *max_out)
+{
+    TelemetryBitWriter writer = { out, 0U, 0U, 0U };
+    uint8_t min_value = values[0];
+    uint8_t max_value = values[0];
+    for (uint32_t i = 0U; i < rows; ++i)
+    {
+        const uint8_t value = values[i];
+        min_value = (value < min_value) ? value : min_value;
+        max_value = (value > max_value) ? value : max_value;
+        bits_put(&writer, value, width);
+    }
+
+    *min_out = min_value;
+    *max_out = max_value;
+    return bits_finish(&writer);
+}
+
+/* Runs on the encoder thread, once per block; the index grows geometrically. */
+static void telemetry_index_block(SimTelemetryWriter *writer, uint64_t offset, uint64_t first_row,
+    double t_min, double t_max)
+{
+    const size_t used = (size_t)writer->blocks * SIM_TELEMETRY_INDEX_ENTRY_BYTES;
+    if ((used + SIM_TELEMETRY_INDEX_ENTRY_BYTES) > writer->index_capacity)
+    {
+        const size_t capacity = (writer->index_capacity > 0U) ? (writer->index_capacity * 2U) : 4096U;
+        uint8_t *grown = (uint8_t *)realloc(writer->index, capacity);
+        if (grown == NULL)
+        {
+            writer->failed = true;
+            return;
+        }
+        writer->index = grown;
+        writer->index_capacity = capacity;
+    }
+
+    uint8_t *entry = writer->index + used;
+    sim_put_u64(entry, offset);
+    sim_put_u64(entry + 8, first_row);
+    sim_put_f64(entry + 16, t_min);
+    sim_put_f64(entry + 24, t_max);
+}
+
+static void telemetry_encode_block(SimTelemetryWriter *writer, double *const *doubles, uint8_t *const *smalls,
+    uint32_t rows, uint64_t first_row)
+{
+    uint8_t *block = writer->encoded;
+    size_t pos = TELEMETRY_DIR_END;
+    uint8_t *dir = block + TELEMETRY_BLOCK_HEADER_BYTES;
+    for (unsigned c = 0U; c < SIM_TELEMETRY_DOUBLE_COUNT; ++c, dir += TELEMETRY_DOUBLE_DIR_BYTES)
+    {
+        double min_value;
+        double max_value;
+        const size_t bytes = telemetry_encode_doubles(doubles[c], rows, block + pos, &min_value, &max_value);
+        sim_put_f64(dir, min_value);
+        sim_put_f64(dir + 8, max_value);
+        sim_put_u32(dir + 16, (uint32_t)pos);
+        sim_put_u32(dir + 20, (uint32_t)bytes);
+        pos += bytes;
+    }
+    for (unsigned c = 0U; c < SIM_TELEMETRY_SMALL_COUNT; ++c, dir += TELEMETRY_SMALL_DIR_BYTES)
+    {
+        uint8_t min_value;
+        uint8_t max_value;
+        const size_t bytes = telemetry_encode_small(smalls[c], rows, TELEMETRY_SMALL_BITS[c], block + pos,
+            &min_value, &max_value);
+        dir[0] = min_value;
+        dir[1] = max_value;
+        dir[2] = (uint8_t)TELEMETRY_SMALL_BITS[c];
+        dir[3] = 0U;
+        sim_put_u32(dir + 4, (uint32_t)pos);
+        sim_put_u32(dir + 8, (uint32_t)bytes);
+        pos += bytes;
+    }
+
+    sim_put_u32(block, SIM_TELEMETRY_BLOCK_MAGIC);
+    sim_put_u32(block + 4, rows);
+    sim_put_u64(block + 8, first_row);
+    sim_put_u32(block + 16, (uint32_t)pos);
+    sim_put_u32(block + 20, 0U);
+
+    if (!writer->failed && (fwrite(block, 1U, pos, writer->file) != pos))
+    {
+        writer->failed = true;
+    }
+    telemetry_index_block(writer, writer->bytes_written, first_row,
+        sim_get_f64(block + TELEMETRY_BLOCK_HEADER_BYTES + (SIM_TELEMETRY_RUNTIME_S * TELEMETRY_DOUBLE_DIR_BYTES)),
+        sim_get_f64(block + TELEMETRY_BLOCK_HEADER_BYTES + (SIM_TELEMETRY_RUNTIME_S * TELEMETRY_DOUBLE_DIR_BYTES) + 8U));
+    writer->bytes_written += pos;
+    ++writer->blocks;
+}
+
+static void telemetry_encoder_main(void *arg)
+{
+    SimTelemetryWriter *writer = (SimTelemetryWriter *)arg;
+
+    sys_mutex_lock(&writer->lock);
+    for (;;)
+    {
+        while (!writer->job_pending && !writer->stopping)
+        {
+            sys_cond_wait(&writer->cond, &writer->lock);
+        }
+        if (!writer->job_pending)
+        {
+            break;
+        }
+
+        sys_mutex_unlock(&writer->lock);
+        telemetry_encode_block(writer, writer->spare_doubles, writer->spare_smalls, writer->job_rows,
+            writer->job_first_row);
+        sys_mutex_lock(&writer->lock);
+
+        writer->job_pending = false;
+        sys_cond_broadcast(&writer->cond);
+    }
+    sys_mutex_unlock(&writer->lock);
+}
+
+static void telemetry_wait_idle(SimTelemetryWriter *writer)
+{
+    if (writer->job_pending)
+    {
+        const double start = sys_time_seconds();
+        while (writer->job_pending)
+        {
+            sys_cond_wait(&writer->cond, &writer->lock);
+        }
+        writer->stall_s += sys_time_seconds() - start;
+    }
+}
+
+/* Swaps the staged columns with the encoder's and queues them; waits only if the previous block is still encoding. */
+static void telemetry_flush_block(SimTelemetryWriter *writer)
+{
+    const uint32_t rows = writer->staged;
+    if (rows == 0U)
+    {
+        return;
+    }
+
+    sys_mutex_lock(&writer->lock);
+    telemetry_wait_idle(writer);
+    for (unsigned c = 0U; c < SIM_TELEMETRY_DOUBLE_COUNT; ++c)
+    {
+        double *column = writer->doubles[c];
+        writer->doubles[c] = writer->spare_doubles[c];
+        writer->spare_doubles[c] = column;
+    }
+    for (unsigned c = 0U; c < SIM_TELEMETRY_SMALL_COUNT; ++c)
+    {
+        uint8_t *column = writer->smalls[c];
+        writer->smalls[c] = writer->spare_smalls[c];
+        writer->spare_smalls[c] = column;
+    }
+    writer->job_rows = rows;
+    writer->job_first_row = writer->rows_flushed;
+    writer->job_pending = true;
+    sys_cond_broadcast(&writer->cond);
+    sys_mutex_unlock(&writer->lock);
+
+    writer->rows_flushed += rows;
+    writer->staged = 0U;
+}
+
+bool sim_telemetry_open(SimTelemetryWriter *writer, const char *path, uint32_t rows_per_tick)
+{
+    if ((writer == NULL) || (path == NULL))
+    {
+        return false;
+    }
+
+    memset(writer, 0, sizeof(*writer));
+    const size_t double_bytes = (size_t)SIM_TELEMETRY_DOUBLE_COUNT * SIM_TELEMETRY_BLOCK_ROWS * sizeof(double);
+    const size_t small_bytes = (size_t)SIM_TELEMETRY_SMALL_COUNT * SIM_TELEMETRY_BLOCK_ROWS;
+    writer->storage = malloc((2U * (double_bytes + small_bytes)) + TELEMETRY_MAX_BLOCK_BYTES);
+    if (writer->storage == NULL)
+    {
+        return false;
+    }
+
+    uint8_t *cursor = (uint8_t *)writer->storage;
+    for (unsigned c = 0U; c < SIM_TELEMETRY_DOUBLE_COUNT; ++c)
+    {
+        writer->doubles[c] = (double *)cursor;
+        cursor += SIM_TELEMETRY_BLOCK_ROWS * sizeof(double);
+        writer->spare_doubles[c] = (double *)cursor;
+        cursor += SIM_TELEMETRY_BLOCK_ROWS * sizeof(double);
+    }
+    for (unsigned c = 0U; c < SIM_TELEMETRY_SMALL_COUNT; ++c)
+    {
+        writer->smalls[c] = cursor;
+        cursor += SIM_TELEMETRY_BLOCK_ROWS;
+        writer->spare_smalls[c] = cursor;
+        cursor += SIM_TELEMETRY_BLOCK_ROWS;
+    }
+    writer->encoded = cursor;
+    writer->rows_per_tick = (rows_per_tick > 0U) ? rows_per_tick : 1U;
+
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL)
+    {
+        free(writer->storage);
+        writer->storage = NULL;
+        return false;
+    }
+
+    uint8_t header[SIM_TELEMETRY_FILE_HEADER_BYTES];
+    memset(header, 0, sizeof(header));
+    sim_put_u32(header, SIM_TELEMETRY_MAGIC);
+    sim_put_u16(header + 4, (uint16_t)SIM_TELEMETRY_VERSION);
+    sim_put_u16(header + 6, (uint16_t)SIM_TELEMETRY_BLOCK_ROWS);
+    sim_put_u32(header + 8, writer->rows_per_tick);
+    header[12] = (uint8_t)SIM_TELEMETRY_DOUBLE_COUNT;
+    header[13] = (uint8_t)SIM_TELEMETRY_SMALL_COUNT;
+    writer->failed = (fwrite(header, 1U, sizeof(header), writer->file) != sizeof(header));
+    writer->bytes_written = sizeof(header);
+
+    sys_mutex_init(&writer->lock);
+    sys_cond_init(&writer->cond);
+    if (writer->failed || !sys_thread_start(&writer->encoder, telemetry_encoder_main, writer))
+    {
+        sys_cond_destroy(&writer->cond);
+        sys_mutex_destroy(&writer->lock);
+        (void)fclose(writer->file);
+        writer->file = NULL;
+        free(writer->storage);
+        writer->storage = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool sim_telemetry_close(SimTelemetryWriter *writer)
+{
+    if ((writer == NULL) || (writer->file == NULL))
+    {
+        return false;
+    }
+
+    telemetry_flush_block(writer);
+    sys_mutex_lock(&writer->lock);
+    telemetry_wait_idle(writer);
+    writer->stopping = true;
+    sys_cond_broadcast(&writer->cond);
+    sys_mutex_unlock(&writer->lock);
+    sys_thread_join(&writer->encoder);
+    sys_cond_destroy(&writer->cond);
+    sys_mutex_destroy(&writer->lock);
+
+    if (!writer->failed && (writer->blocks > 0U))
+    {
+        const size_t index_bytes = (size_t)writer->blocks * SIM_TELEMETRY_INDEX_ENTRY_BYTES;
+        uint8_t trailer[SIM_TELEMETRY_INDEX_TRAILER_BYTES];
+        sim_put_u64(trailer, writer->bytes_written);
+        sim_put_u32(trailer + 8, (uint32_t)writer->blocks);
+        sim_put_u32(trailer + 12, SIM_TELEMETRY_INDEX_MAGIC);
+        writer->failed = (fwrite(writer->index, 1U, index_bytes, writer->file) != index_bytes)
+            || (fwrite(trailer, 1U, sizeof(trailer), writer->file) != sizeof(trailer));
+        writer->bytes_written += index_bytes + sizeof(trailer);
+    }
+    free(writer->index);
+    writer->index = NULL;
+
+    if (fclose(writer->file) != 0)
+    {
+        writer->failed = true;
+    }
+    writer->file = NULL;
+    free(writer->storage);
+    writer->storage = NULL;
+    return !writer->failed;
+}
+
+void sim_telemetry_append(SimTelemetryWriter *writer, const SimState *state)
+{
+    if ((writer == NULL) || (writer->file == NULL) || (state == NULL))
+    {
+        return;
+    }
+
+    const uint32_t row = writer->staged;
+    writer->doubles[SIM_TELEMETRY_VELOCITY_KMH][row] = state->velocity_kmh;
+    writer->doubles[SIM_TELEMETRY_THROTTLE_PCT][row] = state->throttle_pct;
+    writer->doubles[SIM_TELEMETRY_BRAKE_PCT][row] = state->brake_pct;
+    writer->doubles[SIM_TELEMETRY_RPM][row] = state->rpm;
+    writer->doubles[SIM_TELEMETRY_FUEL_PCT][row] = state->fuel_pct;
+    writer->doubles[SIM_TELEMETRY_RUNTIME_S][row] = state->runtime_s;
+    writer->doubles[SIM_TELEMETRY_CABIN_TEMP_C][row] = state->hvac.cabin_temp_c;
+    writer->doubles[SIM_TELEMETRY_SETPOINT_C][row] = state->hvac.setpoint_c;
+    writer->doubles[SIM_TELEMETRY_OUTSIDE_TEMP_C][row] = state->hvac.outside_temp_c;
+
+    writer->smalls[SIM_TELEMETRY_LEFT_ENABLED][row] = state->indicators.left_enabled ? 1U : 0U;
+    writer->smalls[SIM_TELEMETRY_RIGHT_ENABLED][row] = state->indicators.right_enabled ? 1U : 0U;
+    writer->smalls[SIM_TELEMETRY_HAZARD_ENABLED][row] = state->indicators.hazard_enabled ? 1U : 0U;
+    writer->smalls[SIM_TELEMETRY_HEADLIGHT_ON][row] = state->indicators.headlight_on ? 1U : 0U;
+    writer->smalls[SIM_TELEMETRY_BLINK_ON][row] = state->indicators.blink_on ? 1U : 0U;
+    writer->smalls[SIM_TELEMETRY_AC_ON][row] = state->hvac.ac_on ? 1U : 0U;
+    writer->smalls[SIM_TELEMETRY_AUTO_MODE][row] = state->hvac.auto_mode ? 1U : 0U;
+    writer->smalls[SIM_TELEMETRY_RECIRCULATION_ON][row] = state->hvac.recirculation_on ? 1U : 0U;
+    writer->smalls[SIM_TELEMETRY_DEFROST_ON][row] = state->hvac.defrost_on ? 1U : 0U;
+    writer->smalls[SIM_TELEMETRY_ENGINE_WARM][row] = state->hvac.engine_warm ? 1U : 0U;
+    writer->smalls[SIM_TELEMETRY_AIRFLOW_MODE][row] = (uint8_t)state->hvac.airflow_mode;
+    writer->smalls[SIM_TELEMETRY_FAN_LEVEL][row] = (uint8_t)state->hvac.fan_level;
+
+    writer->staged = row + 1U;
+    if (writer->staged == SIM_TELEMETRY_BLOCK_ROWS)
+    {
+        telemetry_flush_block(writer);
+    }
+}
+
+void sim_telemetry_append_fleet(SimTelemetryWriter *writer, const SimFleet *fleet, size_t begin, size_t end)
+{
+    if ((writer == NULL) || (writer->file == NULL) || (fleet == NULL) || (end > fleet->count))
+    {
+        return;
+    }
+
+    const double *double_columns[SIM_TELEMETRY_DOUBLE_COUNT] = {
+        fleet->velocity_kmh, fleet->throttle_pct, fleet->brake_pct, fleet->rpm, fleet->fuel_pct,
+        fleet->runtime_s, fleet->cabin_temp_c, fleet->setpoint_c, fleet->outside_temp_c
+    };
+    const uint8_t *small_columns[SIM_TELEMETRY_FAN_LEVEL] = {
+        fleet->left_enabled, fleet->right_enabled, fleet->hazard_enabled, fleet->headlight_on,
+        fleet->blink_on, fleet->ac_on, fleet->auto_mode, fleet->recirculation_on, fleet->defrost_on,
+        fleet->engine_warm, fleet->airflow_mode
+    };
+
+    size_t v = begin;
+    while (v < end)
+    {
+        const uint32_t row = writer->staged;
+        size_t run = SIM_TELEMETRY_BLOCK_ROWS - row;
+        run = (run < (end - v)) ? run : (end - v);
+
+        for (unsigned c = 0U; c < SIM_TELEMETRY_DOUBLE_COUNT; ++c)
+        {
+            memcpy(writer->doubles[c] + row, double_columns[c] + v, run * sizeof(double));
+        }
+        for (unsigned c = 0U; c < SIM_TELEMETRY_FAN_LEVEL; ++c)
+        {
+            memcpy(writer->smalls[c] + row, small_columns[c] + v, run);
+        }
+        uint8_t *fan = writer->smalls[SIM_TELEMETRY_FAN_LEVEL] + row;
+        for (size_t i = 0U; i < run; ++i)
+        {
+            fan[i] = (uint8_t)fleet->fan_level[v + i];
+        }
+
+        writer->staged = row + (uint32_t)run;
+        v += run;
+        if (writer->staged == SIM_TELEMETRY_BLOCK_ROWS)
+        {
+            telemetry_flush_block(writer);
+        }
+    }
+}
+
+/* Uses the footer when present; otherwise walks the block headers once. */
+static bool telemetry_load_index(SimTelemetryReader *reader)
+{
+    const size_t size = reader->map.size;
+    if (size >= (SIM_TELEMETRY_FILE_HEADER_BYTES + SIM_TELEMETRY_INDEX_TRAILER_BYTES))
+    {
+        const uint8_t *trailer = reader->map.data + size - SIM_TELEMETRY_INDEX_TRAILER_BYTES;
+        const uint64_t index_offset = sim_get_u64(trailer);
+        const uint64_t count = sim_get_u32(trailer + 8);
+        const uint64_t index_end = index_offset + (count * SIM_TELEMETRY_INDEX_ENTRY_BYTES);
+        if ((sim_get_u32(trailer + 12) == SIM_TELEMETRY_INDEX_MAGIC) && (index_offset >= SIM_TELEMETRY_FILE_HEADER_BYTES)
+            && (index_end == (uint64_t)(size - SIM_TELEMETRY_INDEX_TRAILER_BYTES)))
+        {
+            reader->index = reader->map.data + index_offset;
+            reader->block_count = (size_t)count;
+            return true;
+        }
+    }
+
+    size_t capacity = 0U;
+    size_t count = 0U;
+    uint8_t *entries = NULL;
+    size_t offset = 0U;
+    size_t block_offset = SIM_TELEMETRY_FILE_HEADER_BYTES;
+    SimTelemetryBlock block;
+    while (sim_telemetry_next_block(reader, &offset, &block))
+    {
+        if (((count + 1U) * SIM_TELEMETRY_INDEX_ENTRY_BYTES) > capacity)
+        {
+            capacity = (capacity > 0U) ? (capacity * 2U) : 4096U;
+            uint8_t *grown = (uint8_t *)realloc(entries, capacity);
+            if (grown == NULL)
+            {
+                free(entries);
+                return false;
+            }
+            entries = grown;
+        }
+
+        double t_min = 0.0;
+        double t_max = 0.0;
+        sim_telemetry_block_range(&block, SIM_TELEMETRY_RUNTIME_S, &t_min, &t_max);
+        uint8_t *entry = entries + (count * SIM_TELEMETRY_INDEX_ENTRY_BYTES);
+        sim_put_u64(entry, block_offset);
+        sim_put_u64(entry + 8, block.first_row);
+        sim_put_f64(entry + 16, t_min);
+        sim_put_f64(entry + 24, t_max);
+        ++count;
+        block_offset = offset;
+    }
+
+    reader->owned_index = entries;
+    reader->index = entries;
+    reader->block_count = count;
+    return true;
+}
+
+bool sim_telemetry_reader_open(SimTelemetryReader *reader, const char *path)
+{
+    if ((reader == NULL) || (path == NULL))
+    {
+        return false;
+    }
+
+    memset(reader, 0, sizeof(*reader));
+    if (!sys_file_map(&reader->map, path))
+    {
+        return false;
+    }
+
+    const uint8_t *header = reader->map.data;
+    const bool valid = (reader->map.size >= SIM_TELEMETRY_FILE_HEADER_BYTES)
+        && (sim_get_u32(header) == SIM_TELEMETRY_MAGIC)
+        && (sim_get_u16(header + 4) >= 1U) && (sim_get_u16(header + 4) <= SIM_TELEMETRY_VERSION)
+        && (header[12] == SIM_TELEMETRY_DOUBLE_COUNT)
+        && (header[13] == SIM_TELEMETRY_SMALL_COUNT);
+    if (!valid)
+    {
+        sys_file_unmap(&reader->map);
+        return false;
+    }
+
+    reader->rows_per_tick = sim_get_u32(header + 8);
+    if (!telemetry_load_index(reader))
+    {
+        sys_file_unmap(&reader->map);
+        return false;
+    }
+    return true;
+}
+
+void sim_telemetry_reader_close(SimTelemetryReader *reader)
+{
+    if (reader == NULL)
+    {
+        return;
+    }
+
+    free(reader->owned_index);
+    reader->owned_index = NULL;
+    reader->index = NULL;
+    reader->block_count = 0U;
+    sys_file_unmap(&reader->map);
+}
+
+size_t sim_telemetry_block_count(const SimTelemetryReader *reader)
+{
+    return (reader != NULL) ? reader->block_count : 0U;
+}
+
+bool sim_telemetry_block_at(const SimTelemetryReader *reader, size_t block_index, SimTelemetryBlock *block)
+{
+    if ((reader == NULL) || (block_index >= reader->block_count))
+    {
+        return false;
+    }
+
+    size_t offset = (size_t)sim_get_u64(reader->index + (block_index * SIM_TELEMETRY_INDEX_ENTRY_BYTES));
+    return sim_telemetry_next_block(reader, &offset, block);
+}
+
+void sim_telemetry_block_time(const SimTelemetryReader *reader, size_t block_index, double *t_min, double *t_max)
+{
+    if ((reader == NULL) || (block_index >= reader->block_count))
+    {
+        return;
+    }
+
+    const uint8_t *entry = reader->index + (block_index * SIM_TELEMETRY_INDEX_ENTRY_BYTES);
+    if (t_min != NULL)
+    {
+        *t_min = sim_get_f64(entry + 16);
+    }
+    if (t_max != NULL)
+    {
+        *t_max = sim_get_f64(entry + 24);
+    }
+}
+
+size_t sim_telemetry_find_time(const SimTelemetryReader *reader, double t_s)
+{
+    if ((reader == NULL) || (reader->block_count == 0U))
+    {
+        return 0U;
+    }
+
+    size_t low = 0U;
+    size_t high = reader->block_count - 1U;
+    while (low < high)
+    {
+        const size_t mid = low + ((high - low) / 2U);
+        double t_max = 0.0;
+        sim_telemetry_block_time(reader, mid, NULL, &t_max);
+        if (t_max < t_s)
+        {
+            low = mid + 1U;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+bool sim_telemetry_next_block(const SimTelemetryReader *reader, size_t *offset, SimTelemetryBlock *block)
+{
+    if ((reader == NULL) || (offset == NULL) || (block == NULL) || (reader->map.data == NULL))
+    {
+        return false;
+    }
+
+    const size_t start = (*offset < SIM_TELEMETRY_FILE_HEADER_BYTES) ? SIM_TELEMETRY_FILE_HEADER_BYTES : *offset;
+    if ((start + TELEMETRY_DIR_END) > reader->map.size)
+    {
+        return false;
+    }
+
+    const uint8_t *data = reader->map.data + start;
+    const size_t bytes = sim_get_u32(data + 16);
+    if ((sim_get_u32(data) != SIM_TELEMETRY_BLOCK_MAGIC) || (bytes < TELEMETRY_DIR_END)
+        || (bytes > (reader->map.size - start)) || (sim_get_u32(data + 4) > SIM_TELEMETRY_BLOCK_ROWS))
+    {
+        return false;
+    }
+
+    block->data = data;
+    block->bytes = bytes;
+    block->rows = sim_get_u32(data + 4);
+    block->first_row = sim_get_u64(data + 8);
+    *offset = start + bytes;
+    return true;
+}
+
+void sim_telemetry_block_range(const SimTelemetryBlock *block, SimTelemetryDouble signal, double *min, double *max)
+{
+    if ((block == NULL) || ((unsigned)signal >= SIM_TELEMETRY_DOUBLE_COUNT))
+    {
+        return;
+    }
+
+    const uint8_t *dir = block->data + TELEMETRY_BLOCK_HEADER_BYTES + ((unsigned)signal * TELEMETRY_DOUBLE_DIR_BYTES);
+    if (min != NULL)
+    {
+        *min = sim_get_f64(dir);
+    }
+    if (max != NULL)
+    {
+        *max = sim_get_f64(dir + 8);
+    }
+}
+
+static bool telemetry_column_bytes(const SimTelemetryBlock *block, const uint8_t *dir_entry,
+    TelemetryBitReader *reader)
+{
+    const size_t offset = sim_get_u32(dir_entry);
+    const size_t bytes = sim_get_u32(dir_entry + 4);
+    if ((offset > block->bytes) || (bytes > (block->bytes - offset)))
+    {
+        return false;
+    }
+
+    reader->in = block->data + offset;
+    reader->size = bytes;
+    reader->pos = 0U;
+    reader->acc = 0U;
+    reader->bits = 0U;
+    return true;
+}
+
+bool sim_telemetry_decode_double(const SimTelemetryBlock *block, SimTelemetryDouble signal, double *out)
+{
+    if ((block == NULL) || (out == NULL) || ((unsigned)signal >= SIM_TELEMETRY_DOUBLE_COUNT))
+    {
+        return false;
+    }
+    if (block->rows == 0U)
+    {
+        return true;
+    }
+
+    const uint8_t *dir = block->data + TELEMETRY_BLOCK_HEADER_BYTES + ((unsigned)signal * TELEMETRY_DOUBLE_DIR_BYTES);
+    TelemetryBitReader reader;
+    if (!telemetry_column_bytes(block, dir + 16, &reader))
+    {
+        memset(out, 0, block->rows * sizeof(double));
+        return false;
+    }
+
+    uint64_t previous = bits_get_wide(&reader, 64U);
+    memcpy(&out[0], &previous, sizeof(double));
+    unsigned lead = 0U;
+    unsigned trail = 0U;
+    for (uint32_t i = 1U; i < block->rows; ++i)
+    {
+        if (bits_get(&reader, 1U) != 0U)
+        {
+            unsigned significant = 64U - lead - trail;
+            if (bits_get(&reader, 1U) != 0U)
+            {
+                lead = (unsigned)bits_get(&reader, 5U);
+                significant = (unsigned)bits_get(&reader, 6U);
+                significant = (significant == 0U) ? 64U : significant;
+                if ((lead + significant) > 64U)
+                {
+                    /* Only a corrupt file gets here; the shift below would be undefined. */
+                    memset(out, 0, block->rows * sizeof(double));
+                    return false;
+                }
+                trail = 64U - lead - significant;
+            }
+            previous ^= bits_get_wide(&reader, significant) << trail;
+        }
+        memcpy(&out[i], &previous, sizeof(double));
+    }
+    return true;
+}
+
+bool sim_telemetry_decode_small(const SimTelemetryBlock *block, SimTelemetrySmall signal, uint8_t *out)
+{
+    if ((block == NULL) || (out == NULL) || ((unsigned)signal >= SIM_TELEMETRY_SMALL_COUNT))
+    {
+        return false;
+    }
+
+    const uint8_t *dir = block->data + TELEMETRY_BLOCK_HEADER_BYTES
+        + (SIM_TELEMETRY_DOUBLE_COUNT * TELEMETRY_DOUBLE_DIR_BYTES) + ((unsigned)signal * TELEMETRY_SMALL_DIR_BYTES);
+    TelemetryBitReader reader;
+    const unsigned width = dir[2];
+    if ((width > TELEMETRY_SMALL_BITS[signal]) || !telemetry_column_bytes(block, dir + 4, &reader))
+    {
+        memset(out, 0, block->rows);
+        return false;
+    }
+
+    for (uint32_t i = 0U; i < block->rows; ++i)
+    {
+        out[i] = (uint8_t)bits_get(&reader, width);
+    }
+    return true;
+}
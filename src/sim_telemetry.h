@@ -0,0 +1,157 @@
+#ifndef SIM_TELEMETRY_H
+#define SIM_TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sim.h"
+#include "sim_fleet.h"
+#include "sys_file.h"
+#include "sys_thread.h"
+
+/*
+ * Columnar telemetry stream. Rows (one per vehicle per tick) are staged column by
+ * column and encoded SIM_TELEMETRY_BLOCK_ROWS at a time into self-describing
+ * blocks. Doubles are XOR-encoded against the previous row (Gorilla style), bools
+ * and the small enums are bit-packed, and each block header carries the byte range
+ * and min/max of every column so readers can skip what they do not need.
+ *
+ * Version 2 appends a sparse time index on close: one 32-byte entry per block
+ * (file offset, first row, runtime_s min/max) followed by a 16-byte trailer, so
+ * a reader can binary-search a timestamp without touching the blocks. Files
+ * without the trailer (version 1, or a recording that never closed) are indexed
+ * by scanning block headers at open.
+ *
+ * Staging is double-buffered: a full block is handed to an encoder thread and the
+ * caller keeps appending into the other set of columns, so the stepping loop only
+ * pays for copying a row.
+ */
+#define SIM_TELEMETRY_MAGIC 0x4D4C4554U /* "TELM" */
+#define SIM_TELEMETRY_BLOCK_MAGIC 0x4B4C4254U /* "TBLK" */
+#define SIM_TELEMETRY_INDEX_MAGIC 0x58444954U /* "TIDX" */
+#define SIM_TELEMETRY_VERSION 2U
+#define SIM_TELEMETRY_INDEX_ENTRY_BYTES 32U
+#define SIM_TELEMETRY_INDEX_TRAILER_BYTES 16U
+#define SIM_TELEMETRY_BLOCK_ROWS 4096U
+#define SIM_TELEMETRY_FILE_HEADER_BYTES 16U
+
+typedef enum
+{
+    SIM_TELEMETRY_VELOCITY_KMH = 0,
+    SIM_TELEMETRY_THROTTLE_PCT,
+    SIM_TELEMETRY_BRAKE_PCT,
+    SIM_TELEMETRY_RPM,
+    SIM_TELEMETRY_FUEL_PCT,
+    SIM_TELEMETRY_RUNTIME_S,
+    SIM_TELEMETRY_CABIN_TEMP_C,
+    SIM_TELEMETRY_SETPOINT_C,
+    SIM_TELEMETRY_OUTSIDE_TEMP_C,
+    SIM_TELEMETRY_DOUBLE_COUNT
+} SimTelemetryDouble;
+
+typedef enum
+{
+    SIM_TELEMETRY_LEFT_ENABLED = 0,
+    SIM_TELEMETRY_RIGHT_ENABLED,
+    SIM_TELEMETRY_HAZARD_ENABLED,
+    SIM_TELEMETRY_HEADLIGHT_ON,
+    SIM_TELEMETRY_BLINK_ON,
+    SIM_TELEMETRY_AC_ON,
+    SIM_TELEMETRY_AUTO_MODE,
+    SIM_TELEMETRY_RECIRCULATION_ON,
+    SIM_TELEMETRY_DEFROST_ON,
+    SIM_TELEMETRY_ENGINE_WARM,
+    SIM_TELEMETRY_AIRFLOW_MODE,
+    SIM_TELEMETRY_FAN_LEVEL,
+    SIM_TELEMETRY_SMALL_COUNT
+} SimTelemetrySmall;
+
+typedef struct
+{
+    FILE *file;
+    void *storage;
+    /* Columns being filled by the appending thread. */
+    double *doubles[SIM_TELEMETRY_DOUBLE_COUNT];
+    uint8_t *smalls[SIM_TELEMETRY_SMALL_COUNT];
+    /* Columns owned by the encoder while a block is in flight. */
+    double *spare_doubles[SIM_TELEMETRY_DOUBLE_COUNT];
+    uint8_t *spare_smalls[SIM_TELEMETRY_SMALL_COUNT];
+    uint8_t *encoded;
+    uint32_t rows_per_tick;
+    uint32_t staged;
+    uint64_t rows_flushed;
+
+    SysThread encoder;
+    SysMutex lock;
+    SysCond cond;
+    uint32_t job_rows;
+    uint64_t job_first_row;
+    bool job_pending;
+    bool stopping;
+    /* Seconds the appending thread waited for the encoder (0 unless it falls behind). */
+    double stall_s;
+
+    /* Written by the encoder; stable after sim_telemetry_close(). */
+    uint64_t bytes_written;
+    uint64_t blocks;
+    bool failed;
+    uint8_t *index;
+    size_t index_capacity;
+} SimTelemetryWriter;
+
+/* rows_per_tick is 1 for a single vehicle or the fleet size; all memory is allocated here. */
+bool sim_telemetry_open(SimTelemetryWriter *writer, const char *path, uint32_t rows_per_tick);
+/* Flushes the partial block and closes; false if any write failed. */
+bool sim_telemetry_close(SimTelemetryWriter *writer);
+/* Appends one row; O(1) apart from encoding a block every SIM_TELEMETRY_BLOCK_ROWS rows. */
+void sim_telemetry_append(SimTelemetryWriter *writer, const SimState *state);
+/* Appends vehicles [begin, end) of a fleet as consecutive rows, copying whole column runs. */
+void sim_telemetry_append_fleet(SimTelemetryWriter *writer, const SimFleet *fleet, size_t begin, size_t end);
+
+typedef struct
+{
+    SysFileMap map;
+    uint32_t rows_per_tick;
+    /* Index entries in file layout: mapped from the footer or built by scanning. */
+    const uint8_t *index;
+    size_t block_count;
+    void *owned_index;
+} SimTelemetryReader;
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t bytes;
+    uint32_t rows;
+    uint64_t first_row;
+} SimTelemetryBlock;
+
+bool sim_telemetry_reader_open(SimTelemetryReader *reader, const char *path);
+void sim_telemetry_reader_close(SimTelemetryReader *reader);
+/* Walks blocks in file order; start with *offset = 0. False at the end or on corruption. */
+bool sim_telemetry_next_block(const SimTelemetryReader *reader, size_t *offset, SimTelemetryBlock *block);
+size_t sim_telemetry_block_count(const SimTelemetryReader *reader);
+bool sim_telemetry_block_at(const SimTelemetryReader *reader, size_t block_index, SimTelemetryBlock *block);
+/* runtime_s covered by a block, straight from the index. */
+void sim_telemetry_block_time(const SimTelemetryReader *reader, size_t block_index, double *t_min, double *t_max);
+/* Binary search: first block whose runtime_s reaches t_s (the last block if none). */
+size_t sim_telemetry_find_time(const SimTelemetryReader *reader, double t_s);
+void sim_telemetry_block_range(const SimTelemetryBlock *block, SimTelemetryDouble signal, double *min, double *max);
+/*
+ * Decode one column of a block into out[0 .. block->rows). False (and a zeroed
+ * column) when the column's bounds, bit widths or XOR windows are corrupt.
+ */
+bool sim_telemetry_decode_double(const SimTelemetryBlock *block, SimTelemetryDouble signal, double *out);
+bool sim_telemetry_decode_small(const SimTelemetryBlock *block, SimTelemetrySmall signal, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_TELEMETRY_H */
@@ -0,0 +1,66 @@
+#include "sim_triple.h"
+
+#include <stddef.h>
+
+#define SIM_TRIPLE_INDEX_MASK 0x3
+#define SIM_TRIPLE_FRESH 0x4
+
+void sim_triple_init(SimTripleBuffer *buffer, const SimFrame *initial)
+{
+    if ((buffer == NULL) || (initial == NULL))
+    {
+        return;
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        buffer->slots[i] = *initial;
+    }
+    buffer->write_index = 0;
+    buffer->read_index = 2;
+    sys_atomic_init(&buffer->middle, 1);
+}
+
+SimFrame *sim_triple_write_slot(SimTripleBuffer *buffer)
+{
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+
+    return &buffer->slots[buffer->write_index];
+}
+
+void sim_triple_publish(SimTripleBuffer *buffer)
+{
+    if (buffer == NULL)
+    {
+        return;
+    }
+
+    /* acq_rel exchange: the slot contents happen-before the reader's swap. */
+    const int64_t previous = sys_atomic_exchange(&buffer->middle, buffer->write_index | SIM_TRIPLE_FRESH);
+    buffer->write_index = (int)(previous & SIM_TRIPLE_INDEX_MASK);
+}
+
+const SimFrame *sim_triple_acquire(SimTripleBuffer *buffer, bool *fresh)
+{
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+
+    bool updated = false;
+    if ((sys_atomic_load_acquire(&buffer->middle) & SIM_TRIPLE_FRESH) != 0)
+    {
+        const int64_t previous = sys_atomic_exchange(&buffer->middle, buffer->read_index);
+        buffer->read_index = (int)(previous & SIM_TRIPLE_INDEX_MASK);
+        updated = true;
+    }
+
+    if (fresh != NULL)
+    {
+        *fresh = updated;
+    }
+    return &buffer->slots[buffer->read_index];
+}
@@ -0,0 +1,54 @@
+#ifndef SIM_TRIPLE_H
+#define SIM_TRIPLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sim.h"
+#include "sys_atomic.h"
+
+/* One published simulation step: the two states a renderer interpolates between. */
+typedef struct
+{
+    SimState previous;
+    SimState current;
+    double step_s;
+    /* sys_time_seconds() at which current became the simulation's present. */
+    double current_time_s;
+    /* time_s of the newest command applied to current; 0 before the first. */
+    double input_time_s;
+    uint64_t sequence;
+} SimFrame;
+
+/*
+ * Lock-free single-producer / single-consumer triple buffer. The writer fills its
+ * private slot and swaps it with the shared middle slot; the reader swaps its own
+ * slot with the middle one only when the fresh bit says something new arrived.
+ * Neither side ever waits: the writer overwrites frames the reader skipped and the
+ * reader keeps the last frame it saw until a new one is published.
+ */
+typedef struct
+{
+    SimFrame slots[3];
+    /* Index of the middle slot in bits 0-1, SIM_TRIPLE_FRESH when unread. */
+    SysAtomicI64 middle;
+    int write_index;
+    int read_index;
+} SimTripleBuffer;
+
+void sim_triple_init(SimTripleBuffer *buffer, const SimFrame *initial);
+/* Writer side: slot to fill before sim_triple_publish(). */
+SimFrame *sim_triple_write_slot(SimTripleBuffer *buffer);
+void sim_triple_publish(SimTripleBuffer *buffer);
+/* Reader side: latest frame; *fresh tells whether it changed since the last call. */
+const SimFrame *sim_triple_acquire(SimTripleBuffer *buffer, bool *fresh);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_TRIPLE_H */
@@ -0,0 +1,121 @@
+#ifndef SYS_ATOMIC_H
+#define SYS_ATOMIC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Minimal 64-bit atomic integer. C11 <stdatomic.h> everywhere it exists; MSVC's C
+ * front end has no _Atomic, so there the same operations map onto Interlocked
+ * intrinsics (x86/x64 loads and stores already carry acquire/release ordering, so
+ * only a compiler barrier is needed for those).
+ */
+#if defined(_MSC_VER) && !defined(__clang__)
+
+#include <intrin.h>
+
+typedef struct
+{
+    volatile __int64 value;
+} SysAtomicI64;
+
+static inline void sys_atomic_init(SysAtomicI64 *atom, int64_t value)
+{
+    atom->value = value;
+}
+
+static inline int64_t sys_atomic_load_relaxed(const SysAtomicI64 *atom)
+{
+    return atom->value;
+}
+
+static inline int64_t sys_atomic_load_acquire(const SysAtomicI64 *atom)
+{
+    const int64_t value = atom->value;
+    _ReadWriteBarrier();
+    return value;
+}
+
+static inline void sys_atomic_store_release(SysAtomicI64 *atom, int64_t value)
+{
+    _ReadWriteBarrier();
+    atom->value = value;
+}
+
+static inline int64_t sys_atomic_fetch_add(SysAtomicI64 *atom, int64_t delta)
+{
+    return _InterlockedExchangeAdd64(&atom->value, delta);
+}
+
+static inline int64_t sys_atomic_exchange(SysAtomicI64 *atom, int64_t value)
+{
+    return _InterlockedExchange64(&atom->value, value);
+}
+
+static inline bool sys_atomic_compare_exchange(SysAtomicI64 *atom, int64_t *expected, int64_t desired)
+{
+    const int64_t previous = _InterlockedCompareExchange64(&atom->value, desired, *expected);
+    if (previous == *expected)
+    {
+        return true;
+    }
+    *expected = previous;
+    return false;
+}
+
+#else
+
+#include <stdatomic.h>
+
+typedef struct
+{
+    _Atomic int64_t value;
+} SysAtomicI64;
+
+static inline void sys_atomic_init(SysAtomicI64 *atom, int64_t value)
+{
+    atomic_init(&atom->value, value);
+}
+
+static inline int64_t sys_atomic_load_relaxed(const SysAtomicI64 *atom)
+{
+    return atomic_load_explicit((_Atomic int64_t *)&atom->value, memory_order_relaxed);
+}
+
+static inline int64_t sys_atomic_load_acquire(const SysAtomicI64 *atom)
+{
+    return atomic_load_explicit((_Atomic int64_t *)&atom->value, memory_order_acquire);
+}
+
+static inline void sys_atomic_store_release(SysAtomicI64 *atom, int64_t value)
+{
+    atomic_store_explicit(&atom->value, value, memory_order_release);
+}
+
+static inline int64_t sys_atomic_fetch_add(SysAtomicI64 *atom, int64_t delta)
+{
+    return atomic_fetch_add_explicit(&atom->value, delta, memory_order_acq_rel);
+}
+
+static inline int64_t sys_atomic_exchange(SysAtomicI64 *atom, int64_t value)
+{
+    return atomic_exchange_explicit(&atom->value, value, memory_order_acq_rel);
+}
+
+static inline bool sys_atomic_compare_exchange(SysAtomicI64 *atom, int64_t *expected, int64_t desired)
+{
+    return atomic_compare_exchange_strong_explicit(&atom->value, expected, desired,
+        memory_order_acq_rel, memory_order_acquire);
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYS_ATOMIC_H */
@@ -0,0 +1,137 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "sys_file.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+bool sys_file_map(SysFileMap *map, const char *path)
+{
+    if ((map == NULL) || (path == NULL))
+    {
+        return false;
+    }
+
+    map->data = NULL;
+    map->size = 0U;
+    map->mapping = NULL;
+    map->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (map->file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(map->file, &size) || (size.QuadPart == 0))
+    {
+        CloseHandle(map->file);
+        return false;
+    }
+
+    map->mapping = CreateFileMappingA(map->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (map->mapping == NULL)
+    {
+        CloseHandle(map->file);
+        return false;
+    }
+
+    map->data = (const uint8_t *)MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (map->data == NULL)
+    {
+        CloseHandle(map->mapping);
+        CloseHandle(map->file);
+        return false;
+    }
+    map->size = (size_t)size.QuadPart;
+    return true;
+}
+
+void sys_file_unmap(SysFileMap *map)
+{
+    if ((map == NULL) || (map->data == NULL))
+    {
+        return;
+    }
+
+    UnmapViewOfFile(map->data);
+    CloseHandle(map->mapping);
+    CloseHandle(map->file);
+    map->data = NULL;
+    map->size = 0U;
+}
+
+void sys_file_advise_sequential(const SysFileMap *map)
+{
+    /* FILE_FLAG_SEQUENTIAL_SCAN at open time already covers this. */
+    (void)map;
+}
+
+#else
+
+bool sys_file_map(SysFileMap *map, const char *path)
+{
+    if ((map == NULL) || (path == NULL))
+    {
+        return false;
+    }
+
+    map->data = NULL;
+    map->size = 0U;
+    map->fd = open(path, O_RDONLY);
+    if (map->fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if ((fstat(map->fd, &info) != 0) || (info.st_size <= 0))
+    {
+        (void)close(map->fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, map->fd, 0);
+    if (data == MAP_FAILED)
+    {
+        (void)close(map->fd);
+        return false;
+    }
+
+    map->data = (const uint8_t *)data;
+    map->size = (size_t)info.st_size;
+    return true;
+}
+
+void sys_file_unmap(SysFileMap *map)
+{
+    if ((map == NULL) || (map->data == NULL))
+    {
+        return;
+    }
+
+    (void)munmap((void *)map->data, map->size);
+    (void)close(map->fd);
+    map->data = NULL;
+    map->size = 0U;
+}
+
+void sys_file_advise_sequential(const SysFileMap *map)
+{
+    if ((map == NULL) || (map->data == NULL))
+    {
+        return;
+    }
+
+    (void)posix_madvise((void *)map->data, map->size, POSIX_MADV_SEQUENTIAL);
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef SYS_FILE_H
+#define SYS_FILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+/* Read-only memory mapping of a whole file; pages are faulted in on demand. */
+typedef struct
+{
+    const uint8_t *data;
+    size_t size;
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+} SysFileMap;
+
+bool sys_file_map(SysFileMap *map, const char *path);
+void sys_file_unmap(SysFileMap *map);
+/* Tells the OS the mapping will be read front to back (read-ahead, early eviction). */
+void sys_file_advise_sequential(const SysFileMap *map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYS_FILE_H */
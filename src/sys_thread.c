@@ -0,0 +1,250 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "sys_thread.h"
+
+#include <stddef.h>
+
+#if !defined(_WIN32)
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+static DWORD WINAPI sys_thread_trampoline(LPVOID param)
+{
+    SysThread *thread = (SysThread *)param;
+    thread->fn(thread->arg);
+    return 0;
+}
+
+bool sys_thread_start(SysThread *thread, SysThreadFn fn, void *arg)
+{
+    if ((thread == NULL) || (fn == NULL))
+    {
+        return false;
+    }
+
+    thread->fn = fn;
+    thread->arg = arg;
+    thread->handle = CreateThread(NULL, 0, sys_thread_trampoline, thread, 0, NULL);
+    thread->started = (thread->handle != NULL);
+    return thread->started;
+}
+
+void sys_thread_join(SysThread *thread)
+{
+    if ((thread == NULL) || !thread->started)
+    {
+        return;
+    }
+
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    thread->handle = NULL;
+    thread->started = false;
+}
+
+void sys_thread_yield(void)
+{
+    (void)SwitchToThread();
+}
+
+void sys_sleep_seconds(double seconds)
+{
+    if (seconds <= 0.0)
+    {
+        return;
+    }
+    Sleep((DWORD)(seconds * 1000.0));
+}
+
+unsigned sys_cpu_count(void)
+{
+    const DWORD count = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+    return (count > 0U) ? (unsigned)count : 1U;
+}
+
+void sys_mutex_init(SysMutex *mutex)
+{
+    InitializeSRWLock(&mutex->lock);
+}
+
+void sys_mutex_destroy(SysMutex *mutex)
+{
+    (void)mutex;
+}
+
+void sys_mutex_lock(SysMutex *mutex)
+{
+    AcquireSRWLockExclusive(&mutex->lock);
+}
+
+void sys_mutex_unlock(SysMutex *mutex)
+{
+    ReleaseSRWLockExclusive(&mutex->lock);
+}
+
+void sys_cond_init(SysCond *cond)
+{
+    InitializeConditionVariable(&cond->cond);
+}
+
+void sys_cond_destroy(SysCond *cond)
+{
+    (void)cond;
+}
+
+void sys_cond_wait(SysCond *cond, SysMutex *mutex)
+{
+    (void)SleepConditionVariableSRW(&cond->cond, &mutex->lock, INFINITE, 0);
+}
+
+bool sys_cond_wait_seconds(SysCond *cond, SysMutex *mutex, double seconds)
+{
+    const DWORD ms = (seconds > 0.0) ? (DWORD)(seconds * 1000.0) : 0U;
+    return SleepConditionVariableSRW(&cond->cond, &mutex->lock, ms, 0) != FALSE;
+}
+
+void sys_cond_broadcast(SysCond *cond)
+{
+    WakeAllConditionVariable(&cond->cond);
+}
+
+double sys_time_seconds(void)
+{
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER counter;
+    if ((freq.QuadPart == 0) && !QueryPerformanceFrequency(&freq))
+    {
+        return (double)GetTickCount64() / 1000.0;
+    }
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)freq.QuadPart;
+}
+
+#else
+
+static void *sys_thread_trampoline(void *param)
+{
+    SysThread *thread = (SysThread *)param;
+    thread->fn(thread->arg);
+    return NULL;
+}
+
+bool sys_thread_start(SysThread *thread, SysThreadFn fn, void *arg)
+{
+    if ((thread == NULL) || (fn == NULL))
+    {
+        return false;
+    }
+
+    thread->fn = fn;
+    thread->arg = arg;
+    thread->started = (pthread_create(&thread->handle, NULL, sys_thread_trampoline, thread) == 0);
+    return thread->started;
+}
+
+void sys_thread_join(SysThread *thread)
+{
+    if ((thread == NULL) || !thread->started)
+    {
+        return;
+    }
+
+    (void)pthread_join(thread->handle, NULL);
+    thread->started = false;
+}
+
+void sys_thread_yield(void)
+{
+    (void)sched_yield();
+}
+
+void sys_sleep_seconds(double seconds)
+{
+    if (seconds <= 0.0)
+    {
+        return;
+    }
+
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - (double)ts.tv_sec) * 1e9);
+    (void)nanosleep(&ts, NULL);
+}
+
+unsigned sys_cpu_count(void)
+{
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (unsigned)count : 1U;
+}
+
+void sys_mutex_init(SysMutex *mutex)
+{
+    (void)pthread_mutex_init(&mutex->lock, NULL);
+}
+
+void sys_mutex_destroy(SysMutex *mutex)
+{
+    (void)pthread_mutex_destroy(&mutex->lock);
+}
+
+void sys_mutex_lock(SysMutex *mutex)
+{
+    (void)pthread_mutex_lock(&mutex->lock);
+}
+
+void sys_mutex_unlock(SysMutex *mutex)
+{
+    (void)pthread_mutex_unlock(&mutex->lock);
+}
+
+void sys_cond_init(SysCond *cond)
+{
+    (void)pthread_cond_init(&cond->cond, NULL);
+}
+
+void sys_cond_destroy(SysCond *cond)
+{
+    (void)pthread_cond_destroy(&cond->cond);
+}
+
+void sys_cond_wait(SysCond *cond, SysMutex *mutex)
+{
+    (void)pthread_cond_wait(&cond->cond, &mutex->lock);
+}
+
+bool sys_cond_wait_seconds(SysCond *cond, SysMutex *mutex, double seconds)
+{
+    /* pthread_cond_timedwait takes an absolute CLOCK_REALTIME deadline. */
+    struct timespec deadline;
+    (void)clock_gettime(CLOCK_REALTIME, &deadline);
+    const double wait_s = (seconds > 0.0) ? seconds : 0.0;
+    const time_t whole_s = (time_t)wait_s;
+    deadline.tv_sec += whole_s;
+    deadline.tv_nsec += (long)((wait_s - (double)whole_s) * 1e9);
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return pthread_cond_timedwait(&cond->cond, &mutex->lock, &deadline) == 0;
+}
+
+void sys_cond_broadcast(SysCond *cond)
+{
+    (void)pthread_cond_broadcast(&cond->cond);
+}
+
+double sys_time_seconds(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+#endif
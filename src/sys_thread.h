@@ -0,0 +1,79 @@
+#ifndef SYS_THREAD_H
+#define SYS_THREAD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/* Thin portability layer over Win32 and POSIX threads for the headless core. */
+
+typedef void (*SysThreadFn)(void *arg);
+
+typedef struct
+{
+#if defined(_WIN32)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    SysThreadFn fn;
+    void *arg;
+    bool started;
+} SysThread;
+
+typedef struct
+{
+#if defined(_WIN32)
+    SRWLOCK lock;
+#else
+    pthread_mutex_t lock;
+#endif
+} SysMutex;
+
+typedef struct
+{
+#if defined(_WIN32)
+    CONDITION_VARIABLE cond;
+#else
+    pthread_cond_t cond;
+#endif
+} SysCond;
+
+bool sys_thread_start(SysThread *thread, SysThreadFn fn, void *arg);
+void sys_thread_join(SysThread *thread);
+void sys_thread_yield(void);
+/* Coarse sleep; Win32 rounds down to whole milliseconds of the system tick. */
+void sys_sleep_seconds(double seconds);
+unsigned sys_cpu_count(void);
+
+void sys_mutex_init(SysMutex *mutex);
+void sys_mutex_destroy(SysMutex *mutex);
+void sys_mutex_lock(SysMutex *mutex);
+void sys_mutex_unlock(SysMutex *mutex);
+
+void sys_cond_init(SysCond *cond);
+void sys_cond_destroy(SysCond *cond);
+void sys_cond_wait(SysCond *cond, SysMutex *mutex);
+/* Waits at most seconds (Win32: whole milliseconds); false on timeout. Wakeups may be spurious. */
+bool sys_cond_wait_seconds(SysCond *cond, SysMutex *mutex, double seconds);
+void sys_cond_broadcast(SysCond *cond);
+
+/* Monotonic clock in seconds; only differences are meaningful. */
+double sys_time_seconds(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYS_THREAD_H */
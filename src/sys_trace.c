@@ -0,0 +1,250 @@
+#include "sys_trace.h"
+
+#if SYS_TRACE
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sys_atomic.h"
+#include "sys_thread.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SYS_TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#define SYS_TRACE_THREAD_LOCAL _Thread_local
+#endif
+
+typedef struct
+{
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+} SysTraceEvent;
+
+typedef struct
+{
+    SysAtomicI64 head;     /* events ever recorded; the ring holds the newest SYS_TRACE_CAPACITY */
+    const char *thread_name;
+    uint64_t base_ticks;   /* clock pair taken at registration, for calibrating ticks */
+    double base_s;
+    unsigned tid;
+    SysTraceEvent events[SYS_TRACE_CAPACITY];
+} SysTraceBuffer;
+
+/* Buffers are published as pointers so a writer never waits for the dump. */
+static SysAtomicI64 sys_trace_slots[SYS_TRACE_MAX_THREADS];
+static SysAtomicI64 sys_trace_thread_count;
+/* Threads turned away because every slot was taken; the first one logs. */
+static SysAtomicI64 sys_trace_refused;
+/* Set by sys_trace_shutdown(); the rings are gone and nothing records again. */
+static SysAtomicI64 sys_trace_closed;
+static SYS_TRACE_THREAD_LOCAL SysTraceBuffer *sys_trace_local;
+static SYS_TRACE_THREAD_LOCAL bool sys_trace_full;
+
+/* Slow path, once per thread: allocate and publish this thread's ring. */
+static SysTraceBuffer *sys_trace_register(uint64_t first_ticks)
+{
+    if (sys_trace_full)
+    {
+        return NULL;
+    }
+
+    const int64_t slot = sys_atomic_fetch_add(&sys_trace_thread_count, 1);
+    SysTraceBuffer *buffer = (slot < (int64_t)SYS_TRACE_MAX_THREADS)
+        ? (SysTraceBuffer *)calloc(1U, sizeof(SysTraceBuffer)) : NULL;
+    if (buffer == NULL)
+    {
+        sys_trace_full = true;
+        if (sys_atomic_fetch_add(&sys_trace_refused, 1) == 0)
+        {
+            if (slot < (int64_t)SYS_TRACE_MAX_THREADS)
+            {
+                fprintf(stderr, "sys_trace: out of memory for a trace ring; thread not traced\n");
+            }
+            else
+            {
+                fprintf(stderr, "sys_trace: all %u thread slots in use; further threads are not traced\n",
+                    (unsigned)SYS_TRACE_MAX_THREADS);
+            }
+        }
+        return NULL;
+    }
+
+    sys_atomic_init(&buffer->head, 0);
+    buffer->base_ticks = first_ticks;
+    buffer->base_s = sys_time_seconds();
+    buffer->tid = (unsigned)slot + 1U;
+    sys_trace_local = buffer;
+    sys_atomic_store_release(&sys_trace_slots[slot], (int64_t)(intptr_t)buffer);
+    return buffer;
+}
+
+void sys_trace_record(const char *name, uint64_t start_ticks)
+{
+    const uint64_t end = sys_trace_now();
+    SysTraceBuffer *buffer = sys_trace_local;
+    if (sys_atomic_load_relaxed(&sys_trace_closed) != 0)
+    {
+        return;
+    }
+    if (buffer == NULL)
+    {
+        buffer = sys_trace_register(start_ticks);
+        if (buffer == NULL)
+        {
+            return;
+        }
+    }
+
+    const int64_t head = sys_atomic_load_relaxed(&buffer->head);
+    SysTraceEvent *event = &buffer->events[(uint64_t)head & (SYS_TRACE_CAPACITY - 1U)];
+    event->name = name;
+    event->start = start_ticks;
+    event->end = end;
+    sys_atomic_store_release(&buffer->head, head + 1);
+}
+
+void sys_trace_thread_name(const char *name)
+{
+    if (sys_atomic_load_relaxed(&sys_trace_closed) != 0)
+    {
+        return;
+    }
+
+    SysTraceBuffer *buffer = (sys_trace_local != NULL) ? sys_trace_local : sys_trace_register(sys_trace_now());
+    if (buffer != NULL)
+    {
+        buffer->thread_name = name;
+    }
+}
+
+/* Writes a name with JSON's mandatory escapes; trace names are plain identifiers in practice. */
+static void sys_trace_write_string(FILE *out, const char *text)
+{
+    fputc('"', out);
+    for (const char *c = text; (c != NULL) && (*c != '\0'); ++c)
+    {
+        if ((*c == '"') || (*c == '\\'))
+        {
+            fputc('\\', out);
+            fputc(*c, out);
+        }
+        else if ((unsigned char)*c < 0x20U)
+        {
+            fputc(' ', out);
+        }
+        else
+        {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+bool sys_trace_write(const char *path)
+{
+    if (path == NULL)
+    {
+        return false;
+    }
+
+    SysTraceBuffer *buffers[SYS_TRACE_MAX_THREADS];
+    size_t count = 0U;
+    for (size_t i = 0U; i < SYS_TRACE_MAX_THREADS; ++i)
+    {
+        SysTraceBuffer *buffer = (SysTraceBuffer *)(intptr_t)sys_atomic_load_acquire(&sys_trace_slots[i]);
+        if (buffer != NULL)
+        {
+            buffers[count++] = buffer;
+        }
+    }
+
+    /* One tick rate for all threads, measured from the oldest registration until now. */
+    uint64_t origin = UINT64_MAX;
+    double origin_s = 0.0;
+    for (size_t i = 0U; i < count; ++i)
+    {
+        if (buffers[i]->base_ticks < origin)
+        {
+            origin = buffers[i]->base_ticks;
+            origin_s = buffers[i]->base_s;
+        }
+    }
+    const uint64_t now_ticks = sys_trace_now();
+    const double span_s = sys_time_seconds() - origin_s;
+    const double us_per_tick = ((count > 0U) && (span_s > 0.0) && (now_ticks > origin))
+        ? ((span_s * 1e6) / (double)(now_ticks - origin)) : 1e-3;
+
+    FILE *out = fopen(path, "w");
+    if (out == NULL)
+    {
+        return false;
+    }
+
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", out);
+    bool first = true;
+    for (size_t i = 0U; i < count; ++i)
+    {
+        const SysTraceBuffer *buffer = buffers[i];
+        if (buffer->thread_name != NULL)
+        {
+            fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+                first ? "" : ",\n", buffer->tid);
+            sys_trace_write_string(out, buffer->thread_name);
+            fputs("}}", out);
+            first = false;
+        }
+
+        const uint64_t head = (uint64_t)sys_atomic_load_acquire(&buffer->head);
+        const uint64_t begin = (head > SYS_TRACE_CAPACITY) ? (head - SYS_TRACE_CAPACITY) : 0U;
+        for (uint64_t n = begin; n < head; ++n)
+        {
+            const SysTraceEvent *event = &buffer->events[n & (SYS_TRACE_CAPACITY - 1U)];
+            if ((event->start < origin) || (event->end < event->start))
+            {
+                continue;
+            }
+            fputs(first ? "{\"name\":" : ",\n{\"name\":", out);
+            sys_trace_write_string(out, event->name);
+            fprintf(out, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", buffer->tid,
+                (double)(event->start - origin) * us_per_tick, (double)(event->end - event->start) * us_per_tick);
+            first = false;
+        }
+    }
+    fputs("\n]}\n", out);
+
+    const bool ok = !ferror(out);
+    return (fclose(out) == 0) && ok;
+}
+
+void sys_trace_shutdown(void)
+{
+    sys_atomic_store_release(&sys_trace_closed, 1);
+    for (size_t i = 0U; i < SYS_TRACE_MAX_THREADS; ++i)
+    {
+        SysTraceBuffer *buffer = (SysTraceBuffer *)(intptr_t)sys_atomic_load_acquire(&sys_trace_slots[i]);
+        sys_atomic_store_release(&sys_trace_slots[i], 0);
+        free(buffer);
+    }
+    sys_trace_local = NULL;
+
+    const int64_t refused = sys_atomic_load_acquire(&sys_trace_refused);
+    if (refused > 0)
+    {
+        fprintf(stderr, "sys_trace: %lld thread(s) were not traced\n", (long long)refused);
+    }
+}
+
+#else
+
+bool sys_trace_write(const char *path)
+{
+    (void)path;
+    return false;
+}
+
+void sys_trace_shutdown(void)
+{
+}
+
+#endif
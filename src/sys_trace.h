@@ -0,0 +1,89 @@
+#ifndef SYS_TRACE_H
+#define SYS_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Scoped trace events written as Chrome trace-event JSON (chrome://tracing,
+ * ui.perfetto.dev). Built only with SYS_TRACE=1 (CMake -DHVAC_TRACE=ON);
+ * otherwise every macro below expands to nothing and no call or clock read
+ * is left in the instrumented code.
+ *
+ * Each thread records into its own ring of the newest SYS_TRACE_CAPACITY
+ * events, created on its first event, so recording takes no lock: a TSC read
+ * at begin, and at end a TSC read plus three stores and a release of the
+ * ring head. Names must be string literals (only the pointer is kept).
+ *
+ *     SYS_TRACE_BEGIN(update_hvac);
+ *     update_hvac(state, dt);
+ *     SYS_TRACE_END(update_hvac);
+ */
+#ifndef SYS_TRACE
+#define SYS_TRACE 0
+#endif
+
+#define SYS_TRACE_CAPACITY (1U << 16)
+#define SYS_TRACE_MAX_THREADS 64U
+
+#if SYS_TRACE
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SYS_TRACE_HAVE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SYS_TRACE_HAVE_TSC 1
+#else
+#include "sys_thread.h"
+#define SYS_TRACE_HAVE_TSC 0
+#endif
+
+/* Timestamp in ticks: the invariant TSC where available, nanoseconds otherwise. */
+static inline uint64_t sys_trace_now(void)
+{
+#if SYS_TRACE_HAVE_TSC
+    return (uint64_t)__rdtsc();
+#else
+    return (uint64_t)(sys_time_seconds() * 1e9);
+#endif
+}
+
+void sys_trace_record(const char *name, uint64_t start_ticks);
+/* Labels the calling thread in the viewer; the name must outlive the trace. */
+void sys_trace_thread_name(const char *name);
+
+#define SYS_TRACE_BEGIN(scope) const uint64_t sys_trace_##scope = sys_trace_now()
+#define SYS_TRACE_END(scope) sys_trace_record(#scope, sys_trace_##scope)
+#define SYS_TRACE_THREAD(name) sys_trace_thread_name(name)
+
+#else
+
+#define SYS_TRACE_BEGIN(scope) ((void)0)
+#define SYS_TRACE_END(scope) ((void)0)
+#define SYS_TRACE_THREAD(name) ((void)0)
+
+#endif
+
+/*
+ * Writes every thread's buffered events to path as JSON. Call it once the
+ * traced threads are idle or joined; a ring still being written may contribute
+ * a torn event. False when tracing is compiled out or the file fails.
+ */
+bool sys_trace_write(const char *path);
+/*
+ * Frees every ring (about 1.5 MB per traced thread) and stops recording for
+ * good; events after it are dropped. Same rule as sys_trace_write(): the
+ * traced threads must be joined or idle. No-op when tracing is compiled out.
+ */
+void sys_trace_shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYS_TRACE_H */
@@ -1,17 +1,32 @@
 #include "ui.h"
 
-#include <math.h>
-#include <stdio.h>
+#include "sys_trace.h"
 
-static HFONT ui_create_font(int height, int weight)
+static HFONT ui_create_font(int height, int weight, DWORD quality)
 {
     return CreateFontW(height, 0, 0, 0, weight, FALSE, FALSE, FALSE,
         DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
-        CLEARTYPE_QUALITY, VARIABLE_PITCH, L"Segoe UI");
+        quality, VARIABLE_PITCH, L"Segoe UI");
 }
 
 static void ui_release_backbuffer(UiState *ui)
 {
+    if (ui->static_dc != NULL)
+    {
+        if (ui->static_bitmap != NULL)
+        {
+            if (ui->static_dc_old != NULL)
+            {
+                SelectObject(ui->static_dc, ui->static_dc_old);
+            }
+            DeleteObject(ui->static_bitmap);
+            ui->static_bitmap = NULL;
+        }
+        DeleteDC(ui->static_dc);
+        ui->static_dc = NULL;
+        ui->static_dc_old = NULL;
+    }
+
     if (ui->back_dc != NULL)
     {
         if (ui->back_bitmap != NULL)
@@ -29,294 +44,431 @@ static void ui_release_backbuffer(UiState *ui)
     }
 }
 
-static double clamp01(double value)
+static UINT ui_text_format(unsigned flags)
 {
-    double result = value;
-    if (result < 0.0)
+    UINT format = DT_LEFT | DT_TOP;
+    if ((flags & UI_TEXT_CENTER) != 0U)
     {
-        result = 0.0;
+        format |= DT_CENTER;
     }
-    else if (result > 1.0)
+    if ((flags & UI_TEXT_RIGHT) != 0U)
     {
-        result = 1.0;
+        format |= DT_RIGHT;
     }
-    else
+    if ((flags & UI_TEXT_VCENTER) != 0U)
     {
-        /* no action */
+        format |= DT_VCENTER;
     }
-    return result;
+    if ((flags & UI_TEXT_BOTTOM) != 0U)
+    {
+        format |= DT_BOTTOM;
+    }
+    if ((flags & UI_TEXT_SINGLELINE) != 0U)
+    {
+        format |= DT_SINGLELINE;
+    }
+    return format;
 }
 
-static double deg_to_rad(double degrees)
+typedef enum
 {
-    return degrees * (3.14159265358979323846 / 180.0);
-}
+    UI_GDI_BRUSH = 1,
+    UI_GDI_PEN,
+    UI_GDI_ROUND_PEN
+} UiGdiStyle;
 
-static int ui_round_to_int(double value)
+static uint64_t ui_gdi_key(UiGdiStyle style, int width, UiColor color)
 {
-    return (int)((value >= 0.0) ? (value + 0.5) : (value - 0.5));
+    return ((uint64_t)style << 48) | ((uint64_t)(uint16_t)width << 24) | (uint64_t)(color & 0xFFFFFFU);
 }
 
-static POINT ui_polar_point(int cx, int cy, int radius, double angle_rad)
+static HGDIOBJ ui_gdi_create(UiGdiStyle style, int width, UiColor color)
 {
-    POINT pt;
-    pt.x = cx + ui_round_to_int(cos(angle_rad) * (double)radius);
-    pt.y = cy - ui_round_to_int(sin(angle_rad) * (double)radius);
-    return pt;
+    if (style == UI_GDI_BRUSH)
+    {
+        return CreateSolidBrush((COLORREF)color);
+    }
+    if (style == UI_GDI_ROUND_PEN)
+    {
+        LOGBRUSH brush;
+        brush.lbStyle = BS_SOLID;
+        brush.lbColor = (COLORREF)color;
+        brush.lbHatch = 0;
+        return ExtCreatePen(PS_GEOMETRIC | PS_ENDCAP_ROUND | PS_JOIN_ROUND, (DWORD)width, &brush, 0, NULL);
+    }
+    return CreatePen(PS_SOLID, width, (COLORREF)color);
 }
 
-static void ui_draw_gauge_band(HDC dc, int cx, int cy, int radius, double start_deg,
-    double sweep_deg, double start_fraction, double end_fraction, COLORREF color, int thickness)
+/*
+ * Cached pen or brush (open addressing, linear probing). When the table is full the object
+ * is created anyway and *temporary tells the caller to delete it after use.
+ */
+static HGDIOBJ ui_gdi_acquire(UiGdiCache *cache, UiGdiStyle style, int width, UiColor color, bool *temporary)
 {
-    if ((dc == NULL) || (radius <= 0) || (thickness <= 0))
+    const uint64_t key = ui_gdi_key(style, width, color);
+    size_t index = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 58) & (UI_GDI_CACHE_SLOTS - 1U);
+    *temporary = false;
+    for (size_t probe = 0U; probe < UI_GDI_CACHE_SLOTS; ++probe)
     {
-        return;
+        UiGdiCacheSlot *slot = &cache->slots[index];
+        if (slot->key == key)
+        {
+            ++cache->hits;
+            return slot->object;
+        }
+        if (slot->key == 0U)
+        {
+            break;
+        }
+        index = (index + 1U) & (UI_GDI_CACHE_SLOTS - 1U);
     }
 
-    const double start_angle = deg_to_rad(start_deg - (start_fraction * sweep_deg));
-    const double end_angle = deg_to_rad(start_deg - (end_fraction * sweep_deg));
-    const POINT start_pt = ui_polar_point(cx, cy, radius, start_angle);
-    const POINT end_pt = ui_polar_point(cx, cy, radius, end_angle);
-
-    LOGBRUSH brush;
-    brush.lbStyle = BS_SOLID;
-    brush.lbColor = color;
-    brush.lbHatch = 0;
-
-    HPEN band_pen = ExtCreatePen(
-        PS_GEOMETRIC | PS_ENDCAP_ROUND | PS_JOIN_ROUND, thickness, &brush, 0, NULL);
-    if (band_pen == NULL)
+    HGDIOBJ object = ui_gdi_create(style, width, color);
+    if (object == NULL)
     {
-        return;
+        return NULL;
     }
+    ++cache->created;
 
-    HGDIOBJ prev_pen = SelectObject(dc, band_pen);
-    Arc(dc, cx - radius, cy - radius, cx + radius, cy + radius,
-        start_pt.x, start_pt.y, end_pt.x, end_pt.y);
-    SelectObject(dc, prev_pen);
-    DeleteObject(band_pen);
+    /* Keep a quarter of the slots free so probes stay short. */
+    if ((cache->count < ((UI_GDI_CACHE_SLOTS * 3U) / 4U)) && (cache->slots[index].key == 0U))
+    {
+        cache->slots[index].key = key;
+        cache->slots[index].object = object;
+        ++cache->count;
+    }
+    else
+    {
+        ++cache->uncached;
+        *temporary = true;
+    }
+    return object;
 }
 
-static void ui_draw_gauge(HDC dc, int cx, int cy, int radius, double value, double min_value,
-    double max_value, const wchar_t *label, const wchar_t *unit, COLORREF accent)
+static void ui_gdi_release(HGDIOBJ object, bool temporary)
 {
-    if (radius <= 0)
+    if (temporary && (object != NULL))
     {
-        return;
+        DeleteObject(object);
     }
+}
+
+static HGDIOBJ ui_acquire_pen(UiGdiCache *cache, const UiDrawCommand *command, bool *temporary)
+{
+    const UiGdiStyle style = ((command->flags & UI_STROKE_ROUND_CAP) != 0U) ? UI_GDI_ROUND_PEN : UI_GDI_PEN;
+    return ui_gdi_acquire(cache, style, command->pen_width, command->pen, temporary);
+}
 
-    const double normalized = clamp01((value - min_value) / (max_value - min_value));
-    const double start_deg = 135.0;
-    const double sweep_deg = 270.0;
-    const double angle_deg = start_deg - (normalized * sweep_deg);
-    const double angle_rad = deg_to_rad(angle_deg);
-    const int inner_radius = radius - 16;
-
-    HPEN ring_pen = CreatePen(PS_SOLID, 3, accent);
-    HBRUSH face_brush = CreateSolidBrush(RGB(25, 25, 25));
-    HPEN tick_pen = CreatePen(PS_SOLID, 1, RGB(180, 180, 180));
-    HPEN needle_pen = CreatePen(PS_SOLID, 4, RGB(220, 80, 50));
-    HBRUSH center_brush = CreateSolidBrush(RGB(40, 40, 40));
-
-    HGDIOBJ prev_pen = SelectObject(dc, ring_pen);
-    HGDIOBJ prev_brush = SelectObject(dc, face_brush);
-    Ellipse(dc, cx - radius, cy - radius, cx + radius, cy + radius);
-
-    const int band_radius = radius - 6;
-    const int band_thickness = 12;
-    const struct
-    {
-        double start_fraction;
-        double end_fraction;
-        COLORREF color;
-    } bands[] = {
-        {0.0, 0.6, RGB(70, 180, 120)},
-        {0.6, 0.85, RGB(230, 200, 120)},
-        {0.85, 1.0, RGB(235, 100, 90)},
-    };
-    for (int i = 0; i < (int)(sizeof(bands) / sizeof(bands[0])); ++i)
-    {
-        ui_draw_gauge_band(dc, cx, cy, band_radius, start_deg, sweep_deg,
-            bands[i].start_fraction, bands[i].end_fraction, bands[i].color, band_thickness);
-    }
-
-    SelectObject(dc, tick_pen);
-    for (int i = 0; i <= 10; ++i)
-    {
-        const double fraction = (double)i / 10.0;
-        const double tick_angle = deg_to_rad(start_deg - (fraction * sweep_deg));
-        const int long_tick = (i % 2 == 0) ? 12 : 6;
-        const int x_outer = cx + (int)(cos(tick_angle) * (radius - 4));
-        const int y_outer = cy - (int)(sin(tick_angle) * (radius - 4));
-        const int x_inner = cx + (int)(cos(tick_angle) * (radius - 4 - long_tick));
-        const int y_inner = cy - (int)(sin(tick_angle) * (radius - 4 - long_tick));
-        MoveToEx(dc, x_inner, y_inner, NULL);
-        LineTo(dc, x_outer, y_outer);
-
-        if ((i % 2) == 0)
+static void ui_gdi_cache_clear(UiGdiCache *cache)
+{
+    for (size_t i = 0U; i < UI_GDI_CACHE_SLOTS; ++i)
+    {
+        if (cache->slots[i].object != NULL)
         {
-            const double label_radius = (double)radius - 32.0;
-            const int label_x = cx + ui_round_to_int(cos(tick_angle) * label_radius);
-            const int label_y = cy - ui_round_to_int(sin(tick_angle) * label_radius);
-            const double tick_value = min_value + (max_value - min_value) * fraction;
-            wchar_t tick_text[16];
-            (void)_snwprintf_s(tick_text, sizeof(tick_text) / sizeof(tick_text[0]),
-                _TRUNCATE, L"%d", ui_round_to_int(tick_value));
-            RECT tick_rect = {label_x - 25, label_y - 12, label_x + 25, label_y + 12};
-            DrawTextW(dc, tick_text, -1, &tick_rect, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+            DeleteObject(cache->slots[i].object);
         }
+        cache->slots[i].key = 0U;
+        cache->slots[i].object = NULL;
     }
+    cache->count = 0U;
+}
 
-    SelectObject(dc, needle_pen);
-    MoveToEx(dc, cx, cy, NULL);
-    const int needle_x = cx + (int)(cos(angle_rad) * inner_radius);
-    const int needle_y = cy - (int)(sin(angle_rad) * inner_radius);
-    LineTo(dc, needle_x, needle_y);
-
-    SelectObject(dc, center_brush);
-    SelectObject(dc, ring_pen);
-    Ellipse(dc, cx - 10, cy - 10, cx + 10, cy + 10);
-
-    SelectObject(dc, prev_pen);
-    SelectObject(dc, prev_brush);
-    DeleteObject(ring_pen);
-    DeleteObject(face_brush);
-    DeleteObject(tick_pen);
-    DeleteObject(needle_pen);
-    DeleteObject(center_brush);
-
-    wchar_t value_text[32];
-    (void)_snwprintf_s(value_text, sizeof(value_text) / sizeof(value_text[0]),
-        _TRUNCATE, L"%0.0f %ls", value, unit);
-    RECT text_rect = {cx - radius, cy + radius - 40, cx + radius, cy + radius};
-    DrawTextW(dc, value_text, -1, &text_rect, DT_CENTER | DT_TOP);
-
-    RECT label_rect = {cx - radius, cy + radius - 70, cx + radius, cy + radius - 40};
-    DrawTextW(dc, label, -1, &label_rect, DT_CENTER | DT_BOTTOM);
+static void ui_execute_text(const UiState *ui, HDC dc, const UiDrawList *list, const UiDrawCommand *command)
+{
+    const HFONT font = (command->font == UI_FONT_LABEL) ? ui->label_font : ui->small_font;
+    if (font != NULL)
+    {
+        SelectObject(dc, font);
+    }
+    SetTextColor(dc, (COLORREF)command->pen);
+
+    wchar_t text[UI_DRAW_TEXT_BYTES];
+    const int length = MultiByteToWideChar(CP_UTF8, 0, ui_draw_command_text(list, command),
+        (int)command->text_length, text, (int)(sizeof(text) / sizeof(text[0])));
+    RECT rect = {command->rect.left, command->rect.top, command->rect.right, command->rect.bottom};
+    DrawTextW(dc, text, length, &rect, ui_text_format(command->flags));
 }
 
-static void ui_draw_fuel(HDC dc, RECT bounds, double fuel_pct)
+static void ui_gdi_atlas_release(UiGdiAtlas *atlas)
 {
-    const double clamped = clamp01(fuel_pct / 100.0);
-    HBRUSH frame_brush = CreateSolidBrush(RGB(60, 60, 60));
-    FrameRect(dc, &bounds, frame_brush);
-    DeleteObject(frame_brush);
-
-    RECT fill_rect = bounds;
-    fill_rect.right = fill_rect.left + (int)((bounds.right - bounds.left) * clamped);
-    HBRUSH fill_brush = CreateSolidBrush(RGB(120, 200, 80));
-    FillRect(dc, &fill_rect, fill_brush);
-    DeleteObject(fill_brush);
-
-    wchar_t text[16];
-    (void)_snwprintf_s(text, sizeof(text) / sizeof(text[0]), _TRUNCATE, L"FUEL %0.0f%%", fuel_pct);
-    DrawTextW(dc, text, -1, &bounds, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+    if (atlas->dc != NULL)
+    {
+        if (atlas->bitmap != NULL)
+        {
+            if (atlas->dc_old != NULL)
+            {
+                SelectObject(atlas->dc, atlas->dc_old);
+            }
+            DeleteObject(atlas->bitmap);
+        }
+        DeleteDC(atlas->dc);
+    }
+    ui_glyph_atlas_destroy(&atlas->glyphs);
+    ZeroMemory(atlas, sizeof(*atlas));
 }
 
-static void ui_draw_indicator(HDC dc, RECT bounds, const wchar_t *label, bool active, COLORREF on_color)
+/*
+ * Renders printable ASCII once, white on black, into a 32bpp DIB and keeps the
+ * green channel as coverage. Grayscale antialiasing: ClearType fringes cannot
+ * be tinted per pixel. Each cell is padded for overhang and fringe pixels.
+ */
+static bool ui_gdi_atlas_build(UiGdiAtlas *atlas, int height, int weight)
 {
-    HBRUSH brush = CreateSolidBrush(active ? on_color : RGB(40, 40, 40));
-    FillRect(dc, &bounds, brush);
-    DeleteObject(brush);
-    FrameRect(dc, &bounds, (HBRUSH)GetStockObject(GRAY_BRUSH));
-    DrawTextW(dc, label, -1, &bounds, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+    ZeroMemory(atlas, sizeof(*atlas));
+    HFONT font = ui_create_font(height, weight, ANTIALIASED_QUALITY);
+    atlas->dc = CreateCompatibleDC(NULL);
+    if ((font == NULL) || (atlas->dc == NULL))
+    {
+        if (font != NULL)
+        {
+            DeleteObject(font);
+        }
+        ui_gdi_atlas_release(atlas);
+        return false;
+    }
+
+    HGDIOBJ old_font = SelectObject(atlas->dc, font);
+    TEXTMETRICW metrics;
+    ZeroMemory(&metrics, sizeof(metrics));
+    (void)GetTextMetricsW(atlas->dc, &metrics);
+    const int pad = 2 + (int)metrics.tmOverhang + ((int)metrics.tmAveCharWidth / 4);
+    int advances[UI_GLYPH_COUNT];
+    int width = 0;
+    for (unsigned i = 0U; i < UI_GLYPH_COUNT; ++i)
+    {
+        const wchar_t ch = (wchar_t)(UI_GLYPH_FIRST + i);
+        SIZE size = {0, 0};
+        (void)GetTextExtentPoint32W(atlas->dc, &ch, 1, &size);
+        advances[i] = (int)size.cx;
+        width += (int)size.cx + (2 * pad);
+    }
+
+    BITMAPINFO info;
+    ZeroMemory(&info, sizeof(info));
+    info.bmiHeader.biSize = sizeof(info.bmiHeader);
+    info.bmiHeader.biWidth = width;
+    info.bmiHeader.biHeight = -(LONG)metrics.tmHeight; /* top-down, rows match the coverage strip */
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+    void *bits = NULL;
+    if (ui_glyph_atlas_create(&atlas->glyphs, width, (int)metrics.tmHeight))
+    {
+        atlas->bitmap = CreateDIBSection(atlas->dc, &info, DIB_RGB_COLORS, &bits, NULL, 0);
+    }
+    if ((atlas->bitmap == NULL) || (bits == NULL))
+    {
+        SelectObject(atlas->dc, old_font);
+        DeleteObject(font);
+        ui_gdi_atlas_release(atlas);
+        return false;
+    }
+    atlas->pixels = (uint32_t *)bits;
+    atlas->dc_old = SelectObject(atlas->dc, atlas->bitmap);
+
+    SetBkMode(atlas->dc, TRANSPARENT);
+    SetTextColor(atlas->dc, RGB(255, 255, 255));
+    int x = 0;
+    for (unsigned i = 0U; i < UI_GLYPH_COUNT; ++i)
+    {
+        UiGlyph *glyph = &atlas->glyphs.glyphs[i];
+        const wchar_t ch = (wchar_t)(UI_GLYPH_FIRST + i);
+        glyph->atlas_x = x;
+        glyph->cell_width = advances[i] + (2 * pad);
+        glyph->left = -pad;
+        glyph->advance = advances[i];
+        glyph->extent = advances[i];
+        (void)TextOutW(atlas->dc, x + pad, 0, &ch, 1);
+        x += glyph->cell_width;
+    }
+    GdiFlush();
+    SelectObject(atlas->dc, old_font);
+    DeleteObject(font);
+
+    const size_t count = (size_t)atlas->glyphs.width * (size_t)atlas->glyphs.height;
+    for (size_t i = 0U; i < count; ++i)
+    {
+        atlas->glyphs.coverage[i] = (uint8_t)((atlas->pixels[i] >> 8) & 0xFFU);
+    }
+    if (!ui_glyph_atlas_finish(&atlas->glyphs))
+    {
+        ui_gdi_atlas_release(atlas);
+        return false;
+    }
+    return true;
 }
 
-static void ui_draw_button(HDC dc, RECT bounds, const wchar_t *label, bool active)
+/* Rewrites the DIB as coverage * color, premultiplied, as AlphaBlend with AC_SRC_ALPHA expects. */
+static void ui_gdi_atlas_tint(UiGdiAtlas *atlas, UiColor color)
 {
-    const COLORREF active_color = RGB(70, 140, 220);
-    const COLORREF inactive_color = RGB(60, 60, 60);
-    HBRUSH brush = CreateSolidBrush(active ? active_color : inactive_color);
-    HPEN pen = CreatePen(PS_SOLID, 1, RGB(120, 120, 120));
-    HGDIOBJ old_pen = SelectObject(dc, pen);
-    HGDIOBJ old_brush = SelectObject(dc, brush);
-    RoundRect(dc, bounds.left, bounds.top, bounds.right, bounds.bottom, 10, 10);
-    SelectObject(dc, old_pen);
-    SelectObject(dc, old_brush);
-    DeleteObject(brush);
-    DeleteObject(pen);
-
-    DrawTextW(dc, label, -1, &bounds, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+    const uint32_t r = color & 0xFFU;
+    const uint32_t g = (color >> 8) & 0xFFU;
+    const uint32_t b = (color >> 16) & 0xFFU;
+    const size_t count = (size_t)atlas->glyphs.width * (size_t)atlas->glyphs.height;
+    for (size_t i = 0U; i < count; ++i)
+    {
+        const uint32_t a = atlas->glyphs.coverage[i];
+        atlas->pixels[i] = (a << 24) | (((r * a) / 255U) << 16) | (((g * a) / 255U) << 8) | ((b * a) / 255U);
+    }
+    GdiFlush();
+    atlas->tint = color;
+    atlas->tinted = true;
 }
 
-static void ui_draw_fan_bars(HDC dc, RECT bounds, int fan_level)
+/* TEXT from the glyph atlas: one AlphaBlend per visible glyph, no font selection or shaping. */
+static bool ui_execute_glyphs(UiState *ui, HDC dc, const UiDrawList *list, const UiDrawCommand *command)
 {
-    const int total_bars = 7;
-    const int bar_spacing = 4;
-    const int bar_width = (bounds.right - bounds.left - ((total_bars - 1) * bar_spacing)) / total_bars;
-    if (bar_width <= 0)
+    UiGdiAtlas *atlas = &ui->atlases[(command->font == UI_FONT_LABEL) ? UI_FONT_LABEL : UI_FONT_SMALL];
+    if (atlas->pixels == NULL)
     {
-        return;
+        return false;
     }
-    int x = bounds.left;
-    for (int i = 0; i < total_bars; ++i)
+    if (!atlas->tinted || (atlas->tint != command->pen))
     {
-        RECT bar = {x, bounds.top, x + bar_width, bounds.bottom};
-        HBRUSH brush = CreateSolidBrush((i < fan_level) ? RGB(255, 170, 70) : RGB(60, 60, 60));
-        FillRect(dc, &bar, brush);
-        DeleteObject(brush);
-        x += bar_width + bar_spacing;
+        ui_gdi_atlas_tint(atlas, command->pen);
+    }
+
+    const char *text = ui_draw_command_text(list, command);
+    int x = 0;
+    int y = 0;
+    ui_text_origin(&atlas->glyphs, command, text, &x, &y);
+
+    const BLENDFUNCTION blend = {AC_SRC_OVER, 0, 255, AC_SRC_ALPHA};
+    for (uint16_t i = 0U; i < command->text_length; ++i)
+    {
+        const UiGlyph *glyph = ui_glyph_lookup(&atlas->glyphs, (unsigned char)text[i]);
+        UiRect dst;
+        int src_x = 0;
+        int src_y = 0;
+        /* DrawText without DT_NOCLIP clips to its rect; cutting each cell keeps that. */
+        if ((glyph->run_count != 0U)
+            && ui_glyph_cell(&atlas->glyphs, glyph, x, y, &command->rect, &dst, &src_x, &src_y))
+        {
+            const int w = dst.right - dst.left;
+            const int h = dst.bottom - dst.top;
+            (void)AlphaBlend(dc, dst.left, dst.top, w, h, atlas->dc, src_x, src_y, w, h, blend);
+        }
+        x += glyph->advance;
     }
+    return true;
 }
 
-static void ui_draw_airflow_icons(HDC dc, RECT bounds, HvacAirflowMode mode)
+/* Clip region = area (if any) narrowed to rect (if non-empty). */
+static void ui_set_clip(HDC dc, const RECT *area, const UiRect *rect)
 {
-    const int icon_width = (bounds.right - bounds.left) / 3;
-    if (icon_width <= 0)
+    SelectClipRgn(dc, NULL);
+    if (area != NULL)
     {
-        return;
+        IntersectClipRect(dc, area->left, area->top, area->right, area->bottom);
+    }
+    if ((rect != NULL) && (rect->right > rect->left) && (rect->bottom > rect->top))
+    {
+        IntersectClipRect(dc, rect->left, rect->top, rect->right, rect->bottom);
     }
-    for (int i = 0; i < 3; ++i)
-    {
-        RECT icon = {bounds.left + i * icon_width + 4, bounds.top + 4,
-            bounds.left + (i + 1) * icon_width - 4, bounds.bottom - 4};
-        const bool active = (i == (int)mode);
-        HBRUSH brush = CreateSolidBrush(active ? RGB(80, 180, 220) : RGB(50, 50, 50));
-        HPEN pen = CreatePen(PS_SOLID, 1, RGB(120, 120, 120));
-        HGDIOBJ old_pen = SelectObject(dc, pen);
-        HGDIOBJ old_brush = SelectObject(dc, brush);
-        RoundRect(dc, icon.left, icon.top, icon.right, icon.bottom, 12, 12);
-        SelectObject(dc, old_pen);
-        SelectObject(dc, old_brush);
-        DeleteObject(brush);
-        DeleteObject(pen);
-
-        HPEN shape_pen = CreatePen(PS_SOLID, 2, RGB(220, 220, 220));
-        HGDIOBJ prev_shape_pen = SelectObject(dc, shape_pen);
-
-        switch (i)
+}
+
+/* GDI backend: replays a display list into dc, touching only area (NULL = everywhere). */
+static void ui_execute(UiState *ui, HDC dc, const UiDrawList *list, const RECT *area)
+{
+    SetBkMode(dc, TRANSPARENT);
+    ui_set_clip(dc, area, NULL);
+
+    for (size_t i = 0U; i < list->count; ++i)
+    {
+        const UiDrawCommand *command = &list->commands[i];
+        const UiRect *r = &command->rect;
+        RECT rect = {r->left, r->top, r->right, r->bottom};
+
+        switch ((UiDrawKind)command->kind)
         {
-            case 0: /* face icon */
+            case UI_CMD_FILL_RECT:
+            case UI_CMD_FRAME_RECT:
             {
-                int cx = (icon.left + icon.right) / 2;
-                int cy = icon.top + (icon.bottom - icon.top) / 3;
-                Ellipse(dc, cx - 8, cy - 8, cx + 8, cy + 8);
-                MoveToEx(dc, cx, cy + 8, NULL);
-                LineTo(dc, cx, icon.bottom - 8);
+                const bool fill = (command->kind == UI_CMD_FILL_RECT);
+                bool temporary;
+                HBRUSH brush = (HBRUSH)ui_gdi_acquire(&ui->gdi_cache, UI_GDI_BRUSH, 0,
+                    fill ? command->fill : command->pen, &temporary);
+                if (brush == NULL)
+                {
+                    break;
+                }
+                if (fill)
+                {
+                    FillRect(dc, &rect, brush);
+                }
+                else
+                {
+                    FrameRect(dc, &rect, brush);
+                }
+                ui_gdi_release(brush, temporary);
                 break;
             }
-            case 1: /* bi-level */
+            case UI_CMD_ROUND_RECT:
+            case UI_CMD_RECTANGLE:
+            case UI_CMD_ELLIPSE:
             {
-                int mid = (icon.top + icon.bottom) / 2;
-                Rectangle(dc, icon.left + 6, icon.top + 6, icon.right - 6, mid - 4);
-                Rectangle(dc, icon.left + 6, mid + 4, icon.right - 6, icon.bottom - 6);
+                bool pen_temporary;
+                bool brush_temporary;
+                HGDIOBJ pen = ui_acquire_pen(&ui->gdi_cache, command, &pen_temporary);
+                HGDIOBJ brush = ui_gdi_acquire(&ui->gdi_cache, UI_GDI_BRUSH, 0, command->fill, &brush_temporary);
+                HGDIOBJ old_pen = SelectObject(dc, pen);
+                HGDIOBJ old_brush = SelectObject(dc, brush);
+                if (command->kind == UI_CMD_ROUND_RECT)
+                {
+                    RoundRect(dc, r->left, r->top, r->right, r->bottom, command->x2, command->y2);
+                }
+                else if (command->kind == UI_CMD_RECTANGLE)
+                {
+                    Rectangle(dc, r->left, r->top, r->right, r->bottom);
+                }
+                else
+                {
+                    Ellipse(dc, r->left, r->top, r->right, r->bottom);
+                }
+                SelectObject(dc, old_pen);
+                SelectObject(dc, old_brush);
+                ui_gdi_release(brush, brush_temporary);
+                ui_gdi_release(pen, pen_temporary);
                 break;
             }
-            case 2: /* foot */
+            case UI_CMD_ARC:
+            case UI_CMD_LINE:
             {
-                int base = icon.bottom - 6;
-                MoveToEx(dc, icon.left + 8, base, NULL);
-                LineTo(dc, icon.right - 8, base);
-                Arc(dc, icon.left + 4, icon.top + 6, icon.right - 4, icon.bottom, icon.left + 4, base, icon.right - 4, base);
+                bool temporary;
+                HGDIOBJ pen = ui_acquire_pen(&ui->gdi_cache, command, &temporary);
+                if (pen == NULL)
+                {
+                    break;
+                }
+                HGDIOBJ old_pen = SelectObject(dc, pen);
+                if (command->kind == UI_CMD_ARC)
+                {
+                    Arc(dc, r->left, r->top, r->right, r->bottom, command->x2, command->y2, command->x3, command->y3);
+                }
+                else
+                {
+                    MoveToEx(dc, r->left, r->top, NULL);
+                    LineTo(dc, r->right, r->bottom);
+                }
+                SelectObject(dc, old_pen);
+                ui_gdi_release(pen, temporary);
                 break;
             }
+            case UI_CMD_TEXT:
+                if (!ui_execute_glyphs(ui, dc, list, command))
+                {
+                    ui_execute_text(ui, dc, list, command);
+                }
+                break;
+            case UI_CMD_CLIP:
+                ui_set_clip(dc, area, r);
+                break;
             default:
                 break;
         }
-
-        SelectObject(dc, prev_shape_pen);
-        DeleteObject(shape_pen);
     }
+
+    SelectClipRgn(dc, NULL);
 }
 
 void ui_init(UiState *ui, HWND hwnd)
@@ -329,10 +481,19 @@ void ui_init(UiState *ui, HWND hwnd)
     ui->back_dc = NULL;
     ui->back_bitmap = NULL;
     ui->back_dc_old = NULL;
+    ui->static_dc = NULL;
+    ui->static_bitmap = NULL;
+    ui->static_dc_old = NULL;
     ui->width = 1;
     ui->height = 1;
-    ui->label_font = ui_create_font(-24, FW_SEMIBOLD);
-    ui->small_font = ui_create_font(-18, FW_NORMAL);
+    ui->label_font = ui_create_font(-24, FW_SEMIBOLD, CLEARTYPE_QUALITY);
+    ui->small_font = ui_create_font(-18, FW_NORMAL, CLEARTYPE_QUALITY);
+    (void)ui_gdi_atlas_build(&ui->atlases[UI_FONT_LABEL], -24, FW_SEMIBOLD);
+    (void)ui_gdi_atlas_build(&ui->atlases[UI_FONT_SMALL], -18, FW_NORMAL);
+    ZeroMemory(&ui->gdi_cache, sizeof(ui->gdi_cache));
+    ui_frame_stats_reset(&ui->frame_stats, true);
+    ui->stats_overlay = false;
+    /* Rendering the static layer here also fills the cache with most pens and brushes. */
     ui_resize(ui, hwnd, 800, 600);
 }
 
@@ -345,6 +506,7 @@ void ui_resize(UiState *ui, HWND hwnd, int width, int height)
 
     ui->width = (width > 0) ? width : 1;
     ui->height = (height > 0) ? height : 1;
+    ui_layout_compute(&ui->layout, ui->width, ui->height);
 
     HDC window_dc = GetDC(hwnd);
     if (window_dc == NULL)
@@ -377,188 +539,121 @@ void ui_resize(UiState *ui, HWND hwnd, int width, int height)
         }
     }
 
+    /* Static layer: everything that only changes with the size, rendered here once. */
+    if (ui->static_dc == NULL)
+    {
+        ui->static_dc = CreateCompatibleDC(window_dc);
+    }
+
+    if (ui->static_dc != NULL)
+    {
+        if (ui->static_bitmap != NULL)
+        {
+            SelectObject(ui->static_dc, ui->static_dc_old);
+            DeleteObject(ui->static_bitmap);
+            ui->static_bitmap = NULL;
+        }
+
+        ui->static_bitmap = CreateCompatibleBitmap(window_dc, ui->width, ui->height);
+        if (ui->static_bitmap != NULL)
+        {
+            HGDIOBJ previous = SelectObject(ui->static_dc, ui->static_bitmap);
+            if (ui->static_dc_old == NULL)
+            {
+                ui->static_dc_old = previous;
+            }
+            ui_build_static_layer(&ui->draw_list, &ui->layout);
+            ui_execute(ui, ui->static_dc, &ui->draw_list, NULL);
+        }
+    }
+
     ReleaseDC(hwnd, window_dc);
 }
 
-static void ui_draw_background(HDC dc, int width, int height)
+static void ui_draw_background(UiState *ui, HDC dc)
 {
-    RECT rect = {0, 0, width, height};
-    HBRUSH bg = CreateSolidBrush(RGB(20, 20, 20));
-    FillRect(dc, &rect, bg);
-    DeleteObject(bg);
+    RECT rect = {0, 0, ui->width, ui->height};
+    bool temporary;
+    HBRUSH bg = (HBRUSH)ui_gdi_acquire(&ui->gdi_cache, UI_GDI_BRUSH, 0, UI_RGB(20, 20, 20), &temporary);
+    if (bg != NULL)
+    {
+        FillRect(dc, &rect, bg);
+        ui_gdi_release(bg, temporary);
+    }
 }
 
-static void ui_draw_panel_outline(HDC dc, RECT bounds)
+/* p50/p99/p99.9/max of every phase, appended to the frame being drawn. */
+static void ui_append_stats_overlay(UiState *ui)
 {
-    HBRUSH brush = CreateSolidBrush(RGB(35, 35, 35));
-    HPEN pen = CreatePen(PS_SOLID, 1, RGB(80, 80, 80));
-    HGDIOBJ old_pen = SelectObject(dc, pen);
-    HGDIOBJ old_brush = SelectObject(dc, brush);
-    RoundRect(dc, bounds.left, bounds.top, bounds.right, bounds.bottom, 20, 20);
-    SelectObject(dc, old_pen);
-    SelectObject(dc, old_brush);
-    DeleteObject(brush);
-    DeleteObject(pen);
+    char text[UI_PHASE_COUNT][96];
+    const char *lines[UI_PHASE_COUNT + 1];
+    lines[0] = ui->frame_stats.enabled ? "frame phases (F3 overlay, F4 dump)" : "frame phases off";
+    for (int phase = 0; phase < (int)UI_PHASE_COUNT; ++phase)
+    {
+        (void)ui_frame_stats_line(&ui->frame_stats, (UiPhase)phase, text[phase], sizeof(text[phase]));
+        lines[phase + 1] = text[phase];
+    }
+    ui_build_text_panel(&ui->draw_list, &ui->layout, lines, UI_PHASE_COUNT + 1U);
 }
 
-void ui_render(UiState *ui, HDC target_dc, const SimState *sim)
+void ui_render(UiState *ui, HDC target_dc, const SimState *sim, const RECT *area)
 {
     if ((ui == NULL) || (target_dc == NULL) || (sim == NULL))
     {
         return;
     }
 
+    const uint64_t created_before = ui->gdi_cache.created;
     if ((ui->back_dc == NULL) || (ui->back_bitmap == NULL))
     {
-        ui_draw_background(target_dc, ui->width, ui->height);
+        ui_draw_background(ui, target_dc);
+        ui->gdi_cache.frame_created = ui->gdi_cache.created - created_before;
         return;
     }
 
-    HDC dc = ui->back_dc;
-    ui_draw_background(dc, ui->width, ui->height);
-
-    if (ui->label_font != NULL)
+    RECT bounds = {0, 0, ui->width, ui->height};
+    if (area != NULL)
     {
-        SelectObject(dc, ui->label_font);
+        bounds.left = (area->left > 0) ? area->left : 0;
+        bounds.top = (area->top > 0) ? area->top : 0;
+        bounds.right = (area->right < ui->width) ? area->right : ui->width;
+        bounds.bottom = (area->bottom < ui->height) ? area->bottom : ui->height;
     }
-    SetBkMode(dc, TRANSPARENT);
-    SetTextColor(dc, RGB(230, 230, 230));
+    if ((bounds.right <= bounds.left) || (bounds.bottom <= bounds.top))
+    {
+        ui->gdi_cache.frame_created = 0U;
+        return;
+    }
+    const int w = bounds.right - bounds.left;
+    const int h = bounds.bottom - bounds.top;
 
-    const int gauge_area_height = ui->height / 2;
-    int gauge_radius = ui->width / 4;
-    const int max_radius = gauge_area_height - 32;
-    if ((max_radius > 0) && (max_radius < gauge_radius))
+    const double draw_start = ui_phase_begin(&ui->frame_stats);
+    if ((ui->static_dc != NULL) && (ui->static_bitmap != NULL))
     {
-        gauge_radius = max_radius;
+        SYS_TRACE_BEGIN(ui_copy_static);
+        BitBlt(ui->back_dc, bounds.left, bounds.top, w, h, ui->static_dc, bounds.left, bounds.top, SRCCOPY);
+        SYS_TRACE_END(ui_copy_static);
+        ui_build_dynamic_layer(&ui->draw_list, &ui->layout, sim);
     }
-    if (gauge_radius < 60)
+    else
     {
-        gauge_radius = 60;
+        ui_build_frame(&ui->draw_list, &ui->layout, sim);
     }
-    const int gauge_center_y = gauge_area_height - 20;
-    const int speed_center_x = ui->width / 4;
-    const int rpm_center_x = (ui->width * 3) / 4;
-
-    ui_draw_gauge(dc, speed_center_x, gauge_center_y, gauge_radius,
-        sim->velocity_kmh, 0.0, 200.0, L"SPEED", L"km/h", RGB(90, 180, 230));
-    ui_draw_gauge(dc, rpm_center_x, gauge_center_y, gauge_radius,
-        sim->rpm, 0.0, 7000.0, L"RPM", L"rpm", RGB(230, 150, 80));
-
-    if (ui->small_font != NULL)
+    if (ui->stats_overlay)
     {
-        SelectObject(dc, ui->small_font);
-    }
-
-    RECT fuel_rect;
-    fuel_rect.left = ui->width / 4;
-    fuel_rect.right = (ui->width * 3) / 4;
-    fuel_rect.top = gauge_area_height;
-    fuel_rect.bottom = fuel_rect.top + 30;
-    ui_draw_fuel(dc, fuel_rect, sim->fuel_pct);
-
-    RECT indicator_area = {ui->width / 2 - 180, 10, ui->width / 2 + 180, 70};
-    const int indicator_width = 90;
-    RECT left_rect = {indicator_area.left, indicator_area.top,
-        indicator_area.left + indicator_width, indicator_area.bottom};
-    RECT hazard_rect = {left_rect.right + 10, indicator_area.top,
-        left_rect.right + 10 + indicator_width, indicator_area.bottom};
-    RECT right_rect = {hazard_rect.right + 10, indicator_area.top,
-        hazard_rect.right + 10 + indicator_width, indicator_area.bottom};
-    RECT headlight_rect = {right_rect.right + 10, indicator_area.top,
-        right_rect.right + 10 + indicator_width, indicator_area.bottom};
-
-    const IndicatorState *ind = &sim->indicators;
-    const bool left_on = (ind->hazard_enabled || ind->left_enabled) && ind->blink_on;
-    const bool right_on = (ind->hazard_enabled || ind->right_enabled) && ind->blink_on;
-    const bool hazard_on = ind->hazard_enabled && ind->blink_on;
-
-    ui_draw_indicator(dc, left_rect, L"LEFT", left_on, RGB(120, 220, 120));
-    ui_draw_indicator(dc, hazard_rect, L"HAZ", hazard_on, RGB(220, 120, 120));
-    ui_draw_indicator(dc, right_rect, L"RIGHT", right_on, RGB(120, 220, 120));
-    ui_draw_indicator(dc, headlight_rect, L"HEAD", ind->headlight_on, RGB(120, 180, 255));
-
-    RECT panel = {20, gauge_area_height + 50, ui->width - 20, ui->height - 20};
-    ui_draw_panel_outline(dc, panel);
-
-    RECT inner = panel;
-    InflateRect(&inner, -20, -20);
-    const int segment_height = (inner.bottom - inner.top) / 3;
-
-    RECT temps_rect = {inner.left, inner.top, inner.right, inner.top + segment_height};
-    RECT fan_rect = {inner.left, temps_rect.bottom + 10, inner.right, temps_rect.bottom + 10 + segment_height / 2};
-    RECT buttons_rect = {inner.left, fan_rect.bottom + 10, inner.right, inner.bottom};
-
-    wchar_t setpoint_text[32];
-    (void)_snwprintf_s(setpoint_text, sizeof(setpoint_text) / sizeof(setpoint_text[0]),
-        _TRUNCATE, L"SET %0.1f C", sim->hvac.setpoint_c);
-    RECT setpoint_rect = temps_rect;
-    setpoint_rect.right = inner.left + (inner.right - inner.left) / 3;
-    DrawTextW(dc, setpoint_text, -1, &setpoint_rect, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
-
-    wchar_t cabin_text[32];
-    (void)_snwprintf_s(cabin_text, sizeof(cabin_text) / sizeof(cabin_text[0]),
-        _TRUNCATE, L"CABIN %0.1f C", sim->hvac.cabin_temp_c);
-    RECT cabin_rect = temps_rect;
-    cabin_rect.left = setpoint_rect.right;
-    cabin_rect.right = cabin_rect.left + (inner.right - inner.left) / 3;
-    DrawTextW(dc, cabin_text, -1, &cabin_rect, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
-
-    wchar_t outside_text[32];
-    (void)_snwprintf_s(outside_text, sizeof(outside_text) / sizeof(outside_text[0]),
-        _TRUNCATE, L"OUT %0.1f C", sim->hvac.outside_temp_c);
-    RECT outside_rect = temps_rect;
-    outside_rect.left = cabin_rect.right;
-    DrawTextW(dc, outside_text, -1, &outside_rect, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
-
-    RECT fan_label_rect = fan_rect;
-    fan_label_rect.bottom = fan_label_rect.top + 24;
-    DrawTextW(dc, L"FAN SPEED", -1, &fan_label_rect, DT_LEFT | DT_VCENTER | DT_SINGLELINE);
-    RECT fan_bar_rect = fan_rect;
-    fan_bar_rect.top = fan_label_rect.bottom + 4;
-    ui_draw_fan_bars(dc, fan_bar_rect, sim->hvac.fan_level);
-
-    RECT airflow_rect = fan_rect;
-    airflow_rect.left = fan_rect.right - 220;
-    airflow_rect.top = fan_label_rect.top;
-    airflow_rect.bottom = fan_rect.bottom;
-    DrawTextW(dc, L"AIRFLOW", -1, &airflow_rect, DT_RIGHT | DT_TOP | DT_SINGLELINE);
-    airflow_rect.top += 20;
-    ui_draw_airflow_icons(dc, airflow_rect, sim->hvac.airflow_mode);
-
-    const int button_width = 100;
-    const int button_height = 40;
-    int button_x = buttons_rect.left;
-    const int button_gap = 12;
-
-    RECT ac_rect = {button_x, buttons_rect.top, button_x + button_width, buttons_rect.top + button_height};
-    ui_draw_button(dc, ac_rect, L"AC", sim->hvac.ac_on);
-    button_x += button_width + button_gap;
-
-    RECT auto_rect = {button_x, buttons_rect.top, button_x + button_width, buttons_rect.top + button_height};
-    ui_draw_button(dc, auto_rect, L"AUTO", sim->hvac.auto_mode);
-    button_x += button_width + button_gap;
-
-    RECT recirc_rect = {button_x, buttons_rect.top, button_x + button_width, buttons_rect.top + button_height};
-    ui_draw_button(dc, recirc_rect, L"RECIRC", sim->hvac.recirculation_on);
-    button_x += button_width + button_gap;
-
-    RECT defrost_rect = {button_x, buttons_rect.top, button_x + button_width, buttons_rect.top + button_height};
-    ui_draw_button(dc, defrost_rect, L"DEF", sim->hvac.defrost_on);
-    button_x += button_width + button_gap;
-
-    RECT mode_rect = {button_x, buttons_rect.top, button_x + button_width, buttons_rect.top + button_height};
-    const wchar_t *mode_label = L"FACE";
-    if (sim->hvac.airflow_mode == HVAC_AIRFLOW_BI_LEVEL)
-    {
-        mode_label = L"BI";
-    }
-    else if (sim->hvac.airflow_mode == HVAC_AIRFLOW_FOOT)
-    {
-        mode_label = L"FOOT";
-    }
-    ui_draw_button(dc, mode_rect, mode_label, true);
-
-    BitBlt(target_dc, 0, 0, ui->width, ui->height, dc, 0, 0, SRCCOPY);
+        ui_append_stats_overlay(ui);
+    }
+    SYS_TRACE_BEGIN(ui_execute);
+    ui_execute(ui, ui->back_dc, &ui->draw_list, &bounds);
+    SYS_TRACE_END(ui_execute);
+    ui_phase_end(&ui->frame_stats, UI_PHASE_DRAW, draw_start);
+
+    const double blit_start = ui_phase_begin(&ui->frame_stats);
+    SYS_TRACE_BEGIN(ui_blit);
+    BitBlt(target_dc, bounds.left, bounds.top, w, h, ui->back_dc, bounds.left, bounds.top, SRCCOPY);
+    SYS_TRACE_END(ui_blit);
+    ui_phase_end(&ui->frame_stats, UI_PHASE_BLIT, blit_start);
+    ui->gdi_cache.frame_created = ui->gdi_cache.created - created_before;
 }
 
 void ui_destroy(UiState *ui)
@@ -578,6 +673,11 @@ void ui_destroy(UiState *ui)
         DeleteObject(ui->small_font);
         ui->small_font = NULL;
     }
+    for (int font = 0; font < (int)UI_FONT_COUNT; ++font)
+    {
+        ui_gdi_atlas_release(&ui->atlases[font]);
+    }
 
     ui_release_backbuffer(ui);
+    ui_gdi_cache_clear(&ui->gdi_cache);
 }
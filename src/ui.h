@@ -8,21 +8,71 @@ extern "C" {
 #include <windows.h>
 
 #include "sim.h"
+#include "ui_draw.h"
+#include "ui_frame_stats.h"
+#include "ui_text.h"
+
+#define UI_GDI_CACHE_SLOTS 64U
+
+/* One cached pen or brush; key packs style, width and color (0 = empty slot). */
+typedef struct
+{
+    uint64_t key;
+    HGDIOBJ object;
+} UiGdiCacheSlot;
+
+/* Pens and brushes kept alive across frames, so steady-state frames create no GDI objects. */
+typedef struct
+{
+    UiGdiCacheSlot slots[UI_GDI_CACHE_SLOTS];
+    size_t count;
+    uint64_t created;       /* objects created since ui_init, cached or not */
+    uint64_t hits;          /* lookups served from the cache */
+    uint64_t uncached;      /* objects created and deleted around one use because the cache was full */
+    uint64_t frame_created; /* objects created by the last ui_render; 0 once warm */
+} UiGdiCache;
+
+/* One font pre-rasterized once: coverage for layout, and a premultiplied 32bpp DIB for AlphaBlend. */
+typedef struct
+{
+    UiGlyphAtlas glyphs;
+    HDC dc;
+    HBITMAP bitmap;
+    HGDIOBJ dc_old;
+    uint32_t *pixels;   /* DIB bits, tinted to tint */
+    UiColor tint;
+    bool tinted;
+} UiGdiAtlas;
 
 typedef struct
 {
     HDC back_dc;
     HBITMAP back_bitmap;
     HGDIOBJ back_dc_old;
+    /* Static layer (ui_build_static_layer), re-rendered only by ui_resize. */
+    HDC static_dc;
+    HBITMAP static_bitmap;
+    HGDIOBJ static_dc_old;
     HFONT label_font;
     HFONT small_font;
+    /* TEXT commands blit from these; DrawTextW is the fallback when one failed to build. */
+    UiGdiAtlas atlases[UI_FONT_COUNT];
+    UiGdiCache gdi_cache;
     int width;
     int height;
+    /* Geometry for width x height, recomputed only by ui_resize. */
+    UiLayout layout;
+    /* Commands of the last layer built (static on resize, dynamic per frame). */
+    UiDrawList draw_list;
+    /* Phase histograms; ui_render feeds draw and blit, the window procedure input and update. */
+    UiFrameStats frame_stats;
+    bool stats_overlay;   /* draw the percentiles over layout.text_panel */
 } UiState;
 
 void ui_init(UiState *ui, HWND hwnd);
 void ui_resize(UiState *ui, HWND hwnd, int width, int height);
-void ui_render(UiState *ui, HDC target_dc, const SimState *sim);
+/* Repaints area (the WM_PAINT update box; NULL = whole window) from the cached static layer. */
+void ui_render(UiState *ui, HDC target_dc, const SimState *sim, const RECT *area);
 void ui_destroy(UiState *ui);
 
 #ifdef __cplusplus
@@ -0,0 +1,948 @@
+#include "ui_draw.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "sys_trace.h"
+#include "ui_text.h"
+
+#define UI_TEXT_COLOR UI_RGB(230, 230, 230)
+/* Memory DCs start with the stock white brush; the airflow glyphs are filled with it. */
+#define UI_STOCK_BRUSH UI_RGB(255, 255, 255)
+
+static double clamp01(double value)
+{
+    double result = value;
+    if (result < 0.0)
+    {
+        result = 0.0;
+    }
+    else if (result > 1.0)
+    {
+        result = 1.0;
+    }
+    else
+    {
+        /* no action */
+    }
+    return result;
+}
+
+static double deg_to_rad(double degrees)
+{
+    return degrees * (3.14159265358979323846 / 180.0);
+}
+
+static int ui_round_to_int(double value)
+{
+    return (int)((value >= 0.0) ? (value + 0.5) : (value - 0.5));
+}
+
+static UiRect ui_rect(int left, int top, int right, int bottom)
+{
+    UiRect rect;
+    rect.left = left;
+    rect.top = top;
+    rect.right = right;
+    rect.bottom = bottom;
+    return rect;
+}
+
+void ui_draw_list_reset(UiDrawList *list, int width, int height)
+{
+    if (list == NULL)
+    {
+        return;
+    }
+
+    list->count = 0U;
+    list->text_used = 0U;
+    list->width = width;
+    list->height = height;
+    list->overflowed = false;
+}
+
+const char *ui_draw_command_text(const UiDrawList *list, const UiDrawCommand *command)
+{
+    if ((list == NULL) || (command == NULL))
+    {
+        return "";
+    }
+    return &list->text[command->text_offset];
+}
+
+/* Next free command, zeroed; NULL (and overflowed set) when the list is full. */
+static UiDrawCommand *ui_draw_push(UiDrawList *list, UiDrawKind kind, UiRect rect)
+{
+    if (list->count >= UI_DRAW_MAX_COMMANDS)
+    {
+        list->overflowed = true;
+        return NULL;
+    }
+
+    UiDrawCommand *command = &list->commands[list->count++];
+    memset(command, 0, sizeof(*command));
+    command->kind = (uint8_t)kind;
+    command->rect = rect;
+    return command;
+}
+
+static void ui_draw_fill_rect(UiDrawList *list, UiRect rect, UiColor fill)
+{
+    UiDrawCommand *command = ui_draw_push(list, UI_CMD_FILL_RECT, rect);
+    if (command != NULL)
+    {
+        command->fill = fill;
+    }
+}
+
+static void ui_draw_frame_rect(UiDrawList *list, UiRect rect, UiColor color)
+{
+    UiDrawCommand *command = ui_draw_push(list, UI_CMD_FRAME_RECT, rect);
+    if (command != NULL)
+    {
+        command->pen = color;
+        command->pen_width = 1U;
+    }
+}
+
+/* ROUND_RECT, RECTANGLE and ELLIPSE: outline with pen, interior with fill. */
+static void ui_draw_shape(UiDrawList *list, UiDrawKind kind, UiRect rect, int corner,
+    UiColor pen, int pen_width, UiColor fill)
+{
+    UiDrawCommand *command = ui_draw_push(list, kind, rect);
+    if (command != NULL)
+    {
+        command->x2 = corner;
+        command->y2 = corner;
+        command->pen = pen;
+        command->pen_width = (uint8_t)pen_width;
+        command->fill = fill;
+    }
+}
+
+static void ui_draw_arc(UiDrawList *list, UiRect rect, int x_start, int y_start, int x_end, int y_end,
+    UiColor pen, int pen_width, uint8_t flags)
+{
+    UiDrawCommand *command = ui_draw_push(list, UI_CMD_ARC, rect);
+    if (command != NULL)
+    {
+        command->x2 = x_start;
+        command->y2 = y_start;
+        command->x3 = x_end;
+        command->y3 = y_end;
+        command->pen = pen;
+        command->pen_width = (uint8_t)pen_width;
+        command->flags = flags;
+    }
+}
+
+static void ui_draw_clip(UiDrawList *list, UiRect rect)
+{
+    (void)ui_draw_push(list, UI_CMD_CLIP, rect);
+}
+
+static void ui_draw_line(UiDrawList *list, int x0, int y0, int x1, int y1, UiColor pen, int pen_width)
+{
+    UiDrawCommand *command = ui_draw_push(list, UI_CMD_LINE, ui_rect(x0, y0, x1, y1));
+    if (command != NULL)
+    {
+        command->pen = pen;
+        command->pen_width = (uint8_t)pen_width;
+    }
+}
+
+/* Appends text to the run being built at the end of the arena; false once it is full. */
+static bool ui_text_append(UiDrawList *list, size_t *length, const char *text)
+{
+    const size_t size = strlen(text);
+    if ((list->text_used + *length + size + 1U) > UI_DRAW_TEXT_BYTES)
+    {
+        list->overflowed = true;
+        return false;
+    }
+    memcpy(&list->text[list->text_used + *length], text, size);
+    *length += size;
+    return true;
+}
+
+/* Turns the run built by ui_text_append into a TEXT command. */
+static void ui_text_commit(UiDrawList *list, UiRect rect, UiFont font, unsigned flags, size_t length)
+{
+    UiDrawCommand *command = ui_draw_push(list, UI_CMD_TEXT, rect);
+    if (command != NULL)
+    {
+        command->font = (uint8_t)font;
+        command->flags = (uint8_t)flags;
+        command->pen = UI_TEXT_COLOR;
+        command->text_offset = (uint16_t)list->text_used;
+        command->text_length = (uint16_t)length;
+        list->text[list->text_used + length] = '\0';
+        list->text_used += length + 1U;
+    }
+}
+
+static void ui_draw_string(UiDrawList *list, UiRect rect, UiFont font, unsigned flags, const char *text)
+{
+    size_t length = 0U;
+    if (ui_text_append(list, &length, text))
+    {
+        ui_text_commit(list, rect, font, flags, length);
+    }
+}
+
+/* prefix, value with a fixed number of decimals, suffix; no printf on the per-frame path. */
+static void ui_draw_number(UiDrawList *list, UiRect rect, UiFont font, unsigned flags, const char *prefix,
+    double value, int decimals, const char *suffix)
+{
+    char digits[32];
+    size_t length = 0U;
+    (void)ui_format_fixed(digits, sizeof(digits), value, decimals);
+    if (ui_text_append(list, &length, prefix) && ui_text_append(list, &length, digits)
+        && ui_text_append(list, &length, suffix))
+    {
+        ui_text_commit(list, rect, font, flags, length);
+    }
+}
+
+typedef struct
+{
+    double min_value;
+    double max_value;
+    const char *label;
+    const char *unit_suffix;
+    UiColor accent;
+} UiGaugeSpec;
+
+static const UiGaugeSpec g_ui_speed_gauge = {0.0, 200.0, "SPEED", " km/h", UI_RGB(90, 180, 230)};
+static const UiGaugeSpec g_ui_rpm_gauge = {0.0, 7000.0, "RPM", " rpm", UI_RGB(230, 150, 80)};
+
+/* Safety bands as fractions of the sweep. */
+static const struct
+{
+    double start_fraction;
+    double end_fraction;
+    UiColor color;
+} g_ui_gauge_bands[UI_GAUGE_BANDS] = {
+    {0.0, 0.6, UI_RGB(70, 180, 120)},
+    {0.6, 0.85, UI_RGB(230, 200, 120)},
+    {0.85, 1.0, UI_RGB(235, 100, 90)},
+};
+
+/* Readout precision, shared with the diff so it sees exactly what would be printed. */
+#define UI_DECIMALS_GAUGE 0
+#define UI_DECIMALS_FUEL 0
+#define UI_DECIMALS_TEMPERATURE 1
+
+#define UI_GAUGE_START_DEG 135.0
+#define UI_GAUGE_SWEEP_DEG 270.0
+
+static void ui_gauge_layout(UiGaugeLayout *gauge, int cx, int cy, int radius, int panel_top,
+    const UiGaugeSpec *spec)
+{
+    gauge->cx = cx;
+    gauge->cy = cy;
+    gauge->radius = radius;
+    gauge->needle_radius = radius - 16;
+    gauge->face = ui_rect(cx - radius, cy - radius, cx + radius, cy + radius);
+
+    const int band_radius = radius - 6;
+    gauge->band_rect = ui_rect(cx - band_radius, cy - band_radius, cx + band_radius, cy + band_radius);
+    for (int i = 0; i < UI_GAUGE_BANDS; ++i)
+    {
+        const double start_angle = deg_to_rad(UI_GAUGE_START_DEG
+            - (g_ui_gauge_bands[i].start_fraction * UI_GAUGE_SWEEP_DEG));
+        const double end_angle = deg_to_rad(UI_GAUGE_START_DEG
+            - (g_ui_gauge_bands[i].end_fraction * UI_GAUGE_SWEEP_DEG));
+        gauge->band_ends[i].x0 = cx + ui_round_to_int(cos(start_angle) * (double)band_radius);
+        gauge->band_ends[i].y0 = cy - ui_round_to_int(sin(start_angle) * (double)band_radius);
+        gauge->band_ends[i].x1 = cx + ui_round_to_int(cos(end_angle) * (double)band_radius);
+        gauge->band_ends[i].y1 = cy - ui_round_to_int(sin(end_angle) * (double)band_radius);
+    }
+
+    for (int i = 0; i < UI_GAUGE_TICKS; ++i)
+    {
+        const double fraction = (double)i / (double)(UI_GAUGE_TICKS - 1);
+        const double tick_angle = deg_to_rad(UI_GAUGE_START_DEG - (fraction * UI_GAUGE_SWEEP_DEG));
+        const int long_tick = (i % 2 == 0) ? 12 : 6;
+        gauge->ticks[i].x0 = cx + (int)(cos(tick_angle) * (radius - 4 - long_tick));
+        gauge->ticks[i].y0 = cy - (int)(sin(tick_angle) * (radius - 4 - long_tick));
+        gauge->ticks[i].x1 = cx + (int)(cos(tick_angle) * (radius - 4));
+        gauge->ticks[i].y1 = cy - (int)(sin(tick_angle) * (radius - 4));
+
+        if ((i % 2) == 0)
+        {
+            const double label_radius = (double)radius - 32.0;
+            const int label_x = cx + ui_round_to_int(cos(tick_angle) * label_radius);
+            const int label_y = cy - ui_round_to_int(sin(tick_angle) * label_radius);
+            const double tick_value = spec->min_value + (spec->max_value - spec->min_value) * fraction;
+            gauge->tick_labels[i / 2] = ui_rect(label_x - 25, label_y - 12, label_x + 25, label_y + 12);
+            gauge->tick_values[i / 2] = ui_round_to_int(tick_value);
+        }
+    }
+
+    gauge->caption = ui_rect(cx - radius, cy + radius - 70, cx + radius, cy + radius - 40);
+    gauge->hub = ui_rect(cx - 10, cy - 10, cx + 10, cy + 10);
+    gauge->value = ui_rect(cx - radius, cy + radius - 40, cx + radius, cy + radius);
+
+    /* The needle (4 px pen) never leaves needle_radius; the readout sits at the bottom. */
+    const int reach = gauge->needle_radius + 4;
+    const int bottom = ((cy + radius) < panel_top) ? (cy + radius) : panel_top;
+    gauge->region = ui_rect(cx - radius, cy - reach, cx + radius, bottom);
+}
+
+void ui_layout_compute(UiLayout *layout, int width, int height)
+{
+    if (layout == NULL)
+    {
+        return;
+    }
+
+    layout->width = width;
+    layout->height = height;
+
+    const int gauge_area_height = height / 2;
+    int gauge_radius = width / 4;
+    const int max_radius = gauge_area_height - 32;
+    if ((max_radius > 0) && (max_radius < gauge_radius))
+    {
+        gauge_radius = max_radius;
+    }
+    if (gauge_radius < 60)
+    {
+        gauge_radius = 60;
+    }
+    const int gauge_center_y = gauge_area_height - 20;
+
+    layout->fuel = ui_rect(width / 4, gauge_area_height, (width * 3) / 4, gauge_area_height + 30);
+
+    const int indicator_width = 90;
+    int indicator_x = width / 2 - 180;
+    for (int i = 0; i < 4; ++i)
+    {
+        layout->indicators[i] = ui_rect(indicator_x, 10, indicator_x + indicator_width, 70);
+        indicator_x += indicator_width + 10;
+    }
+
+    layout->panel = ui_rect(20, gauge_area_height + 50, width - 20, height - 20);
+    const UiRect inner = ui_rect(layout->panel.left + 20, layout->panel.top + 20,
+        layout->panel.right - 20, layout->panel.bottom - 20);
+    const int segment_height = (inner.bottom - inner.top) / 3;
+
+    ui_gauge_layout(&layout->speed, width / 4, gauge_center_y, gauge_radius, layout->panel.top,
+        &g_ui_speed_gauge);
+    ui_gauge_layout(&layout->rpm, (width * 3) / 4, gauge_center_y, gauge_radius, layout->panel.top,
+        &g_ui_rpm_gauge);
+
+    const UiRect temps_rect = ui_rect(inner.left, inner.top, inner.right, inner.top + segment_height);
+    const UiRect fan_rect = ui_rect(inner.left, temps_rect.bottom + 10, inner.right,
+        temps_rect.bottom + 10 + segment_height / 2);
+    const UiRect buttons_rect = ui_rect(inner.left, fan_rect.bottom + 10, inner.right, inner.bottom);
+
+    layout->setpoint = temps_rect;
+    layout->setpoint.right = inner.left + (inner.right - inner.left) / 3;
+    layout->cabin = temps_rect;
+    layout->cabin.left = layout->setpoint.right;
+    layout->cabin.right = layout->cabin.left + (inner.right - inner.left) / 3;
+    layout->outside = temps_rect;
+    layout->outside.left = layout->cabin.right;
+
+    layout->fan_label = fan_rect;
+    layout->fan_label.bottom = fan_rect.top + 24;
+    layout->fan_bars = fan_rect;
+    layout->fan_bars.top = layout->fan_label.bottom + 4;
+
+    layout->airflow_label = fan_rect;
+    layout->airflow_label.left = fan_rect.right - 220;
+    layout->airflow_icons = layout->airflow_label;
+    layout->airflow_icons.top += 20;
+
+    /* The airflow glyphs have fixed-size parts that stick out of short icon rows. */
+    const UiRect *icons = &layout->airflow_icons;
+    const int icons_top = (icons->top < icons->bottom) ? icons->top : icons->bottom;
+    const int icons_bottom = (icons->top < icons->bottom) ? icons->bottom : icons->top;
+    layout->airflow_region = ui_rect(icons->left, icons_top - 12, icons->right, icons_bottom + 12);
+
+    const int button_width = 100;
+    const int button_height = 40;
+    const int button_gap = 12;
+    int button_x = buttons_rect.left;
+    for (int i = 0; i < 5; ++i)
+    {
+        layout->buttons[i] = ui_rect(button_x, buttons_rect.top, button_x + button_width,
+            buttons_rect.top + button_height);
+        button_x += button_width + button_gap;
+    }
+
+    const int overlay_right = ((8 + UI_TEXT_PANEL_WIDTH) < width) ? (8 + UI_TEXT_PANEL_WIDTH) : width;
+    layout->text_panel = ui_rect(8, 8, overlay_right, 8 + (UI_TEXT_PANEL_LINES * UI_TEXT_PANEL_LINE_HEIGHT) + 8);
+
+    for (int i = 0; i <= (int)UI_NEEDLE_LUT_STEPS; ++i)
+    {
+        const double fraction = (double)i / (double)UI_NEEDLE_LUT_STEPS;
+        const double angle = deg_to_rad(UI_GAUGE_START_DEG - (fraction * UI_GAUGE_SWEEP_DEG));
+        layout->needle_cos[i] = cos(angle);
+        layout->needle_sin[i] = sin(angle);
+    }
+}
+
+/* Face, safety bands, ticks, tick labels and caption. */
+static void ui_build_gauge_static(UiDrawList *list, const UiGaugeLayout *gauge, const UiGaugeSpec *spec)
+{
+    if (gauge->radius <= 0)
+    {
+        return;
+    }
+
+    const UiColor tick_color = UI_RGB(180, 180, 180);
+    ui_draw_shape(list, UI_CMD_ELLIPSE, gauge->face, 0, spec->accent, 3, UI_RGB(25, 25, 25));
+
+    for (int i = 0; i < UI_GAUGE_BANDS; ++i)
+    {
+        const UiSegment *ends = &gauge->band_ends[i];
+        ui_draw_arc(list, gauge->band_rect, ends->x0, ends->y0, ends->x1, ends->y1,
+            g_ui_gauge_bands[i].color, 12, UI_STROKE_ROUND_CAP);
+    }
+
+    for (int i = 0; i < UI_GAUGE_TICKS; ++i)
+    {
+        const UiSegment *tick = &gauge->ticks[i];
+        ui_draw_line(list, tick->x0, tick->y0, tick->x1, tick->y1, tick_color, 1);
+    }
+    for (int i = 0; i < UI_GAUGE_LABELS; ++i)
+    {
+        ui_draw_number(list, gauge->tick_labels[i], UI_FONT_LABEL,
+            UI_TEXT_CENTER | UI_TEXT_VCENTER | UI_TEXT_SINGLELINE, "", (double)gauge->tick_values[i], 0, "");
+    }
+
+    ui_draw_string(list, gauge->caption, UI_FONT_LABEL, UI_TEXT_CENTER | UI_TEXT_BOTTOM, spec->label);
+}
+
+/* Needle tip for value from the direction table; the diff compares it to decide whether the gauge moved. */
+static void ui_gauge_needle(const UiLayout *layout, const UiGaugeLayout *gauge, double value,
+    const UiGaugeSpec *spec, int *x, int *y)
+{
+    const double position = clamp01((value - spec->min_value) / (spec->max_value - spec->min_value))
+        * (double)UI_NEEDLE_LUT_STEPS;
+    int step = (int)position;
+    if (step >= (int)UI_NEEDLE_LUT_STEPS)
+    {
+        step = (int)UI_NEEDLE_LUT_STEPS - 1;
+    }
+    const double t = position - (double)step;
+    const double c = layout->needle_cos[step] + ((layout->needle_cos[step + 1] - layout->needle_cos[step]) * t);
+    const double s = layout->needle_sin[step] + ((layout->needle_sin[step + 1] - layout->needle_sin[step]) * t);
+    *x = gauge->cx + (int)(c * gauge->needle_radius);
+    *y = gauge->cy - (int)(s * gauge->needle_radius);
+}
+
+static int ui_fuel_fill_width(UiRect bounds, double fuel_pct)
+{
+    return (int)((bounds.right - bounds.left) * clamp01(fuel_pct / 100.0));
+}
+
+/* Needle, hub and value readout. */
+static void ui_build_gauge_dynamic(UiDrawList *list, const UiLayout *layout, const UiGaugeLayout *gauge,
+    double value, const UiGaugeSpec *spec)
+{
+    if (gauge->radius <= 0)
+    {
+        return;
+    }
+
+    int needle_x = gauge->cx;
+    int needle_y = gauge->cy;
+    ui_gauge_needle(layout, gauge, value, spec, &needle_x, &needle_y);
+    ui_draw_line(list, gauge->cx, gauge->cy, needle_x, needle_y, UI_RGB(220, 80, 50), 4);
+
+    ui_draw_shape(list, UI_CMD_ELLIPSE, gauge->hub, 0, spec->accent, 3, UI_RGB(40, 40, 40));
+
+    ui_draw_number(list, gauge->value, UI_FONT_LABEL, UI_TEXT_CENTER | UI_TEXT_TOP, "", value, UI_DECIMALS_GAUGE,
+        spec->unit_suffix);
+}
+
+static void ui_build_fuel(UiDrawList *list, UiRect bounds, double fuel_pct)
+{
+    UiRect fill_rect = bounds;
+    fill_rect.right = fill_rect.left + ui_fuel_fill_width(bounds, fuel_pct);
+    ui_draw_fill_rect(list, fill_rect, UI_RGB(120, 200, 80));
+
+    ui_draw_number(list, bounds, UI_FONT_SMALL, UI_TEXT_CENTER | UI_TEXT_VCENTER | UI_TEXT_SINGLELINE,
+        "FUEL ", fuel_pct, UI_DECIMALS_FUEL, "%");
+}
+
+/* Left, hazard, right and headlight lamps as drawn (blinkers only in the on phase). */
+static void ui_indicator_lamps(const IndicatorState *ind, bool lit[4])
+{
+    lit[0] = (ind->hazard_enabled || ind->left_enabled) && ind->blink_on;
+    lit[1] = ind->hazard_enabled && ind->blink_on;
+    lit[2] = (ind->hazard_enabled || ind->right_enabled) && ind->blink_on;
+    lit[3] = ind->headlight_on;
+}
+
+static void ui_build_indicator(UiDrawList *list, UiRect bounds, const char *label, bool active, UiColor on_color)
+{
+    ui_draw_fill_rect(list, bounds, active ? on_color : UI_RGB(40, 40, 40));
+    ui_draw_frame_rect(list, bounds, UI_RGB(128, 128, 128));
+    ui_draw_string(list, bounds, UI_FONT_SMALL, UI_TEXT_CENTER | UI_TEXT_VCENTER | UI_TEXT_SINGLELINE, label);
+}
+
+static void ui_build_button(UiDrawList *list, UiRect bounds, const char *label, bool active)
+{
+    ui_draw_shape(list, UI_CMD_ROUND_RECT, bounds, 10, UI_RGB(120, 120, 120), 1,
+        active ? UI_RGB(70, 140, 220) : UI_RGB(60, 60, 60));
+    ui_draw_string(list, bounds, UI_FONT_SMALL, UI_TEXT_CENTER | UI_TEXT_VCENTER | UI_TEXT_SINGLELINE, label);
+}
+
+static void ui_build_fan_bars(UiDrawList *list, UiRect bounds, int fan_level)
+{
+    const int total_bars = 7;
+    const int bar_spacing = 4;
+    const int bar_width = (bounds.right - bounds.left - ((total_bars - 1) * bar_spacing)) / total_bars;
+    if (bar_width <= 0)
+    {
+        return;
+    }
+    int x = bounds.left;
+    for (int i = 0; i < total_bars; ++i)
+    {
+        ui_draw_fill_rect(list, ui_rect(x, bounds.top, x + bar_width, bounds.bottom),
+            (i < fan_level) ? UI_RGB(255, 170, 70) : UI_RGB(60, 60, 60));
+        x += bar_width + bar_spacing;
+    }
+}
+
+static void ui_build_airflow_icons(UiDrawList *list, UiRect bounds, HvacAirflowMode mode)
+{
+    const int icon_width = (bounds.right - bounds.left) / 3;
+    if (icon_width <= 0)
+    {
+        return;
+    }
+
+    const UiColor shape_pen = UI_RGB(220, 220, 220);
+    for (int i = 0; i < 3; ++i)
+    {
+        const UiRect icon = ui_rect(bounds.left + i * icon_width + 4, bounds.top + 4,
+            bounds.left + (i + 1) * icon_width - 4, bounds.bottom - 4);
+        const bool active = (i == (int)mode);
+        ui_draw_shape(list, UI_CMD_ROUND_RECT, icon, 12, UI_RGB(120, 120, 120), 1,
+            active ? UI_RGB(80, 180, 220) : UI_RGB(50, 50, 50));
+
+        switch (i)
+        {
+            case 0: /* face icon */
+            {
+                int cx = (icon.left + icon.right) / 2;
+                int cy = icon.top + (icon.bottom - icon.top) / 3;
+                ui_draw_shape(list, UI_CMD_ELLIPSE, ui_rect(cx - 8, cy - 8, cx + 8, cy + 8), 0,
+                    shape_pen, 2, UI_STOCK_BRUSH);
+                ui_draw_line(list, cx, cy + 8, cx, icon.bottom - 8, shape_pen, 2);
+                break;
+            }
+            case 1: /* bi-level */
+            {
+                int mid = (icon.top + icon.bottom) / 2;
+                ui_draw_shape(list, UI_CMD_RECTANGLE, ui_rect(icon.left + 6, icon.top + 6, icon.right - 6, mid - 4),
+                    0, shape_pen, 2, UI_STOCK_BRUSH);
+                ui_draw_shape(list, UI_CMD_RECTANGLE, ui_rect(icon.left + 6, mid + 4, icon.right - 6, icon.bottom - 6),
+                    0, shape_pen, 2, UI_STOCK_BRUSH);
+                break;
+            }
+            case 2: /* foot */
+            {
+                int base = icon.bottom - 6;
+                ui_draw_line(list, icon.left + 8, base, icon.right - 8, base, shape_pen, 2);
+                ui_draw_arc(list, ui_rect(icon.left + 4, icon.top + 6, icon.right - 4, icon.bottom),
+                    icon.left + 4, base, icon.right - 4, base, shape_pen, 2, 0U);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+static void ui_append_static_layer(UiDrawList *list, const UiLayout *layout)
+{
+    ui_draw_fill_rect(list, ui_rect(0, 0, list->width, list->height), UI_RGB(20, 20, 20));
+
+    ui_build_gauge_static(list, &layout->speed, &g_ui_speed_gauge);
+    ui_build_gauge_static(list, &layout->rpm, &g_ui_rpm_gauge);
+
+    ui_draw_frame_rect(list, layout->fuel, UI_RGB(60, 60, 60));
+    ui_draw_shape(list, UI_CMD_ROUND_RECT, layout->panel, 20, UI_RGB(80, 80, 80), 1, UI_RGB(35, 35, 35));
+    ui_draw_string(list, layout->fan_label, UI_FONT_SMALL, UI_TEXT_LEFT | UI_TEXT_VCENTER | UI_TEXT_SINGLELINE,
+        "FAN SPEED");
+    ui_draw_string(list, layout->airflow_label, UI_FONT_SMALL, UI_TEXT_RIGHT | UI_TEXT_TOP | UI_TEXT_SINGLELINE,
+        "AIRFLOW");
+}
+
+static void ui_append_dynamic_layer(UiDrawList *list, const UiLayout *layout, const SimState *sim)
+{
+    /* The HVAC panel covers the lower part of the gauges. */
+    ui_draw_clip(list, ui_rect(0, 0, list->width, layout->panel.top));
+    ui_build_gauge_dynamic(list, layout, &layout->speed, sim->velocity_kmh, &g_ui_speed_gauge);
+    ui_build_gauge_dynamic(list, layout, &layout->rpm, sim->rpm, &g_ui_rpm_gauge);
+    ui_draw_clip(list, ui_rect(0, 0, 0, 0));
+
+    ui_build_fuel(list, layout->fuel, sim->fuel_pct);
+
+    bool lit[4];
+    ui_indicator_lamps(&sim->indicators, lit);
+    ui_build_indicator(list, layout->indicators[0], "LEFT", lit[0], UI_RGB(120, 220, 120));
+    ui_build_indicator(list, layout->indicators[1], "HAZ", lit[1], UI_RGB(220, 120, 120));
+    ui_build_indicator(list, layout->indicators[2], "RIGHT", lit[2], UI_RGB(120, 220, 120));
+    ui_build_indicator(list, layout->indicators[3], "HEAD", lit[3], UI_RGB(120, 180, 255));
+
+    const unsigned centered = UI_TEXT_CENTER | UI_TEXT_VCENTER | UI_TEXT_SINGLELINE;
+    ui_draw_number(list, layout->setpoint, UI_FONT_SMALL, centered, "SET ", sim->hvac.setpoint_c,
+        UI_DECIMALS_TEMPERATURE, " C");
+    ui_draw_number(list, layout->cabin, UI_FONT_SMALL, centered, "CABIN ", sim->hvac.cabin_temp_c,
+        UI_DECIMALS_TEMPERATURE, " C");
+    ui_draw_number(list, layout->outside, UI_FONT_SMALL, centered, "OUT ", sim->hvac.outside_temp_c,
+        UI_DECIMALS_TEMPERATURE, " C");
+
+    ui_build_fan_bars(list, layout->fan_bars, sim->hvac.fan_level);
+    /* Keep every glyph inside its dirty region, even in tiny windows. */
+    ui_draw_clip(list, layout->airflow_region);
+    ui_build_airflow_icons(list, layout->airflow_icons, sim->hvac.airflow_mode);
+    ui_draw_clip(list, ui_rect(0, 0, 0, 0));
+
+    const char *mode_label = "FACE";
+    if (sim->hvac.airflow_mode == HVAC_AIRFLOW_BI_LEVEL)
+    {
+        mode_label = "BI";
+    }
+    else if (sim->hvac.airflow_mode == HVAC_AIRFLOW_FOOT)
+    {
+        mode_label = "FOOT";
+    }
+    else
+    {
+        /* no action */
+    }
+
+    ui_build_button(list, layout->buttons[0], "AC", sim->hvac.ac_on);
+    ui_build_button(list, layout->buttons[1], "AUTO", sim->hvac.auto_mode);
+    ui_build_button(list, layout->buttons[2], "RECIRC", sim->hvac.recirculation_on);
+    ui_build_button(list, layout->buttons[3], "DEF", sim->hvac.defrost_on);
+    ui_build_button(list, layout->buttons[4], mode_label, true);
+}
+
+void ui_build_static_layer(UiDrawList *list, const UiLayout *layout)
+{
+    if ((list == NULL) || (layout == NULL))
+    {
+        return;
+    }
+
+    SYS_TRACE_BEGIN(ui_build_static_layer);
+    ui_draw_list_reset(list, layout->width, layout->height);
+    ui_append_static_layer(list, layout);
+    SYS_TRACE_END(ui_build_static_layer);
+}
+
+void ui_build_dynamic_layer(UiDrawList *list, const UiLayout *layout, const SimState *sim)
+{
+    if ((list == NULL) || (layout == NULL) || (sim == NULL))
+    {
+        return;
+    }
+
+    SYS_TRACE_BEGIN(ui_build_dynamic_layer);
+    ui_draw_list_reset(list, layout->width, layout->height);
+    ui_append_dynamic_layer(list, layout, sim);
+    SYS_TRACE_END(ui_build_dynamic_layer);
+}
+
+void ui_build_text_panel(UiDrawList *list, const UiLayout *layout, const char *const *lines, size_t count)
+{
+    if ((list == NULL) || (layout == NULL) || (lines == NULL))
+    {
+        return;
+    }
+
+    const UiRect box = layout->text_panel;
+    ui_draw_fill_rect(list, box, UI_RGB(0, 0, 0));
+    ui_draw_frame_rect(list, box, UI_RGB(90, 90, 90));
+    for (size_t i = 0U; (i < count) && (i < UI_TEXT_PANEL_LINES); ++i)
+    {
+        const int top = box.top + 4 + ((int)i * UI_TEXT_PANEL_LINE_HEIGHT);
+        ui_draw_string(list, ui_rect(box.left + 8, top, box.right - 8, top + UI_TEXT_PANEL_LINE_HEIGHT),
+            UI_FONT_SMALL, UI_TEXT_LEFT | UI_TEXT_VCENTER | UI_TEXT_SINGLELINE, lines[i]);
+    }
+}
+
+void ui_build_frame(UiDrawList *list, const UiLayout *layout, const SimState *sim)
+{
+    if ((list == NULL) || (layout == NULL) || (sim == NULL))
+    {
+        return;
+    }
+
+    SYS_TRACE_BEGIN(ui_build_frame);
+    ui_draw_list_reset(list, layout->width, layout->height);
+    ui_append_static_layer(list, layout);
+    ui_append_dynamic_layer(list, layout, sim);
+    SYS_TRACE_END(ui_build_frame);
+}
+
+static bool ui_readout_differs(int decimals, double previous, double current)
+{
+    return ui_fixed_round(previous, decimals) != ui_fixed_round(current, decimals);
+}
+
+static bool ui_gauge_differs(const UiLayout *layout, const UiGaugeLayout *gauge, double previous,
+    double current, const UiGaugeSpec *spec)
+{
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+    ui_gauge_needle(layout, gauge, previous, spec, &x0, &y0);
+    ui_gauge_needle(layout, gauge, current, spec, &x1, &y1);
+    return (x0 != x1) || (y0 != y1) || ui_readout_differs(UI_DECIMALS_GAUGE, previous, current);
+}
+
+uint32_t ui_dirty_regions(const SimState *previous, const SimState *current, const UiLayout *layout)
+{
+    if ((previous == NULL) || (current == NULL) || (layout == NULL))
+    {
+        return UI_REGION_ALL;
+    }
+
+    const HvacState *a = &previous->hvac;
+    const HvacState *b = &current->hvac;
+    uint32_t regions = 0U;
+
+    if (ui_gauge_differs(layout, &layout->speed, previous->velocity_kmh, current->velocity_kmh,
+        &g_ui_speed_gauge))
+    {
+        regions |= UI_REGION_BIT(UI_REGION_SPEED_GAUGE);
+    }
+    if (ui_gauge_differs(layout, &layout->rpm, previous->rpm, current->rpm, &g_ui_rpm_gauge))
+    {
+        regions |= UI_REGION_BIT(UI_REGION_RPM_GAUGE);
+    }
+    if ((ui_fuel_fill_width(layout->fuel, previous->fuel_pct) != ui_fuel_fill_width(layout->fuel, current->fuel_pct))
+        || ui_readout_differs(UI_DECIMALS_FUEL, previous->fuel_pct, current->fuel_pct))
+    {
+        regions |= UI_REGION_BIT(UI_REGION_FUEL);
+    }
+
+    bool lit_a[4];
+    bool lit_b[4];
+    ui_indicator_lamps(&previous->indicators, lit_a);
+    ui_indicator_lamps(&current->indicators, lit_b);
+    for (int i = 0; i < 4; ++i)
+    {
+        if (lit_a[i] != lit_b[i])
+        {
+            regions |= UI_REGION_BIT(UI_REGION_INDICATOR_LEFT + i);
+        }
+    }
+
+    if (ui_readout_differs(UI_DECIMALS_TEMPERATURE, a->setpoint_c, b->setpoint_c))
+    {
+        regions |= UI_REGION_BIT(UI_REGION_SETPOINT);
+    }
+    if (ui_readout_differs(UI_DECIMALS_TEMPERATURE, a->cabin_temp_c, b->cabin_temp_c))
+    {
+        regions |= UI_REGION_BIT(UI_REGION_CABIN);
+    }
+    if (ui_readout_differs(UI_DECIMALS_TEMPERATURE, a->outside_temp_c, b->outside_temp_c))
+    {
+        regions |= UI_REGION_BIT(UI_REGION_OUTSIDE);
+    }
+    if (a->fan_level != b->fan_level)
+    {
+        regions |= UI_REGION_BIT(UI_REGION_FAN);
+    }
+    if (a->airflow_mode != b->airflow_mode)
+    {
+        regions |= UI_REGION_BIT(UI_REGION_AIRFLOW) | UI_REGION_BIT(UI_REGION_BUTTON_MODE);
+    }
+    if (a->ac_on != b->ac_on)
+    {
+        regions |= UI_REGION_BIT(UI_REGION_BUTTON_AC);
+    }
+    if (a->auto_mode != b->auto_mode)
+    {
+        regions |= UI_REGION_BIT(UI_REGION_BUTTON_AUTO);
+    }
+    if (a->recirculation_on != b->recirculation_on)
+    {
+        regions |= UI_REGION_BIT(UI_REGION_BUTTON_RECIRC);
+    }
+    if (a->defrost_on != b->defrost_on)
+    {
+        regions |= UI_REGION_BIT(UI_REGION_BUTTON_DEFROST);
+    }
+    return regions;
+}
+
+UiRect ui_region_bounds(UiRegion region, const UiLayout *layout)
+{
+    if (layout == NULL)
+    {
+        return ui_rect(0, 0, 0, 0);
+    }
+
+    switch (region)
+    {
+        case UI_REGION_SPEED_GAUGE:
+            return layout->speed.region;
+        case UI_REGION_RPM_GAUGE:
+            return layout->rpm.region;
+        case UI_REGION_FUEL:
+            return layout->fuel;
+        case UI_REGION_INDICATOR_LEFT:
+        case UI_REGION_INDICATOR_HAZARD:
+        case UI_REGION_INDICATOR_RIGHT:
+        case UI_REGION_INDICATOR_HEADLIGHT:
+            return layout->indicators[region - UI_REGION_INDICATOR_LEFT];
+        case UI_REGION_SETPOINT:
+            return layout->setpoint;
+        case UI_REGION_CABIN:
+            return layout->cabin;
+        case UI_REGION_OUTSIDE:
+            return layout->outside;
+        case UI_REGION_FAN:
+            return layout->fan_bars;
+        case UI_REGION_AIRFLOW:
+            return layout->airflow_region;
+        case UI_REGION_BUTTON_AC:
+        case UI_REGION_BUTTON_AUTO:
+        case UI_REGION_BUTTON_RECIRC:
+        case UI_REGION_BUTTON_DEFROST:
+        case UI_REGION_BUTTON_MODE:
+            return layout->buttons[region - UI_REGION_BUTTON_AC];
+        default:
+            break;
+    }
+    return ui_rect(0, 0, layout->width, layout->height);
+}
+
+size_t ui_dirty_rects(const SimState *previous, const SimState *current, const UiLayout *layout,
+    UiRect *rects, size_t capacity)
+{
+    if ((rects == NULL) || (layout == NULL))
+    {
+        return 0U;
+    }
+
+    const uint32_t regions = ui_dirty_regions(previous, current, layout);
+    size_t count = 0U;
+    for (int region = 0; (region < UI_REGION_COUNT) && (count < capacity); ++region)
+    {
+        if ((regions & UI_REGION_BIT(region)) != 0U)
+        {
+            rects[count++] = ui_region_bounds((UiRegion)region, layout);
+        }
+    }
+    return count;
+}
+
+/* Input or a discrete step (e.g. an AUTO fan change) between the states: rates across it mean nothing. */
+static bool ui_inputs_differ(const SimState *a, const SimState *b)
+{
+    const IndicatorState *ia = &a->indicators;
+    const IndicatorState *ib = &b->indicators;
+    return (a->throttle_pct != b->throttle_pct) || (a->brake_pct != b->brake_pct)
+        || (ia->left_enabled != ib->left_enabled) || (ia->right_enabled != ib->right_enabled)
+        || (ia->hazard_enabled != ib->hazard_enabled) || (ia->headlight_on != ib->headlight_on)
+        || (a->hvac.ac_on != b->hvac.ac_on) || (a->hvac.auto_mode != b->hvac.auto_mode)
+        || (a->hvac.recirculation_on != b->hvac.recirculation_on) || (a->hvac.defrost_on != b->hvac.defrost_on)
+        || (a->hvac.airflow_mode != b->hvac.airflow_mode) || (a->hvac.fan_level != b->hvac.fan_level)
+        || (a->hvac.engine_warm != b->hvac.engine_warm);
+}
+
+/* Seconds until value, moving at rate, crosses the next rounding boundary of its readout. */
+static double ui_time_to_readout_change(int decimals, double value, double rate)
+{
+    if (rate == 0.0)
+    {
+        return HUGE_VAL;
+    }
+
+    double scale = 1.0;
+    for (int i = 0; i < decimals; ++i)
+    {
+        scale *= 10.0;
+    }
+    const double shown = (double)ui_fixed_round(value, decimals);
+    const double boundary = (rate > 0.0) ? (shown + 0.5) : (shown - 0.5);
+    return fabs((boundary / scale) - value) / fabs(rate);
+}
+
+/* Seconds until value, moving at rate, has travelled step. */
+static double ui_time_to_step(double step, double rate)
+{
+    return (rate == 0.0) ? HUGE_VAL : (step / fabs(rate));
+}
+
+static double ui_time_to_gauge_change(const UiGaugeLayout *gauge, const UiGaugeSpec *spec, double value,
+    double rate)
+{
+    const double readout = ui_time_to_readout_change(UI_DECIMALS_GAUGE, value, rate);
+    if (gauge->needle_radius <= 0)
+    {
+        return readout;
+    }
+    /* Half a pixel of needle tip travel, in gauge units: the tip snaps to whole pixels somewhere within one. */
+    const double pixel = (spec->max_value - spec->min_value)
+        / (deg_to_rad(UI_GAUGE_SWEEP_DEG) * (double)gauge->needle_radius);
+    const double needle = ui_time_to_step(0.5 * pixel, rate);
+    return (needle < readout) ? needle : readout;
+}
+
+double ui_time_to_visible_change(const SimState *previous, const SimState *current, double elapsed_s,
+    const UiLayout *layout)
+{
+    if ((previous == NULL) || (current == NULL) || (layout == NULL) || (elapsed_s <= 0.0)
+        || ui_inputs_differ(previous, current))
+    {
+        return 0.0;
+    }
+
+    double t[7];
+    const HvacState *a = &previous->hvac;
+    const HvacState *b = &current->hvac;
+    t[0] = ui_time_to_gauge_change(&layout->speed, &g_ui_speed_gauge, current->velocity_kmh,
+        (current->velocity_kmh - previous->velocity_kmh) / elapsed_s);
+    t[1] = ui_time_to_gauge_change(&layout->rpm, &g_ui_rpm_gauge, current->rpm,
+        (current->rpm - previous->rpm) / elapsed_s);
+
+    const double fuel_rate = (current->fuel_pct - previous->fuel_pct) / elapsed_s;
+    const int fuel_width = layout->fuel.right - layout->fuel.left;
+    t[2] = ui_time_to_readout_change(UI_DECIMALS_FUEL, current->fuel_pct, fuel_rate);
+    if ((fuel_width > 0) && (fuel_rate != 0.0))
+    {
+        /* The bar edge is truncated to whole pixels (ui_fuel_fill_width). */
+        const double edge = (double)fuel_width * clamp01(current->fuel_pct / 100.0);
+        const double boundary = (fuel_rate > 0.0) ? (floor(edge) + 1.0) : floor(edge);
+        const double pixel = ((fabs(boundary - edge) * 100.0) / (double)fuel_width) / fabs(fuel_rate);
+        t[2] = (pixel < t[2]) ? pixel : t[2];
+    }
+
+    t[3] = ui_time_to_readout_change(UI_DECIMALS_TEMPERATURE, b->setpoint_c,
+        (b->setpoint_c - a->setpoint_c) / elapsed_s);
+    t[4] = ui_time_to_readout_change(UI_DECIMALS_TEMPERATURE, b->cabin_temp_c,
+        (b->cabin_temp_c - a->cabin_temp_c) / elapsed_s);
+    t[5] = ui_time_to_readout_change(UI_DECIMALS_TEMPERATURE, b->outside_temp_c,
+        (b->outside_temp_c - a->outside_temp_c) / elapsed_s);
+
+    /* Discrete changes the sim schedules itself: lamp phases and AUTO fan steps. */
+    const IndicatorState *ind = &current->indicators;
+    const unsigned events = SIM_EVENT_AUTO_THRESHOLD | SIM_EVENT_ENGINE_WARM
+        | ((ind->left_enabled || ind->right_enabled || ind->hazard_enabled) ? (unsigned)SIM_EVENT_BLINK_TOGGLE : 0U);
+    t[6] = sim_time_to_next_event(current, events, NULL);
+
+    double best = HUGE_VAL;
+    for (size_t i = 0U; i < (sizeof(t) / sizeof(t[0])); ++i)
+    {
+        best = (t[i] < best) ? t[i] : best;
+    }
+    return best;
+}
@@ -0,0 +1,235 @@
+#ifndef UI_DRAW_H
+#define UI_DRAW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+/*
+ * Portable display list for the cockpit. ui_build_frame() does all layout and
+ * formatting and records what to draw; a backend (GDI in ui.c) replays the list.
+ * Nothing here touches windows.h, so frame generation can be tested and
+ * benchmarked anywhere and two lists can be compared command by command.
+ */
+#define UI_DRAW_MAX_COMMANDS 512U
+#define UI_DRAW_TEXT_BYTES 4096U
+
+/* Same 0x00BBGGRR layout as a Win32 COLORREF. */
+typedef uint32_t UiColor;
+#define UI_RGB(r, g, b) ((UiColor)(((uint32_t)(uint8_t)(r)) | (((uint32_t)(uint8_t)(g)) << 8) \
+    | (((uint32_t)(uint8_t)(b)) << 16)))
+
+typedef enum
+{
+    UI_CMD_FILL_RECT = 0,   /* rect filled with fill */
+    UI_CMD_FRAME_RECT,      /* 1 px border of rect in pen color */
+    UI_CMD_ROUND_RECT,      /* rect, corner ellipse (x2, y2); pen outline, fill inside */
+    UI_CMD_RECTANGLE,       /* rect; pen outline, fill inside */
+    UI_CMD_ELLIPSE,         /* ellipse in rect; pen outline, fill inside */
+    UI_CMD_ARC,             /* ellipse rect, counter-clockwise from (x2, y2) to (x3, y3) */
+    UI_CMD_LINE,            /* (x0, y0) to (x1, y1) */
+    UI_CMD_TEXT,            /* text run laid out in rect */
+    UI_CMD_CLIP             /* later commands draw only inside rect; an empty rect clears it */
+} UiDrawKind;
+
+typedef enum
+{
+    UI_FONT_LABEL = 0,
+    UI_FONT_SMALL = 1,
+    UI_FONT_COUNT
+} UiFont;
+
+/* Text layout flags (mapped onto DT_* by the GDI backend). */
+enum
+{
+    UI_TEXT_LEFT = 0x00,
+    UI_TEXT_CENTER = 0x01,
+    UI_TEXT_RIGHT = 0x02,
+    UI_TEXT_TOP = 0x00,
+    UI_TEXT_VCENTER = 0x04,
+    UI_TEXT_BOTTOM = 0x08,
+    UI_TEXT_SINGLELINE = 0x20
+};
+
+/* Stroke flags. */
+enum
+{
+    UI_STROKE_ROUND_CAP = 0x01
+};
+
+typedef struct
+{
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+} UiRect;
+
+typedef struct
+{
+    uint8_t kind;
+    uint8_t font;
+    uint8_t flags;
+    uint8_t pen_width;
+    UiRect rect;
+    int32_t x2;
+    int32_t y2;
+    int32_t x3;
+    int32_t y3;
+    UiColor pen;
+    UiColor fill;
+    uint16_t text_offset;
+    uint16_t text_length;
+} UiDrawCommand;
+
+typedef struct
+{
+    UiDrawCommand commands[UI_DRAW_MAX_COMMANDS];
+    char text[UI_DRAW_TEXT_BYTES];
+    size_t count;
+    size_t text_used;
+    int width;
+    int height;
+    /* Set when a frame needed more commands or text than the fixed capacity. */
+    bool overflowed;
+} UiDrawList;
+
+void ui_draw_list_reset(UiDrawList *list, int width, int height);
+/* Text of a TEXT command (not NUL-terminated; use text_length). */
+const char *ui_draw_command_text(const UiDrawList *list, const UiDrawCommand *command);
+
+#define UI_GAUGE_TICKS 11
+#define UI_GAUGE_LABELS 6
+#define UI_GAUGE_BANDS 3
+/* Needle directions are interpolated between this many steps of the gauge sweep. */
+#define UI_NEEDLE_LUT_STEPS 256
+/* Diagnostic text panel in the top-left corner (frame time overlay). */
+#define UI_TEXT_PANEL_LINES 6
+#define UI_TEXT_PANEL_LINE_HEIGHT 22
+#define UI_TEXT_PANEL_WIDTH 600
+
+/* Line from (x0, y0) to (x1, y1). */
+typedef struct
+{
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+} UiSegment;
+
+/* Everything about one gauge except where its needle points. */
+typedef struct
+{
+    int cx;
+    int cy;
+    int radius;
+    int needle_radius;
+    UiRect face;
+    UiRect band_rect;
+    UiSegment band_ends[UI_GAUGE_BANDS]; /* arc start and end points */
+    UiSegment ticks[UI_GAUGE_TICKS];
+    UiRect tick_labels[UI_GAUGE_LABELS];
+    int tick_values[UI_GAUGE_LABELS];
+    UiRect caption;
+    UiRect hub;
+    UiRect value;
+    UiRect region; /* needle sweep and readout, cut off at the HVAC panel */
+} UiGaugeLayout;
+
+/* All geometry that depends only on the window size; see ui_layout_compute. */
+typedef struct
+{
+    int width;
+    int height;
+    UiGaugeLayout speed;
+    UiGaugeLayout rpm;
+    UiRect fuel;
+    UiRect indicators[4];
+    UiRect panel;
+    UiRect setpoint;
+    UiRect cabin;
+    UiRect outside;
+    UiRect fan_label;
+    UiRect fan_bars;
+    UiRect airflow_label;
+    UiRect airflow_icons;
+    UiRect airflow_region; /* icons plus the fixed-size glyph parts that stick out of short rows */
+    UiRect buttons[5];
+    UiRect text_panel;
+    /* Needle direction (y up) at step i of UI_NEEDLE_LUT_STEPS along the sweep. */
+    double needle_cos[UI_NEEDLE_LUT_STEPS + 1];
+    double needle_sin[UI_NEEDLE_LUT_STEPS + 1];
+} UiLayout;
+
+/* Computes every rect, tick, label position and band end point; call on resize only. */
+void ui_layout_compute(UiLayout *layout, int width, int height);
+
+/* Command generation for one cockpit frame. */
+void ui_build_frame(UiDrawList *list, const UiLayout *layout, const SimState *sim);
+/*
+ * The same frame split in two layers. The static layer (background, gauge faces,
+ * bands, ticks, captions, panel chrome) depends only on the size, so a backend can
+ * render it once per resize and draw just the dynamic layer (needles, readouts,
+ * indicators, fan bars, buttons) over a copy of it each frame.
+ */
+void ui_build_static_layer(UiDrawList *list, const UiLayout *layout);
+void ui_build_dynamic_layer(UiDrawList *list, const UiLayout *layout, const SimState *sim);
+/* Appends an opaque panel at layout->text_panel with up to UI_TEXT_PANEL_LINES lines of small text. */
+void ui_build_text_panel(UiDrawList *list, const UiLayout *layout, const char *const *lines, size_t count);
+
+/* Screen regions that change independently; the diff reports them as a bit mask. */
+typedef enum
+{
+    UI_REGION_SPEED_GAUGE = 0,
+    UI_REGION_RPM_GAUGE,
+    UI_REGION_FUEL,
+    UI_REGION_INDICATOR_LEFT,
+    UI_REGION_INDICATOR_HAZARD,
+    UI_REGION_INDICATOR_RIGHT,
+    UI_REGION_INDICATOR_HEADLIGHT,
+    UI_REGION_SETPOINT,
+    UI_REGION_CABIN,
+    UI_REGION_OUTSIDE,
+    UI_REGION_FAN,
+    UI_REGION_AIRFLOW,
+    UI_REGION_BUTTON_AC,
+    UI_REGION_BUTTON_AUTO,
+    UI_REGION_BUTTON_RECIRC,
+    UI_REGION_BUTTON_DEFROST,
+    UI_REGION_BUTTON_MODE,
+    UI_REGION_COUNT
+} UiRegion;
+
+#define UI_REGION_BIT(region) (1U << (unsigned)(region))
+#define UI_REGION_ALL ((1U << (unsigned)UI_REGION_COUNT) - 1U)
+
+/*
+ * Regions whose pixels differ between two states at the given size. Fields are
+ * compared as drawn (needle tip pixels, printed readouts, lamp phases), so noise
+ * below the display resolution marks nothing; 0 means no repaint is needed.
+ */
+uint32_t ui_dirty_regions(const SimState *previous, const SimState *current, const UiLayout *layout);
+UiRect ui_region_bounds(UiRegion region, const UiLayout *layout);
+/* Bounds of every dirty region, at most capacity of them; returns the count. */
+size_t ui_dirty_rects(const SimState *previous, const SimState *current, const UiLayout *layout,
+    UiRect *rects, size_t capacity);
+/*
+ * Seconds until ui_dirty_regions() would next report a change, extrapolating the
+ * rates seen from previous to current (elapsed_s apart) and adding the blink and
+ * AUTO events the sim predicts itself. HUGE_VAL when nothing visible is moving;
+ * 0 when there is nothing to extrapolate from (input or a discrete step between them).
+ */
+double ui_time_to_visible_change(const SimState *previous, const SimState *current, double elapsed_s,
+    const UiLayout *layout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_DRAW_H */
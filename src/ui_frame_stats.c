@@ -0,0 +1,261 @@
+#include "ui_frame_stats.h"
+
+#include <string.h>
+
+#include "ui_text.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+static unsigned ui_hist_msb(uint64_t x)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    (void)_BitScanReverse64(&index, x);
+    return (unsigned)index;
+#else
+    return 63U - (unsigned)__builtin_clzll(x);
+#endif
+}
+
+static size_t ui_hist_index(uint64_t value)
+{
+    if (value < UI_HIST_SUB_COUNT)
+    {
+        return (size_t)value;
+    }
+
+    /* Octave k >= 1 holds [2^(k+4), 2^(k+5)) in 32 steps of 2^(k-1). */
+    const unsigned octave = ui_hist_msb(value) - UI_HIST_SUB_BITS + 1U;
+    if (octave > UI_HIST_OCTAVES)
+    {
+        return UI_HIST_BUCKETS - 1U;
+    }
+    const size_t sub = (size_t)(value >> (octave - 1U)) - UI_HIST_SUB_COUNT;
+    return ((size_t)octave * UI_HIST_SUB_COUNT) + sub;
+}
+
+uint64_t ui_hist_bucket_limit(size_t index)
+{
+    if (index < UI_HIST_SUB_COUNT)
+    {
+        return (uint64_t)index;
+    }
+    if (index >= (UI_HIST_BUCKETS - 1U))
+    {
+        return UINT64_MAX;
+    }
+
+    const unsigned octave = (unsigned)(index / UI_HIST_SUB_COUNT);
+    const uint64_t sub = (uint64_t)(index % UI_HIST_SUB_COUNT) + UI_HIST_SUB_COUNT;
+    return ((sub + 1U) << (octave - 1U)) - 1U;
+}
+
+void ui_hist_reset(UiHistogram *hist)
+{
+    if (hist != NULL)
+    {
+        memset(hist, 0, sizeof(*hist));
+    }
+}
+
+void ui_hist_record(UiHistogram *hist, uint64_t value_ns)
+{
+    ++hist->counts[ui_hist_index(value_ns)];
+    ++hist->total;
+    hist->sum_ns += value_ns;
+    if (value_ns > hist->max_ns)
+    {
+        hist->max_ns = value_ns;
+    }
+}
+
+uint64_t ui_hist_percentile(const UiHistogram *hist, double percentile)
+{
+    if ((hist == NULL) || (hist->total == 0U))
+    {
+        return 0U;
+    }
+
+    const double clamped = (percentile < 0.0) ? 0.0 : ((percentile > 100.0) ? 100.0 : percentile);
+    uint64_t rank = (uint64_t)(((clamped / 100.0) * (double)hist->total) + 0.5);
+    rank = (rank == 0U) ? 1U : rank;
+    uint64_t seen = 0U;
+    for (size_t i = 0U; i < UI_HIST_BUCKETS; ++i)
+    {
+        seen += hist->counts[i];
+        if (seen >= rank)
+        {
+            const uint64_t limit = ui_hist_bucket_limit(i);
+            return (limit < hist->max_ns) ? limit : hist->max_ns;
+        }
+    }
+    return hist->max_ns;
+}
+
+void ui_frame_stats_reset(UiFrameStats *stats, bool enabled)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->enabled = enabled;
+}
+
+const char *ui_phase_name(UiPhase phase)
+{
+    switch (phase)
+    {
+        case UI_PHASE_INPUT:
+            return "input";
+        case UI_PHASE_UPDATE:
+            return "update";
+        case UI_PHASE_DRAW:
+            return "draw";
+        case UI_PHASE_BLIT:
+            return "blit";
+        case UI_PHASE_LATENCY:
+            return "latency";
+        default:
+            break;
+    }
+    return "?";
+}
+
+void ui_latency_posted(UiFrameStats *stats, double input_s)
+{
+    if ((stats == NULL) || !stats->enabled)
+    {
+        return;
+    }
+
+    UiLatencyTracker *latency = &stats->latency;
+    if (latency->posted >= UI_LATENCY_PENDING)
+    {
+        ++latency->dropped;
+        return;
+    }
+    latency->posted_s[latency->posted++] = input_s;
+}
+
+void ui_latency_applied(UiFrameStats *stats, double applied_s, bool visible)
+{
+    if ((stats == NULL) || !stats->enabled)
+    {
+        return;
+    }
+
+    /* The sim applies commands in order, so the applied inputs are a prefix of the FIFO. */
+    UiLatencyTracker *latency = &stats->latency;
+    size_t applied = 0U;
+    while ((applied < latency->posted) && (latency->posted_s[applied] <= applied_s))
+    {
+        if (!visible)
+        {
+            ++latency->invisible;
+        }
+        else if (latency->drawn < UI_LATENCY_PENDING)
+        {
+            latency->drawn_s[latency->drawn++] = latency->posted_s[applied];
+        }
+        else
+        {
+            ++latency->dropped;
+        }
+        ++applied;
+    }
+    latency->posted -= applied;
+    memmove(latency->posted_s, &latency->posted_s[applied], latency->posted * sizeof(double));
+}
+
+void ui_latency_presented(UiFrameStats *stats, double now_s)
+{
+    if ((stats == NULL) || !stats->enabled)
+    {
+        return;
+    }
+
+    UiLatencyTracker *latency = &stats->latency;
+    for (size_t i = 0U; i < latency->drawn; ++i)
+    {
+        const double elapsed_s = now_s - latency->drawn_s[i];
+        ui_hist_record(&stats->phases[UI_PHASE_LATENCY], (elapsed_s > 0.0) ? (uint64_t)(elapsed_s * 1e9) : 0U);
+    }
+    latency->drawn = 0U;
+}
+
+/* Appends text while it fits; the result stays NUL-terminated. */
+static void ui_stats_append(char *out, size_t capacity, size_t *length, const char *text)
+{
+    const size_t size = strlen(text);
+    if ((*length + size + 1U) <= capacity)
+    {
+        memcpy(&out[*length], text, size + 1U);
+        *length += size;
+    }
+}
+
+size_t ui_frame_stats_line(const UiFrameStats *stats, UiPhase phase, char *out, size_t capacity)
+{
+    if ((out == NULL) || (capacity == 0U))
+    {
+        return 0U;
+    }
+
+    out[0] = '\0';
+    if ((stats == NULL) || (phase >= UI_PHASE_COUNT))
+    {
+        return 0U;
+    }
+
+    static const double percentiles[3] = {50.0, 99.0, 99.9};
+    static const char *const labels[4] = {" p50 ", " p99 ", " p99.9 ", " max "};
+    const UiHistogram *hist = &stats->phases[phase];
+    size_t length = 0U;
+    ui_stats_append(out, capacity, &length, ui_phase_name(phase));
+    for (int i = 0; i < 4; ++i)
+    {
+        const uint64_t ns = (i < 3) ? ui_hist_percentile(hist, percentiles[i]) : hist->max_ns;
+        char number[32];
+        (void)ui_format_fixed(number, sizeof(number), (double)ns * 1e-6, 2);
+        ui_stats_append(out, capacity, &length, labels[i]);
+        ui_stats_append(out, capacity, &length, number);
+    }
+    ui_stats_append(out, capacity, &length, " ms");
+    return length;
+}
+
+bool ui_frame_stats_write(const UiFrameStats *stats, FILE *out)
+{
+    if ((stats == NULL) || (out == NULL))
+    {
+        return false;
+    }
+
+    bool ok = true;
+    for (int phase = 0; phase < (int)UI_PHASE_COUNT; ++phase)
+    {
+        const UiHistogram *hist = &stats->phases[phase];
+        ok = (fprintf(out, "phase=%s count=%llu mean_us=%.3f p50_us=%.3f p90_us=%.3f p99_us=%.3f p99.9_us=%.3f "
+            "max_us=%.3f\n", ui_phase_name((UiPhase)phase), (unsigned long long)hist->total,
+            (hist->total > 0U) ? (((double)hist->sum_ns / (double)hist->total) * 1e-3) : 0.0,
+            (double)ui_hist_percentile(hist, 50.0) * 1e-3, (double)ui_hist_percentile(hist, 90.0) * 1e-3,
+            (double)ui_hist_percentile(hist, 99.0) * 1e-3, (double)ui_hist_percentile(hist, 99.9) * 1e-3,
+            (double)hist->max_ns * 1e-3) > 0) && ok;
+        /* Raw buckets, so spikes can be re-binned or compared across kiosks later. */
+        for (size_t i = 0U; i < UI_HIST_BUCKETS; ++i)
+        {
+            if (hist->counts[i] != 0U)
+            {
+                ok = (fprintf(out, "  le_ns=%llu count=%lu\n", (unsigned long long)ui_hist_bucket_limit(i),
+                    (unsigned long)hist->counts[i]) > 0) && ok;
+            }
+        }
+    }
+    ok = (fprintf(out, "latency_invisible=%llu latency_dropped=%llu\n",
+        (unsigned long long)stats->latency.invisible, (unsigned long long)stats->latency.dropped) > 0) && ok;
+    return ok;
+}
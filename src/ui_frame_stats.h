@@ -0,0 +1,111 @@
+#ifndef UI_FRAME_STATS_H
+#define UI_FRAME_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sys_thread.h"
+
+/*
+ * Always-on frame phase timing. Each phase feeds a fixed-size log-linear
+ * histogram in nanoseconds (HdrHistogram style: 32 linear sub-buckets per
+ * power of two, so any recorded value is within ~3% of its bucket edge).
+ * Recording is a clock read, a bit scan and an increment; nothing allocates,
+ * and with enabled == false the phase hooks skip even the clock read.
+ */
+#define UI_HIST_SUB_BITS 5
+#define UI_HIST_SUB_COUNT (1U << UI_HIST_SUB_BITS)
+/* Powers of two above the linear range; 2^41 ns (~36 min) and up share the last bucket. */
+#define UI_HIST_OCTAVES 36U
+#define UI_HIST_BUCKETS (UI_HIST_SUB_COUNT * (UI_HIST_OCTAVES + 1U))
+
+typedef struct
+{
+    uint32_t counts[UI_HIST_BUCKETS];
+    uint64_t total;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+} UiHistogram;
+
+void ui_hist_reset(UiHistogram *hist);
+void ui_hist_record(UiHistogram *hist, uint64_t value_ns);
+/* Upper edge of the bucket holding the given percentile (0..100), never above max; 0 when empty. */
+uint64_t ui_hist_percentile(const UiHistogram *hist, double percentile);
+/* Largest value that lands in bucket index. */
+uint64_t ui_hist_bucket_limit(size_t index);
+
+typedef enum
+{
+    UI_PHASE_INPUT = 0,  /* key message dispatch */
+    UI_PHASE_UPDATE,     /* timer tick: newest sim state, dirty regions, pacing */
+    UI_PHASE_DRAW,       /* ui_render: static copy, build and replay of the display list */
+    UI_PHASE_BLIT,       /* ui_render: back buffer to window */
+    UI_PHASE_LATENCY,    /* not a phase: key event to the end of the first blit that shows it */
+    UI_PHASE_COUNT
+} UiPhase;
+
+/* Inputs in flight between the key event and the paint that shows them. */
+#define UI_LATENCY_PENDING 32U
+
+typedef struct
+{
+    double posted_s[UI_LATENCY_PENDING];  /* sent to the sim, not yet in a shown state (oldest first) */
+    size_t posted;
+    double drawn_s[UI_LATENCY_PENDING];   /* in a shown state whose regions are invalidated */
+    size_t drawn;
+    uint64_t invisible;                   /* applied without changing any pixel */
+    uint64_t dropped;                     /* more than UI_LATENCY_PENDING in flight */
+} UiLatencyTracker;
+
+typedef struct
+{
+    UiHistogram phases[UI_PHASE_COUNT];
+    UiLatencyTracker latency;
+    bool enabled;
+} UiFrameStats;
+
+void ui_frame_stats_reset(UiFrameStats *stats, bool enabled);
+const char *ui_phase_name(UiPhase phase);
+
+/*
+ * Input-to-photon tracking. input_s is the command's time_s, taken when the key
+ * message is handled; "photon" ends at the blit, as DWM composition and scan-out
+ * are not observable from the window.
+ */
+void ui_latency_posted(UiFrameStats *stats, double input_s);
+/* A state including every input up to applied_s is being shown; visible: it invalidated something. */
+void ui_latency_applied(UiFrameStats *stats, double applied_s, bool visible);
+/* After a paint: every input drawn since the last one is recorded as now_s - input_s. */
+void ui_latency_presented(UiFrameStats *stats, double now_s);
+
+/* Start time for ui_phase_end; 0 (and no clock read) while disabled. */
+static inline double ui_phase_begin(const UiFrameStats *stats)
+{
+    return stats->enabled ? sys_time_seconds() : 0.0;
+}
+
+static inline void ui_phase_end(UiFrameStats *stats, UiPhase phase, double start_s)
+{
+    if (stats->enabled)
+    {
+        const double elapsed_s = sys_time_seconds() - start_s;
+        ui_hist_record(&stats->phases[phase], (elapsed_s > 0.0) ? (uint64_t)(elapsed_s * 1e9) : 0U);
+    }
+}
+
+/* "draw p50 0.12 p99 0.41 p99.9 0.90 max 1.20 ms" without printf; returns the length. */
+size_t ui_frame_stats_line(const UiFrameStats *stats, UiPhase phase, char *out, size_t capacity);
+/* Percentiles and every non-empty bucket of each phase as text; false on a write error. */
+bool ui_frame_stats_write(const UiFrameStats *stats, FILE *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_FRAME_STATS_H */
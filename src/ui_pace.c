@@ -0,0 +1,109 @@
+#include "ui_pace.h"
+
+#include <string.h>
+
+void ui_pacer_init(UiPacer *pacer, double now_s)
+{
+    if (pacer == NULL)
+    {
+        return;
+    }
+
+    memset(pacer, 0, sizeof(*pacer));
+    pacer->interval_s = UI_PACE_FRAME_S;
+    pacer->started_s = now_s;
+}
+
+double ui_pacer_tick(UiPacer *pacer, double now_s, const SimState *shown, bool repainted, const UiLayout *layout)
+{
+    if ((pacer == NULL) || (shown == NULL))
+    {
+        return UI_PACE_FRAME_S;
+    }
+
+    ++pacer->ticks;
+    if (repainted)
+    {
+        ++pacer->frames;
+    }
+
+    /* Without a previous tick there is no rate to extrapolate; stay at full rate for one frame. */
+    double next = 0.0;
+    if (pacer->has_shown)
+    {
+        next = ui_time_to_visible_change(&pacer->shown, shown, now_s - pacer->shown_s, layout);
+    }
+    if (next < UI_PACE_FRAME_S)
+    {
+        next = UI_PACE_FRAME_S;
+    }
+    else if (next > UI_PACE_IDLE_S)
+    {
+        next = UI_PACE_IDLE_S;
+    }
+    else
+    {
+        /* no action */
+    }
+
+    pacer->shown = *shown;
+    pacer->shown_s = now_s;
+    pacer->has_shown = true;
+    pacer->interval_s = next;
+    return next;
+}
+
+double ui_pacer_wake(UiPacer *pacer)
+{
+    if (pacer == NULL)
+    {
+        return UI_PACE_FRAME_S;
+    }
+
+    ++pacer->wakes;
+    pacer->interval_s = UI_PACE_FRAME_S;
+    return pacer->interval_s;
+}
+
+void ui_pacer_set_paused(UiPacer *pacer, double now_s, bool paused)
+{
+    if ((pacer == NULL) || (pacer->paused == paused))
+    {
+        return;
+    }
+
+    pacer->paused = paused;
+    if (paused)
+    {
+        pacer->paused_since_s = now_s;
+    }
+    else
+    {
+        pacer->paused_total_s += now_s - pacer->paused_since_s;
+        /* Rates measured across the pause would be meaningless. */
+        pacer->has_shown = false;
+        pacer->interval_s = UI_PACE_FRAME_S;
+    }
+}
+
+void ui_pacer_stats(const UiPacer *pacer, double now_s, UiPacerStats *stats)
+{
+    if ((pacer == NULL) || (stats == NULL))
+    {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->elapsed_s = now_s - pacer->started_s;
+    stats->paused_s = pacer->paused_total_s + (pacer->paused ? (now_s - pacer->paused_since_s) : 0.0);
+    stats->frames = pacer->frames;
+    stats->ticks = pacer->ticks;
+    stats->wakes = pacer->wakes;
+    if (stats->elapsed_s > 0.0)
+    {
+        const double slots = stats->elapsed_s / UI_PACE_FRAME_S;
+        stats->fps = (double)pacer->frames / stats->elapsed_s;
+        stats->tick_hz = (double)pacer->ticks / stats->elapsed_s;
+        stats->idle_ratio = ((double)pacer->frames < slots) ? (1.0 - ((double)pacer->frames / slots)) : 0.0;
+    }
+}
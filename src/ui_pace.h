@@ -0,0 +1,64 @@
+#ifndef UI_PACE_H
+#define UI_PACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sim.h"
+#include "ui_draw.h"
+
+/*
+ * Frame pacing for the cockpit window. Instead of a fixed 60 Hz timer, every
+ * tick asks ui_time_to_visible_change() when the display will next differ and
+ * sleeps until then: full rate while a needle sweeps, a few wakes per second
+ * for a blinker, UI_PACE_IDLE_S when nothing moves. Input wakes the pacer back
+ * to full rate and a minimized window does not tick at all.
+ */
+#define UI_PACE_FRAME_S (1.0 / 60.0)
+/* Longest sleep; bounds the delay of changes the prediction cannot see. */
+#define UI_PACE_IDLE_S 0.5
+
+typedef struct
+{
+    SimState shown;        /* state of the previous tick, for the rates */
+    double shown_s;
+    bool has_shown;
+    bool paused;           /* minimized: no ticks until unpaused */
+    double interval_s;     /* current wait between ticks */
+    double started_s;
+    double paused_since_s;
+    double paused_total_s;
+    uint64_t ticks;        /* timer wakes */
+    uint64_t frames;       /* ticks that repainted something */
+    uint64_t wakes;        /* ui_pacer_wake calls */
+} UiPacer;
+
+typedef struct
+{
+    double elapsed_s;
+    double fps;            /* repainted frames per second */
+    double tick_hz;        /* wakes per second */
+    double idle_ratio;     /* share of 60 Hz frame slots not repainted, minimized time included */
+    double paused_s;
+    uint64_t frames;
+    uint64_t ticks;
+    uint64_t wakes;
+} UiPacerStats;
+
+void ui_pacer_init(UiPacer *pacer, double now_s);
+/* After each tick: the state shown and whether anything was repainted. Returns seconds until the next tick. */
+double ui_pacer_tick(UiPacer *pacer, double now_s, const SimState *shown, bool repainted, const UiLayout *layout);
+/* Input arrived: returns the interval to tick at right away (full rate). */
+double ui_pacer_wake(UiPacer *pacer);
+void ui_pacer_set_paused(UiPacer *pacer, double now_s, bool paused);
+void ui_pacer_stats(const UiPacer *pacer, double now_s, UiPacerStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_PACE_H */
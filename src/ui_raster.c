@@ -0,0 +1,823 @@
+#include "ui_raster.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sys_trace.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define UI_RASTER_SSE2 1
+#include <emmintrin.h>
+#else
+#define UI_RASTER_SSE2 0
+#endif
+
+#define UI_RASTER_OPAQUE 0xFF000000U
+/* Vertical samples per pixel row; each contributes up to 64 of the 255 coverage. */
+#define UI_RASTER_SUBSAMPLES 4
+#define UI_RASTER_TWO_PI 6.28318530717958647692
+
+/* Horizontal extent of a shape at height y; false when the line misses it. */
+typedef bool (*UiExtentFn)(const void *shape, double y, double *xl, double *xr);
+
+typedef struct
+{
+    double left;
+    double top;
+    double right;
+    double bottom;
+    double rx;
+    double ry;
+} UiRoundShape;
+
+typedef struct
+{
+    double ax;
+    double ay;
+    double bx;
+    double by;
+    double half_width;
+    /* Unit direction a->b, its reciprocals (0 when axis-aligned) and the length. */
+    double ux;
+    double uy;
+    double inv_ux;
+    double inv_uy;
+    double length;
+} UiCapsule;
+
+/* Part of a circular ring within one half (left or right of the centre) and at
+ * most 180 degrees, so every scanline meets it in a single interval. */
+typedef struct
+{
+    double cx;
+    double cy;
+    double r_in;
+    double r_out;
+    bool right;
+    /* Wedge as two half-planes: a * x + b >= 0 for the start and end rays. */
+    double start_sin;
+    double start_cos;
+    double end_sin;
+    double end_cos;
+} UiRingPiece;
+
+/* Printable ASCII 0x20..0x7E, 5 columns per glyph, bit 0 is the top row. */
+static const uint8_t g_ui_font5x7[95][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x08, 0x2A, 0x1C, 0x2A, 0x08}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00},
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00},
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E},
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x01, 0x01},
+    {0x3E, 0x41, 0x41, 0x51, 0x32}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+    {0x7F, 0x02, 0x04, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x7F, 0x20, 0x18, 0x20, 0x7F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+    {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04},
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78},
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F},
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x08, 0x14, 0x54, 0x54, 0x3C},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00},
+    {0x00, 0x7F, 0x10, 0x28, 0x44}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08},
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00},
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x08, 0x04, 0x08, 0x10, 0x08}
+};
+
+/* Scales the 5x7 font into an atlas; roughly the cap height of the GDI fonts (24 px label, 18 px small). */
+static bool ui_raster_build_font(UiGlyphAtlas *atlas, int scale)
+{
+    const int cell = 5 * scale;
+    if (!ui_glyph_atlas_create(atlas, (int)UI_GLYPH_COUNT * cell, 7 * scale))
+    {
+        return false;
+    }
+
+    for (unsigned index = 0U; index < UI_GLYPH_COUNT; ++index)
+    {
+        UiGlyph *glyph = &atlas->glyphs[index];
+        glyph->atlas_x = (int)index * cell;
+        glyph->cell_width = cell;
+        glyph->left = 0;
+        glyph->advance = 6 * scale;
+        glyph->extent = cell;
+        for (int column = 0; column < 5; ++column)
+        {
+            for (int bit = 0; bit < 7; ++bit)
+            {
+                if ((g_ui_font5x7[index][column] & (1U << bit)) == 0U)
+                {
+                    continue;
+                }
+                for (int dy = 0; dy < scale; ++dy)
+                {
+                    uint8_t *row = &atlas->coverage[(size_t)((bit * scale) + dy) * (size_t)atlas->width];
+                    memset(&row[glyph->atlas_x + (column * scale)], 255, (size_t)scale);
+                }
+            }
+        }
+    }
+    return ui_glyph_atlas_finish(atlas);
+}
+
+bool ui_framebuffer_create(UiFramebuffer *fb, int width, int height)
+{
+    if ((fb == NULL) || (width <= 0) || (height <= 0))
+    {
+        return false;
+    }
+
+    fb->width = width;
+    fb->height = height;
+    fb->clip.left = 0;
+    fb->clip.top = 0;
+    fb->clip.right = width;
+    fb->clip.bottom = height;
+    fb->pixels = (uint32_t *)malloc((size_t)width * (size_t)height * sizeof(uint32_t));
+    fb->coverage = (uint8_t *)malloc((size_t)width + 16U);
+    bool fonts_ok = true;
+    for (int font = 0; font < UI_FONT_COUNT; ++font)
+    {
+        fonts_ok = ui_raster_build_font(&fb->fonts[font], (font == UI_FONT_LABEL) ? 3 : 2) && fonts_ok;
+    }
+    if ((fb->pixels == NULL) || (fb->coverage == NULL) || !fonts_ok)
+    {
+        ui_framebuffer_destroy(fb);
+        return false;
+    }
+    return true;
+}
+
+void ui_framebuffer_destroy(UiFramebuffer *fb)
+{
+    if (fb == NULL)
+    {
+        return;
+    }
+
+    free(fb->pixels);
+    free(fb->coverage);
+    for (int font = 0; font < UI_FONT_COUNT; ++font)
+    {
+        ui_glyph_atlas_destroy(&fb->fonts[font]);
+    }
+    fb->pixels = NULL;
+    fb->coverage = NULL;
+    fb->width = 0;
+    fb->height = 0;
+}
+
+bool ui_framebuffer_copy(UiFramebuffer *dst, const UiFramebuffer *src)
+{
+    if ((dst == NULL) || (src == NULL) || (dst->pixels == NULL) || (src->pixels == NULL)
+        || (dst->width != src->width) || (dst->height != src->height))
+    {
+        return false;
+    }
+
+    memcpy(dst->pixels, src->pixels, (size_t)src->width * (size_t)src->height * sizeof(uint32_t));
+    return true;
+}
+
+bool ui_framebuffer_copy_rect(UiFramebuffer *dst, const UiFramebuffer *src, const UiRect *rect)
+{
+    if ((dst == NULL) || (src == NULL) || (rect == NULL) || (dst->pixels == NULL) || (src->pixels == NULL)
+        || (dst->width != src->width) || (dst->height != src->height))
+    {
+        return false;
+    }
+
+    const int x0 = (rect->left < 0) ? 0 : rect->left;
+    const int x1 = (rect->right > src->width) ? src->width : rect->right;
+    const int y0 = (rect->top < 0) ? 0 : rect->top;
+    const int y1 = (rect->bottom > src->height) ? src->height : rect->bottom;
+    for (int y = y0; (y < y1) && (x0 < x1); ++y)
+    {
+        const size_t offset = ((size_t)y * (size_t)src->width) + (size_t)x0;
+        memcpy(&dst->pixels[offset], &src->pixels[offset], (size_t)(x1 - x0) * sizeof(uint32_t));
+    }
+    return true;
+}
+
+const char *ui_raster_kernel_name(void)
+{
+    return UI_RASTER_SSE2 ? "sse2" : "scalar";
+}
+
+static uint32_t ui_raster_pixel(UiColor color)
+{
+    return (uint32_t)color | UI_RASTER_OPAQUE;
+}
+
+static void ui_raster_fill_span(uint32_t *row, int x0, int x1, uint32_t pixel)
+{
+    int x = x0;
+#if UI_RASTER_SSE2
+    const __m128i value = _mm_set1_epi32((int)pixel);
+    for (; (x + 4) <= x1; x += 4)
+    {
+        _mm_storeu_si128((__m128i *)&row[x], value);
+    }
+#endif
+    for (; x < x1; ++x)
+    {
+        row[x] = pixel;
+    }
+}
+
+/* dst = (src * a + dst * (255 - a)) / 255 per channel, a = coverage[x - x0]. */
+static void ui_raster_blend_span(uint32_t *row, int x0, int x1, uint32_t pixel, const uint8_t *coverage)
+{
+    int x = x0;
+#if UI_RASTER_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32((int)pixel), zero);
+    for (; (x + 4) <= x1; x += 4)
+    {
+        uint32_t packed;
+        memcpy(&packed, &coverage[x - x0], sizeof(packed));
+        __m128i alpha = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)packed), zero);
+        alpha = _mm_unpacklo_epi16(alpha, alpha);
+        const __m128i alpha_lo = _mm_unpacklo_epi32(alpha, alpha);
+        const __m128i alpha_hi = _mm_unpackhi_epi32(alpha, alpha);
+
+        const __m128i dst = _mm_loadu_si128((const __m128i *)&row[x]);
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(src, alpha_lo),
+            _mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_sub_epi16(full, alpha_lo)));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(src, alpha_hi),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_sub_epi16(full, alpha_hi)));
+        lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(lo, one), _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hi, one), _mm_srli_epi16(hi, 8)), 8);
+        _mm_storeu_si128((__m128i *)&row[x], _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; x < x1; ++x)
+    {
+        const uint32_t a = coverage[x - x0];
+        const uint32_t dst = row[x];
+        uint32_t out = 0U;
+        for (unsigned shift = 0U; shift < 32U; shift += 8U)
+        {
+            const uint32_t mixed = (((pixel >> shift) & 0xFFU) * a) + (((dst >> shift) & 0xFFU) * (255U - a));
+            out |= (((mixed + 1U + (mixed >> 8)) >> 8) & 0xFFU) << shift;
+        }
+        row[x] = out;
+    }
+}
+
+static void ui_raster_fill_rect(UiFramebuffer *fb, int left, int top, int right, int bottom, uint32_t pixel)
+{
+    const int x0 = (left < fb->clip.left) ? fb->clip.left : left;
+    const int x1 = (right > fb->clip.right) ? fb->clip.right : right;
+    const int y0 = (top < fb->clip.top) ? fb->clip.top : top;
+    const int y1 = (bottom > fb->clip.bottom) ? fb->clip.bottom : bottom;
+    if ((x0 >= x1) || (y0 >= y1))
+    {
+        return;
+    }
+
+    for (int y = y0; y < y1; ++y)
+    {
+        ui_raster_fill_span(&fb->pixels[(size_t)y * (size_t)fb->width], x0, x1, pixel);
+    }
+}
+
+/* Length of [xl, xr] inside pixel column x. */
+static double ui_raster_overlap(double xl, double xr, int x)
+{
+    const double a = (xl > (double)x) ? xl : (double)x;
+    const double b = (xr < (double)(x + 1)) ? xr : (double)(x + 1);
+    return (b > a) ? (b - a) : 0.0;
+}
+
+/*
+ * Rasterizes a convex shape row by row. Each row is sampled at UI_RASTER_SUBSAMPLES
+ * heights; pixels covered by every sample are span-filled, the rest blended.
+ */
+static void ui_raster_shape(UiFramebuffer *fb, UiExtentFn extent, const void *shape,
+    double top, double bottom, uint32_t pixel)
+{
+    int y0 = (int)floor(top);
+    int y1 = (int)ceil(bottom);
+    y0 = (y0 < fb->clip.top) ? fb->clip.top : y0;
+    y1 = (y1 > fb->clip.bottom) ? fb->clip.bottom : y1;
+
+    for (int y = y0; y < y1; ++y)
+    {
+        double xl[UI_RASTER_SUBSAMPLES];
+        double xr[UI_RASTER_SUBSAMPLES];
+        double span_lo = 1e30;
+        double span_hi = -1e30;
+        double core_lo = -1e30;
+        double core_hi = 1e30;
+        int hits = 0;
+        for (int s = 0; s < UI_RASTER_SUBSAMPLES; ++s)
+        {
+            const double sample_y = (double)y + (((double)s + 0.5) / (double)UI_RASTER_SUBSAMPLES);
+            if (!extent(shape, sample_y, &xl[s], &xr[s]) || (xr[s] <= xl[s]))
+            {
+                xl[s] = 0.0;
+                xr[s] = 0.0;
+                core_hi = -1e30;
+                continue;
+            }
+            ++hits;
+            span_lo = (xl[s] < span_lo) ? xl[s] : span_lo;
+            span_hi = (xr[s] > span_hi) ? xr[s] : span_hi;
+            core_lo = (xl[s] > core_lo) ? xl[s] : core_lo;
+            core_hi = (xr[s] < core_hi) ? xr[s] : core_hi;
+        }
+        if (hits == 0)
+        {
+            continue;
+        }
+
+        int x0 = (int)floor(span_lo);
+        int x1 = (int)ceil(span_hi);
+        x0 = (x0 < fb->clip.left) ? fb->clip.left : x0;
+        x1 = (x1 > fb->clip.right) ? fb->clip.right : x1;
+        int c0 = (int)ceil(core_lo);
+        int c1 = (int)floor(core_hi);
+        c0 = (c0 < x0) ? x0 : c0;
+        c1 = (c1 > x1) ? x1 : c1;
+        if (c1 <= c0)
+        {
+            c0 = x1;
+            c1 = x1;
+        }
+
+        uint32_t *row = &fb->pixels[(size_t)y * (size_t)fb->width];
+        for (int x = x0; x < x1; ++x)
+        {
+            if (x == c0)
+            {
+                x = c1 - 1;
+                continue;
+            }
+            double covered = 0.0;
+            for (int s = 0; s < UI_RASTER_SUBSAMPLES; ++s)
+            {
+                covered += ui_raster_overlap(xl[s], xr[s], x);
+            }
+            const int alpha = (int)((covered * (255.0 / (double)UI_RASTER_SUBSAMPLES)) + 0.5);
+            fb->coverage[x - x0] = (uint8_t)((alpha > 255) ? 255 : alpha);
+        }
+
+        ui_raster_blend_span(row, x0, c0, pixel, fb->coverage);
+        ui_raster_fill_span(row, c0, c1, pixel);
+        ui_raster_blend_span(row, c1, x1, pixel, &fb->coverage[c1 - x0]);
+    }
+}
+
+/* Rectangle whose corners are quarter ellipses of radii rx, ry (0 = square, half size = ellipse). */
+static bool ui_round_extent(const void *shape, double y, double *xl, double *xr)
+{
+    const UiRoundShape *r = (const UiRoundShape *)shape;
+    if ((y < r->top) || (y >= r->bottom))
+    {
+        return false;
+    }
+
+    double inset = 0.0;
+    if (r->ry > 0.0)
+    {
+        double dy = 0.0;
+        if (y < (r->top + r->ry))
+        {
+            dy = (r->top + r->ry) - y;
+        }
+        else if (y > (r->bottom - r->ry))
+        {
+            dy = y - (r->bottom - r->ry);
+        }
+        else
+        {
+            /* no action */
+        }
+        const double t = dy / r->ry;
+        inset = r->rx * (1.0 - sqrt((t < 1.0) ? (1.0 - (t * t)) : 0.0));
+    }
+
+    *xl = r->left + inset;
+    *xr = r->right - inset;
+    return true;
+}
+
+/* Clips [*lo, *hi] to the x where a * x + b lies in [min, max]. */
+static void ui_clip_linear(double a, double inv_a, double b, double min, double max, double *lo, double *hi)
+{
+    if (inv_a == 0.0)
+    {
+        if ((b < min) || (b > max))
+        {
+            *hi = -1e30;
+        }
+        return;
+    }
+
+    double x0 = (min - b) * inv_a;
+    double x1 = (max - b) * inv_a;
+    if (a < 0.0)
+    {
+        const double swap = x0;
+        x0 = x1;
+        x1 = swap;
+    }
+    *lo = (x0 > *lo) ? x0 : *lo;
+    *hi = (x1 < *hi) ? x1 : *hi;
+}
+
+/* Segment a-b thickened by half_width with round ends: union of two discs and a slab. */
+static bool ui_capsule_extent(const void *shape, double y, double *xl, double *xr)
+{
+    const UiCapsule *c = (const UiCapsule *)shape;
+    const double hw = c->half_width;
+    double lo = 1e30;
+    double hi = -1e30;
+
+    const double ends[2][2] = {{c->ax, c->ay}, {c->bx, c->by}};
+    for (int i = 0; i < 2; ++i)
+    {
+        const double dy = y - ends[i][1];
+        if (fabs(dy) <= hw)
+        {
+            const double half = sqrt((hw * hw) - (dy * dy));
+            lo = ((ends[i][0] - half) < lo) ? (ends[i][0] - half) : lo;
+            hi = ((ends[i][0] + half) > hi) ? (ends[i][0] + half) : hi;
+        }
+    }
+
+    if (c->length > 0.0)
+    {
+        /* Along-axis u in [0, length] and normal v in [-hw, hw], each linear in x. */
+        const double rel_y = y - c->ay;
+        double slab_lo = -1e30;
+        double slab_hi = 1e30;
+        ui_clip_linear(c->ux, c->inv_ux, (c->uy * rel_y) - (c->ux * c->ax), 0.0, c->length, &slab_lo, &slab_hi);
+        ui_clip_linear(-c->uy, -c->inv_uy, (c->ux * rel_y) + (c->uy * c->ax), -hw, hw, &slab_lo, &slab_hi);
+        if (slab_lo < slab_hi)
+        {
+            lo = (slab_lo < lo) ? slab_lo : lo;
+            hi = (slab_hi > hi) ? slab_hi : hi;
+        }
+    }
+
+    *xl = lo;
+    *xr = hi;
+    return lo < hi;
+}
+
+static bool ui_ring_extent(const void *shape, double y, double *xl, double *xr)
+{
+    const UiRingPiece *ring = (const UiRingPiece *)shape;
+    const double dy = y - ring->cy;
+    if (fabs(dy) >= ring->r_out)
+    {
+        return false;
+    }
+
+    const double outer = sqrt((ring->r_out * ring->r_out) - (dy * dy));
+    const double inner = (fabs(dy) < ring->r_in) ? sqrt((ring->r_in * ring->r_in) - (dy * dy)) : 0.0;
+    double lo = ring->right ? (ring->cx + inner) : (ring->cx - outer);
+    double hi = ring->right ? (ring->cx + outer) : (ring->cx - inner);
+
+    /* In math orientation p = (x - cx, cy - y): cross(start, p) >= 0 and cross(p, end) >= 0. */
+    const double py = -dy;
+    const double a0 = -ring->start_sin;
+    const double a1 = ring->end_sin;
+    ui_clip_linear(a0, (fabs(a0) > 1e-12) ? (1.0 / a0) : 0.0,
+        (ring->start_sin * ring->cx) + (ring->start_cos * py), 0.0, 1e30, &lo, &hi);
+    ui_clip_linear(a1, (fabs(a1) > 1e-12) ? (1.0 / a1) : 0.0,
+        -(ring->end_sin * ring->cx) - (ring->end_cos * py), 0.0, 1e30, &lo, &hi);
+
+    *xl = lo;
+    *xr = hi;
+    return lo < hi;
+}
+
+/* GDI points address pixel centres. */
+static void ui_raster_stroke(UiFramebuffer *fb, double ax, double ay, double bx, double by,
+    double width, uint32_t pixel)
+{
+    UiCapsule capsule;
+    capsule.ax = ax + 0.5;
+    capsule.ay = ay + 0.5;
+    capsule.bx = bx + 0.5;
+    capsule.by = by + 0.5;
+    capsule.half_width = ((width < 1.0) ? 1.0 : width) * 0.5;
+    const double dx = capsule.bx - capsule.ax;
+    const double dy = capsule.by - capsule.ay;
+    capsule.length = sqrt((dx * dx) + (dy * dy));
+    capsule.ux = (capsule.length > 0.0) ? (dx / capsule.length) : 0.0;
+    capsule.uy = (capsule.length > 0.0) ? (dy / capsule.length) : 0.0;
+    capsule.inv_ux = (fabs(capsule.ux) > 1e-9) ? (1.0 / capsule.ux) : 0.0;
+    capsule.inv_uy = (fabs(capsule.uy) > 1e-9) ? (1.0 / capsule.uy) : 0.0;
+    const double top = ((capsule.ay < capsule.by) ? capsule.ay : capsule.by) - capsule.half_width;
+    const double bottom = ((capsule.ay > capsule.by) ? capsule.ay : capsule.by) + capsule.half_width;
+    ui_raster_shape(fb, ui_capsule_extent, &capsule, top, bottom, pixel);
+}
+
+/* Outline of pen_width in pen, interior in fill (pen drawn inside the bounds). */
+static void ui_raster_round_shape(UiFramebuffer *fb, const UiDrawCommand *command, double rx, double ry)
+{
+    UiRoundShape shape;
+    shape.left = (double)command->rect.left;
+    shape.top = (double)command->rect.top;
+    shape.right = (double)command->rect.right;
+    shape.bottom = (double)command->rect.bottom;
+    shape.rx = rx;
+    shape.ry = ry;
+    ui_raster_shape(fb, ui_round_extent, &shape, shape.top, shape.bottom, ui_raster_pixel(command->pen));
+
+    const double inset = (double)command->pen_width;
+    shape.left += inset;
+    shape.top += inset;
+    shape.right -= inset;
+    shape.bottom -= inset;
+    shape.rx = (rx > inset) ? (rx - inset) : 0.0;
+    shape.ry = (ry > inset) ? (ry - inset) : 0.0;
+    if ((shape.right > shape.left) && (shape.bottom > shape.top))
+    {
+        ui_raster_shape(fb, ui_round_extent, &shape, shape.top, shape.bottom, ui_raster_pixel(command->fill));
+    }
+}
+
+/* Circular arc of the given stroke width with round ends; angles in math orientation (y up). */
+static void ui_raster_ring(UiFramebuffer *fb, double cx, double cy, double radius, double width,
+    double start, double sweep, uint32_t pixel)
+{
+    const double half_width = ((width < 1.0) ? 1.0 : width) * 0.5;
+    UiRingPiece ring;
+    ring.cx = cx;
+    ring.cy = cy;
+    ring.r_in = (radius > half_width) ? (radius - half_width) : 0.0;
+    ring.r_out = radius + half_width;
+
+    /* Split at the vertical through the centre (90 and 270 degrees). */
+    const double quarter = UI_RASTER_TWO_PI * 0.25;
+    double angle = start;
+    double remaining = sweep;
+    while (remaining > 1e-9)
+    {
+        const double boundary = quarter + ((floor((angle - quarter) / (2.0 * quarter)) + 1.0) * 2.0 * quarter);
+        const double piece = ((boundary - angle) < remaining) ? (boundary - angle) : remaining;
+        const double stop = angle + piece;
+        ring.right = (cos(angle + (piece * 0.5)) > 0.0);
+        ring.start_sin = sin(angle);
+        ring.start_cos = cos(angle);
+        ring.end_sin = sin(stop);
+        ring.end_cos = cos(stop);
+
+        double top = cy - (ring.r_out * ((ring.start_sin > ring.end_sin) ? ring.start_sin : ring.end_sin));
+        double bottom = cy - (ring.r_out * ((ring.start_sin < ring.end_sin) ? ring.start_sin : ring.end_sin));
+        top = (top < (cy - (ring.r_in * ring.start_sin))) ? top : (cy - (ring.r_in * ring.start_sin));
+        top = (top < (cy - (ring.r_in * ring.end_sin))) ? top : (cy - (ring.r_in * ring.end_sin));
+        bottom = (bottom > (cy - (ring.r_in * ring.start_sin))) ? bottom : (cy - (ring.r_in * ring.start_sin));
+        bottom = (bottom > (cy - (ring.r_in * ring.end_sin))) ? bottom : (cy - (ring.r_in * ring.end_sin));
+        ui_raster_shape(fb, ui_ring_extent, &ring, top, bottom, pixel);
+
+        angle = stop;
+        remaining -= piece;
+    }
+
+    const double caps[2] = {start, start + sweep};
+    for (int i = 0; i < 2; ++i)
+    {
+        UiRoundShape cap;
+        const double x = cx + (radius * cos(caps[i]));
+        const double y = cy - (radius * sin(caps[i]));
+        cap.left = x - half_width;
+        cap.right = x + half_width;
+        cap.top = y - half_width;
+        cap.bottom = y + half_width;
+        cap.rx = half_width;
+        cap.ry = half_width;
+        ui_raster_shape(fb, ui_round_extent, &cap, cap.top, cap.bottom, pixel);
+    }
+}
+
+/* Counter-clockwise (as seen on screen) from the ray through (x2, y2) to the ray through (x3, y3). */
+static void ui_raster_arc(UiFramebuffer *fb, const UiDrawCommand *command)
+{
+    const UiRect *r = &command->rect;
+    const double cx = (double)(r->left + r->right - 1) * 0.5;
+    const double cy = (double)(r->top + r->bottom - 1) * 0.5;
+    const double rx = (double)(r->right - r->left - 1) * 0.5;
+    const double ry = (double)(r->bottom - r->top - 1) * 0.5;
+    if ((rx <= 0.0) || (ry <= 0.0))
+    {
+        return;
+    }
+
+    const double start = atan2((cy - (double)command->y2) / ry, ((double)command->x2 - cx) / rx);
+    const double end = atan2((cy - (double)command->y3) / ry, ((double)command->x3 - cx) / rx);
+    double sweep = end - start;
+    while (sweep <= 0.0)
+    {
+        sweep += UI_RASTER_TWO_PI;
+    }
+
+    if (rx == ry)
+    {
+        ui_raster_ring(fb, cx + 0.5, cy + 0.5, rx, (double)command->pen_width, start, sweep,
+            ui_raster_pixel(command->pen));
+        return;
+    }
+
+    /* Chords of length sqrt(r) stay within 1/8 px of the true arc. */
+    const double radius = (rx > ry) ? rx : ry;
+    const double chord = (radius > 4.0) ? sqrt(radius) : 2.0;
+    int segments = (int)ceil((sweep * radius) / chord);
+    segments = (segments < 2) ? 2 : segments;
+    const uint32_t pixel = ui_raster_pixel(command->pen);
+    double px = cx + (rx * cos(start));
+    double py = cy - (ry * sin(start));
+    for (int i = 1; i <= segments; ++i)
+    {
+        const double angle = start + ((sweep * (double)i) / (double)segments);
+        const double nx = cx + (rx * cos(angle));
+        const double ny = cy - (ry * sin(angle));
+        ui_raster_stroke(fb, px, py, nx, ny, (double)command->pen_width, pixel);
+        px = nx;
+        py = ny;
+    }
+}
+
+static void ui_raster_clip_to(UiFramebuffer *fb, const UiRect *limit)
+{
+    fb->clip.left = (limit->left > fb->clip.left) ? limit->left : fb->clip.left;
+    fb->clip.top = (limit->top > fb->clip.top) ? limit->top : fb->clip.top;
+    fb->clip.right = (limit->right < fb->clip.right) ? limit->right : fb->clip.right;
+    fb->clip.bottom = (limit->bottom < fb->clip.bottom) ? limit->bottom : fb->clip.bottom;
+}
+
+static void ui_raster_text(UiFramebuffer *fb, const UiDrawList *list, const UiDrawCommand *command)
+{
+    const UiGlyphAtlas *atlas = &fb->fonts[(command->font < UI_FONT_COUNT) ? command->font : UI_FONT_SMALL];
+    const char *text = ui_draw_command_text(list, command);
+    int x = 0;
+    int y = 0;
+    ui_text_origin(atlas, command, text, &x, &y);
+
+    /* DrawText without DT_NOCLIP clips to its rect; so does this. */
+    const UiRect saved_clip = fb->clip;
+    ui_raster_clip_to(fb, &command->rect);
+
+    const uint32_t pixel = ui_raster_pixel(command->pen);
+    for (uint16_t i = 0U; i < command->text_length; ++i)
+    {
+        const UiGlyph *glyph = ui_glyph_lookup(atlas, (unsigned char)text[i]);
+        const int cell_left = x + glyph->left;
+        for (uint32_t r = 0U; r < glyph->run_count; ++r)
+        {
+            /* Solid runs are whole rects; the rest blend one row straight from the atlas. */
+            const UiGlyphRun *run = &atlas->runs[glyph->first_run + r];
+            if (run->solid)
+            {
+                ui_raster_fill_rect(fb, cell_left + run->x0, y + run->y0, cell_left + run->x1, y + run->y1, pixel);
+                continue;
+            }
+            const int row = y + run->y0;
+            const int x0 = ((cell_left + run->x0) < fb->clip.left) ? fb->clip.left : (cell_left + run->x0);
+            const int x1 = ((cell_left + run->x1) > fb->clip.right) ? fb->clip.right : (cell_left + run->x1);
+            if ((row >= fb->clip.top) && (row < fb->clip.bottom) && (x0 < x1))
+            {
+                const uint8_t *coverage = &atlas->coverage[((size_t)run->y0 * (size_t)atlas->width)
+                    + (size_t)(glyph->atlas_x + (x0 - cell_left))];
+                ui_raster_blend_span(&fb->pixels[(size_t)row * (size_t)fb->width], x0, x1, pixel, coverage);
+            }
+        }
+        x += glyph->advance;
+    }
+    fb->clip = saved_clip;
+}
+
+/* Whole framebuffer, narrowed to area (if given) and to a non-empty rect (CLIP command). */
+static void ui_raster_set_clip(UiFramebuffer *fb, const UiRect *area, const UiRect *rect)
+{
+    fb->clip.left = 0;
+    fb->clip.top = 0;
+    fb->clip.right = fb->width;
+    fb->clip.bottom = fb->height;
+    if (area != NULL)
+    {
+        ui_raster_clip_to(fb, area);
+    }
+    if ((rect != NULL) && (rect->right > rect->left) && (rect->bottom > rect->top))
+    {
+        ui_raster_clip_to(fb, rect);
+    }
+}
+
+void ui_raster_execute(UiFramebuffer *fb, const UiDrawList *list)
+{
+    ui_raster_execute_area(fb, list, NULL);
+}
+
+void ui_raster_execute_area(UiFramebuffer *fb, const UiDrawList *list, const UiRect *area)
+{
+    if ((fb == NULL) || (fb->pixels == NULL) || (list == NULL))
+    {
+        return;
+    }
+
+    SYS_TRACE_BEGIN(ui_raster_execute);
+    ui_raster_set_clip(fb, area, NULL);
+
+    for (size_t i = 0U; i < list->count; ++i)
+    {
+        const UiDrawCommand *command = &list->commands[i];
+        const UiRect *r = &command->rect;
+        switch ((UiDrawKind)command->kind)
+        {
+            case UI_CMD_FILL_RECT:
+                ui_raster_fill_rect(fb, r->left, r->top, r->right, r->bottom, ui_raster_pixel(command->fill));
+                break;
+            case UI_CMD_FRAME_RECT:
+            {
+                const uint32_t pixel = ui_raster_pixel(command->pen);
+                ui_raster_fill_rect(fb, r->left, r->top, r->right, r->top + 1, pixel);
+                ui_raster_fill_rect(fb, r->left, r->bottom - 1, r->right, r->bottom, pixel);
+                ui_raster_fill_rect(fb, r->left, r->top, r->left + 1, r->bottom, pixel);
+                ui_raster_fill_rect(fb, r->right - 1, r->top, r->right, r->bottom, pixel);
+                break;
+            }
+            case UI_CMD_ROUND_RECT:
+                ui_raster_round_shape(fb, command, (double)command->x2 * 0.5, (double)command->y2 * 0.5);
+                break;
+            case UI_CMD_RECTANGLE:
+                ui_raster_round_shape(fb, command, 0.0, 0.0);
+                break;
+            case UI_CMD_ELLIPSE:
+                ui_raster_round_shape(fb, command, (double)(r->right - r->left) * 0.5,
+                    (double)(r->bottom - r->top) * 0.5);
+                break;
+            case UI_CMD_ARC:
+                ui_raster_arc(fb, command);
+                break;
+            case UI_CMD_LINE:
+                ui_raster_stroke(fb, (double)r->left, (double)r->top, (double)r->right, (double)r->bottom,
+                    (double)command->pen_width, ui_raster_pixel(command->pen));
+                break;
+            case UI_CMD_TEXT:
+                ui_raster_text(fb, list, command);
+                break;
+            case UI_CMD_CLIP:
+                ui_raster_set_clip(fb, area, r);
+                break;
+            default:
+                break;
+        }
+    }
+    SYS_TRACE_END(ui_raster_execute);
+}
+
+bool ui_framebuffer_write_ppm(const UiFramebuffer *fb, FILE *out)
+{
+    if ((fb == NULL) || (fb->pixels == NULL) || (out == NULL))
+    {
+        return false;
+    }
+
+    if (fprintf(out, "P6\n%d %d\n255\n", fb->width, fb->height) < 0)
+    {
+        return false;
+    }
+
+    uint8_t *rgb = (uint8_t *)malloc((size_t)fb->width * 3U);
+    if (rgb == NULL)
+    {
+        return false;
+    }
+
+    bool ok = true;
+    for (int y = 0; (y < fb->height) && ok; ++y)
+    {
+        const uint32_t *row = &fb->pixels[(size_t)y * (size_t)fb->width];
+        for (int x = 0; x < fb->width; ++x)
+        {
+            rgb[(x * 3) + 0] = (uint8_t)(row[x] & 0xFFU);
+            rgb[(x * 3) + 1] = (uint8_t)((row[x] >> 8) & 0xFFU);
+            rgb[(x * 3) + 2] = (uint8_t)((row[x] >> 16) & 0xFFU);
+        }
+        ok = (fwrite(rgb, 3U, (size_t)fb->width, out) == (size_t)fb->width);
+    }
+    free(rgb);
+    return ok;
+}
@@ -0,0 +1,48 @@
+#ifndef UI_RASTER_H
+#define UI_RASTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ui_draw.h"
+#include "ui_text.h"
+
+/*
+ * CPU backend for UiDrawList: rasterizes a frame into a 32-bit RGBA framebuffer
+ * (R in the low byte, alpha always 255) without any windowing system. Shapes are
+ * drawn as horizontal spans with anti-aliased left/right edges, text is blitted
+ * from glyph atlases of a built-in 5x7 bitmap font scaled per UiFont.
+ */
+typedef struct
+{
+    uint32_t *pixels;
+    uint8_t *coverage;
+    int width;
+    int height;
+    /* Drawing bounds, the whole buffer unless a UI_CMD_CLIP narrows them. */
+    UiRect clip;
+    UiGlyphAtlas fonts[UI_FONT_COUNT];
+} UiFramebuffer;
+
+bool ui_framebuffer_create(UiFramebuffer *fb, int width, int height);
+void ui_framebuffer_destroy(UiFramebuffer *fb);
+void ui_raster_execute(UiFramebuffer *fb, const UiDrawList *list);
+/* Same, but touches only pixels inside area (a dirty region); NULL means everywhere. */
+void ui_raster_execute_area(UiFramebuffer *fb, const UiDrawList *list, const UiRect *area);
+/* Copies src into dst (same size), e.g. a cached static layer under a new frame. */
+bool ui_framebuffer_copy(UiFramebuffer *dst, const UiFramebuffer *src);
+bool ui_framebuffer_copy_rect(UiFramebuffer *dst, const UiFramebuffer *src, const UiRect *rect);
+/* Appends the frame as a binary PPM (P6); a file of several frames is a PPM stream. */
+bool ui_framebuffer_write_ppm(const UiFramebuffer *fb, FILE *out);
+const char *ui_raster_kernel_name(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_RASTER_H */
@@ -0,0 +1,264 @@
+#include "ui_text.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define UI_FIXED_MAX_DECIMALS 6
+/* Keeps value * 10^decimals well inside int64_t. */
+#define UI_FIXED_LIMIT 9.0e17
+
+bool ui_glyph_atlas_create(UiGlyphAtlas *atlas, int width, int height)
+{
+    if ((atlas == NULL) || (width <= 0) || (height <= 0))
+    {
+        return false;
+    }
+
+    memset(atlas, 0, sizeof(*atlas));
+    atlas->coverage = (uint8_t *)calloc((size_t)width * (size_t)height, 1U);
+    if (atlas->coverage == NULL)
+    {
+        return false;
+    }
+    atlas->width = width;
+    atlas->height = height;
+    return true;
+}
+
+void ui_glyph_atlas_destroy(UiGlyphAtlas *atlas)
+{
+    if (atlas == NULL)
+    {
+        return;
+    }
+
+    free(atlas->coverage);
+    free(atlas->runs);
+    memset(atlas, 0, sizeof(*atlas));
+}
+
+/* Appends the runs of one glyph; with runs == NULL it only counts them. */
+static size_t ui_glyph_split(const UiGlyphAtlas *atlas, const UiGlyph *glyph, UiGlyphRun *runs)
+{
+    size_t count = 0U;
+    for (int y = 0; y < atlas->height; ++y)
+    {
+        const uint8_t *row = &atlas->coverage[((size_t)y * (size_t)atlas->width) + (size_t)glyph->atlas_x];
+        int x = 0;
+        while (x < glyph->cell_width)
+        {
+            const uint8_t a = row[x];
+            int end = x + 1;
+            while ((end < glyph->cell_width) && ((row[end] == 255U) == (a == 255U)) && ((row[end] == 0U) == (a == 0U)))
+            {
+                ++end;
+            }
+            if (a != 0U)
+            {
+                /* A solid run directly under an identical solid run just makes that rect taller. */
+                bool merged = false;
+                for (size_t i = 0U; (runs != NULL) && (i < count) && (a == 255U) && !merged; ++i)
+                {
+                    UiGlyphRun *above = &runs[i];
+                    if (above->solid && (above->y1 == y) && (above->x0 == x) && (above->x1 == end))
+                    {
+                        above->y1 = (int16_t)(y + 1);
+                        merged = true;
+                    }
+                }
+                if (!merged)
+                {
+                    if (runs != NULL)
+                    {
+                        runs[count].x0 = (int16_t)x;
+                        runs[count].x1 = (int16_t)end;
+                        runs[count].y0 = (int16_t)y;
+                        runs[count].y1 = (int16_t)(y + 1);
+                        runs[count].solid = (a == 255U);
+                    }
+                    ++count;
+                }
+            }
+            x = end;
+        }
+    }
+    return count;
+}
+
+bool ui_glyph_atlas_finish(UiGlyphAtlas *atlas)
+{
+    if ((atlas == NULL) || (atlas->coverage == NULL))
+    {
+        return false;
+    }
+
+    size_t capacity = 0U;
+    for (unsigned i = 0U; i < UI_GLYPH_COUNT; ++i)
+    {
+        capacity += ui_glyph_split(atlas, &atlas->glyphs[i], NULL);
+    }
+    free(atlas->runs);
+    atlas->runs = (UiGlyphRun *)malloc((capacity + 1U) * sizeof(UiGlyphRun));
+    atlas->run_count = 0U;
+    if (atlas->runs == NULL)
+    {
+        return false;
+    }
+
+    for (unsigned i = 0U; i < UI_GLYPH_COUNT; ++i)
+    {
+        UiGlyph *glyph = &atlas->glyphs[i];
+        glyph->first_run = (uint32_t)atlas->run_count;
+        glyph->run_count = (uint32_t)ui_glyph_split(atlas, glyph, &atlas->runs[atlas->run_count]);
+        atlas->run_count += glyph->run_count;
+    }
+    return true;
+}
+
+const UiGlyph *ui_glyph_lookup(const UiGlyphAtlas *atlas, unsigned char ch)
+{
+    const unsigned index = ((ch >= UI_GLYPH_FIRST) && (ch < (UI_GLYPH_FIRST + UI_GLYPH_COUNT)))
+        ? (ch - UI_GLYPH_FIRST) : ((unsigned)'?' - UI_GLYPH_FIRST);
+    return &atlas->glyphs[index];
+}
+
+int ui_text_width(const UiGlyphAtlas *atlas, const char *text, size_t length)
+{
+    if ((atlas == NULL) || (text == NULL) || (length == 0U))
+    {
+        return 0;
+    }
+
+    int width = 0;
+    for (size_t i = 0U; (i + 1U) < length; ++i)
+    {
+        width += ui_glyph_lookup(atlas, (unsigned char)text[i])->advance;
+    }
+    return width + ui_glyph_lookup(atlas, (unsigned char)text[length - 1U])->extent;
+}
+
+void ui_text_origin(const UiGlyphAtlas *atlas, const UiDrawCommand *command, const char *text, int *x, int *y)
+{
+    const UiRect *r = &command->rect;
+    const int text_width = ui_text_width(atlas, text, command->text_length);
+
+    *x = r->left;
+    if ((command->flags & UI_TEXT_CENTER) != 0U)
+    {
+        *x = r->left + (((r->right - r->left) - text_width) / 2);
+    }
+    else if ((command->flags & UI_TEXT_RIGHT) != 0U)
+    {
+        *x = r->right - text_width;
+    }
+    else
+    {
+        /* no action */
+    }
+
+    /* Like DrawText, vertical alignment only applies to single-line text. */
+    *y = r->top;
+    if ((command->flags & UI_TEXT_SINGLELINE) != 0U)
+    {
+        if ((command->flags & UI_TEXT_VCENTER) != 0U)
+        {
+            *y = r->top + (((r->bottom - r->top) - atlas->height) / 2);
+        }
+        else if ((command->flags & UI_TEXT_BOTTOM) != 0U)
+        {
+            *y = r->bottom - atlas->height;
+        }
+        else
+        {
+            /* no action */
+        }
+    }
+}
+
+bool ui_glyph_cell(const UiGlyphAtlas *atlas, const UiGlyph *glyph, int x, int y, const UiRect *clip,
+    UiRect *dst, int *src_x, int *src_y)
+{
+    const int cell_left = x + glyph->left;
+    dst->left = (cell_left > clip->left) ? cell_left : clip->left;
+    dst->top = (y > clip->top) ? y : clip->top;
+    dst->right = ((cell_left + glyph->cell_width) < clip->right) ? (cell_left + glyph->cell_width) : clip->right;
+    dst->bottom = ((y + atlas->height) < clip->bottom) ? (y + atlas->height) : clip->bottom;
+    if ((dst->left >= dst->right) || (dst->top >= dst->bottom))
+    {
+        return false;
+    }
+
+    *src_x = glyph->atlas_x + (dst->left - cell_left);
+    *src_y = dst->top - y;
+    return true;
+}
+
+int64_t ui_fixed_round(double value, int decimals)
+{
+    static const double scale[UI_FIXED_MAX_DECIMALS + 1] = {1.0, 10.0, 100.0, 1e3, 1e4, 1e5, 1e6};
+    const int places = (decimals < 0) ? 0 : ((decimals > UI_FIXED_MAX_DECIMALS) ? UI_FIXED_MAX_DECIMALS : decimals);
+    double scaled = value * scale[places];
+    if (scaled != scaled)
+    {
+        return 0;
+    }
+    if (scaled > UI_FIXED_LIMIT)
+    {
+        scaled = UI_FIXED_LIMIT;
+    }
+    else if (scaled < -UI_FIXED_LIMIT)
+    {
+        scaled = -UI_FIXED_LIMIT;
+    }
+    else
+    {
+        /* no action */
+    }
+    return (scaled >= 0.0) ? (int64_t)(scaled + 0.5) : -(int64_t)(0.5 - scaled);
+}
+
+size_t ui_format_fixed(char *out, size_t capacity, double value, int decimals)
+{
+    if ((out == NULL) || (capacity == 0U))
+    {
+        return 0U;
+    }
+
+    const int places = (decimals < 0) ? 0 : ((decimals > UI_FIXED_MAX_DECIMALS) ? UI_FIXED_MAX_DECIMALS : decimals);
+    const int64_t fixed = ui_fixed_round(value, places);
+    uint64_t magnitude = (fixed < 0) ? (uint64_t)(-fixed) : (uint64_t)fixed;
+
+    /* Digits come out least significant first. */
+    char reversed[32];
+    size_t length = 0U;
+    for (int i = 0; i < places; ++i)
+    {
+        reversed[length++] = (char)('0' + (int)(magnitude % 10U));
+        magnitude /= 10U;
+    }
+    if (places > 0)
+    {
+        reversed[length++] = '.';
+    }
+    do
+    {
+        reversed[length++] = (char)('0' + (int)(magnitude % 10U));
+        magnitude /= 10U;
+    } while (magnitude != 0U);
+    if (fixed < 0)
+    {
+        reversed[length++] = '-';
+    }
+
+    if ((length + 1U) > capacity)
+    {
+        out[0] = '\0';
+        return 0U;
+    }
+    for (size_t i = 0U; i < length; ++i)
+    {
+        out[i] = reversed[length - 1U - i];
+    }
+    out[length] = '\0';
+    return length;
+}
@@ -0,0 +1,86 @@
+#ifndef UI_TEXT_H
+#define UI_TEXT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ui_draw.h"
+
+/*
+ * Text without printf or DrawText. Readouts are formatted from fixed-point
+ * integers, and TEXT commands are drawn from a per-font glyph atlas: an 8-bit
+ * coverage strip holding printable ASCII, rasterized once by the backend
+ * (GDI fonts in ui.c, the 5x7 bitmap font in ui_raster.c). Layout and
+ * clipping live here, so both backends place every glyph identically.
+ * ui_glyph_atlas_finish() also splits each cell into runs: solid runs merged
+ * across rows into rects, plus single-row runs of partial coverage, so a CPU
+ * blitter fills rects instead of testing every atlas byte.
+ */
+#define UI_GLYPH_FIRST 0x20U
+#define UI_GLYPH_COUNT 95U
+
+/* Part of a glyph cell, relative to the cell's top-left corner. */
+typedef struct
+{
+    int16_t x0;
+    int16_t x1;
+    int16_t y0;
+    int16_t y1;
+    bool solid;     /* coverage 255 throughout; otherwise one row to blend from the atlas */
+} UiGlyphRun;
+
+typedef struct
+{
+    int atlas_x;    /* left column of the cell in the atlas strip */
+    int cell_width;
+    int left;       /* cell left relative to the pen position (negative = overhang) */
+    int advance;    /* pen step to the next glyph */
+    int extent;     /* run width contributed when this is the last glyph */
+    uint32_t first_run;
+    uint32_t run_count;
+} UiGlyph;
+
+typedef struct
+{
+    uint8_t *coverage; /* width x height, row-major, 0..255 */
+    int width;
+    int height;        /* line height; every cell spans all rows */
+    UiGlyph glyphs[UI_GLYPH_COUNT];
+    UiGlyphRun *runs;
+    size_t run_count;
+} UiGlyphAtlas;
+
+/* Allocates a cleared strip; the backend fills coverage and glyph metrics, then calls finish. */
+bool ui_glyph_atlas_create(UiGlyphAtlas *atlas, int width, int height);
+/* Builds the run lists from the filled coverage. */
+bool ui_glyph_atlas_finish(UiGlyphAtlas *atlas);
+void ui_glyph_atlas_destroy(UiGlyphAtlas *atlas);
+/* Glyph for a byte; anything outside printable ASCII maps to '?'. */
+const UiGlyph *ui_glyph_lookup(const UiGlyphAtlas *atlas, unsigned char ch);
+
+/* Width of a run, as DrawText would measure it. */
+int ui_text_width(const UiGlyphAtlas *atlas, const char *text, size_t length);
+/* Pen origin (top-left of the line) for a TEXT command, following DrawText alignment rules. */
+void ui_text_origin(const UiGlyphAtlas *atlas, const UiDrawCommand *command, const char *text, int *x, int *y);
+/*
+ * Destination of the glyph cell at pen (x, y), cut to clip, and the matching atlas
+ * column/row of its top-left pixel. Returns false when nothing is left to draw.
+ */
+bool ui_glyph_cell(const UiGlyphAtlas *atlas, const UiGlyph *glyph, int x, int y, const UiRect *clip,
+    UiRect *dst, int *src_x, int *src_y);
+
+/* value * 10^decimals rounded half away from zero; equal results print identically. */
+int64_t ui_fixed_round(double value, int decimals);
+/* Like "%.*f" without the locale, allocation or printf; returns the length written (0 if too small). */
+size_t ui_format_fixed(char *out, size_t capacity, double value, int decimals);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_TEXT_H */